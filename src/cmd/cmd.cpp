@@ -35,6 +35,7 @@
 #endif
 #include "simplesslerrorhandler.h"
 #include "syncengine.h"
+#include "common/metrics.h"
 #include "common/syncjournaldb.h"
 #include "config.h"
 #include "csync_exclude.h"
@@ -193,6 +194,7 @@ void help()
     std::cout << "  --version, -v          Display version and exit" << std::endl;
     std::cout << "  --logdebug             More verbose logging" << std::endl;
     std::cout << "  --path                 Path to a folder on a remote server" << std::endl;
+    std::cout << "  --metrics              Print sync metrics as JSON when done" << std::endl;
     std::cout << "" << std::endl;
     exit(0);
 }
@@ -271,6 +273,8 @@ void parseOptions(const QStringList &app_args, CmdOptions *options)
             Logger::instance()->setLogDebug(true);
         } else if (option == "--path" && !it.peekNext().startsWith("-")) {
             options->remotePath = it.next();
+        } else if (option == "--metrics") {
+            Metrics::setEnabled(true);
         }
         else {
             help();
@@ -576,5 +580,9 @@ restart_sync:
         qWarning() << "Another sync is needed, but not done because restart count is exceeded" << restartCount;
     }
 
+    if (Metrics::isEnabled()) {
+        std::cout << QJsonDocument(Metrics::snapshot()).toJson().constData() << std::flush;
+    }
+
     return resultCode;
 }
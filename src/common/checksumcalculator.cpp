@@ -47,22 +47,36 @@ static QCryptographicHash::Algorithm algorithmTypeToQCryptoHashAlgorithm(Checksu
     return static_cast<QCryptographicHash::Algorithm>(-1);
 }
 
-ChecksumCalculator::ChecksumCalculator(QSharedPointer<QIODevice> sharedDevice, const QByteArray &checksumTypeName)
-    : _device(sharedDevice)
+static ChecksumCalculator::AlgorithmType algorithmTypeFromName(const QByteArray &checksumTypeName)
 {
     if (checksumTypeName == checkSumMD5C) {
-        _algorithmType = AlgorithmType::MD5;
+        return ChecksumCalculator::AlgorithmType::MD5;
     } else if (checksumTypeName == checkSumSHA1C) {
-        _algorithmType = AlgorithmType::SHA1;
+        return ChecksumCalculator::AlgorithmType::SHA1;
     } else if (checksumTypeName == checkSumSHA2C) {
-        _algorithmType = AlgorithmType::SHA256;
+        return ChecksumCalculator::AlgorithmType::SHA256;
     } else if (checksumTypeName == checkSumSHA3C) {
-        _algorithmType = AlgorithmType::SHA3_256;
+        return ChecksumCalculator::AlgorithmType::SHA3_256;
     } else if (checksumTypeName == checkSumAdlerC) {
-        _algorithmType = AlgorithmType::Adler32;
+        return ChecksumCalculator::AlgorithmType::Adler32;
     }
+    return ChecksumCalculator::AlgorithmType::Undefined;
+}
 
-    initChecksumAlgorithm();
+ChecksumCalculator::ChecksumCalculator(QSharedPointer<QIODevice> sharedDevice, const QByteArray &checksumTypeName)
+    : ChecksumCalculator(sharedDevice, QByteArrayList{checksumTypeName})
+{
+}
+
+ChecksumCalculator::ChecksumCalculator(QSharedPointer<QIODevice> sharedDevice, const QByteArrayList &checksumTypeNames)
+    : _device(sharedDevice)
+{
+    initChecksumAlgorithms(checksumTypeNames);
+}
+
+ChecksumCalculator::ChecksumCalculator(const QByteArray &checksumTypeName)
+{
+    initChecksumAlgorithms({checksumTypeName});
 }
 
 ChecksumCalculator::~ChecksumCalculator()
@@ -75,9 +89,15 @@ ChecksumCalculator::~ChecksumCalculator()
 
 QByteArray ChecksumCalculator::calculate()
 {
-    QByteArray result;
+    const auto checksums = calculateAll();
+    return checksums.isEmpty() ? QByteArray() : checksums.first();
+}
+
+QByteArrayList ChecksumCalculator::calculateAll()
+{
+    QByteArrayList result;
 
-    if (!_isInitialized) {
+    if (!_isInitialized || !_device) {
         return result;
     }
 
@@ -109,7 +129,7 @@ QByteArray ChecksumCalculator::calculate()
         if (sizeRead <= 0) {
             break;
         }
-        if (!addChunk(buf, sizeRead)) {
+        if (!addData(buf.constData(), sizeRead)) {
             break;
         }
     }
@@ -121,14 +141,7 @@ QByteArray ChecksumCalculator::calculate()
         }
     }
 
-    if (_algorithmType == AlgorithmType::Adler32) {
-        result = QByteArray::number(_adlerHash, 16);
-    } else {
-        Q_ASSERT(_cryptographicHash);
-        if (_cryptographicHash) {
-            result = _cryptographicHash->result().toHex();
-        }
-    }
+    result = results();
 
     {
         QMutexLocker locker(&_deviceMutex);
@@ -140,41 +153,72 @@ QByteArray ChecksumCalculator::calculate()
     return result;
 }
 
-void ChecksumCalculator::initChecksumAlgorithm()
+void ChecksumCalculator::initChecksumAlgorithms(const QByteArrayList &checksumTypeNames)
 {
-    if (_algorithmType == AlgorithmType::Undefined) {
-        qCWarning(lcChecksumCalculator) << "_algorithmType is Undefined, impossible to init Checksum Algorithm";
-        return;
+    for (const auto &checksumTypeName : checksumTypeNames) {
+        Algorithm algorithm;
+        algorithm.type = algorithmTypeFromName(checksumTypeName);
+        if (algorithm.type == AlgorithmType::Undefined) {
+            qCWarning(lcChecksumCalculator) << "_algorithmType is Undefined, impossible to init Checksum Algorithm" << checksumTypeName;
+            _algorithms.clear();
+            return;
+        }
+
+        if (algorithm.type == AlgorithmType::Adler32) {
+            algorithm.adlerHash = adler32(0L, Z_NULL, 0);
+        } else {
+            algorithm.cryptographicHash = std::make_unique<QCryptographicHash>(algorithmTypeToQCryptoHashAlgorithm(algorithm.type));
+        }
+        _algorithms.push_back(std::move(algorithm));
     }
 
-    if (_algorithmType == AlgorithmType::Adler32) {
-        _adlerHash = adler32(0L, Z_NULL, 0);
-    } else {
-        _cryptographicHash.reset(new QCryptographicHash(algorithmTypeToQCryptoHashAlgorithm(_algorithmType)));
+    _isInitialized = !_algorithms.empty();
+}
+
+QByteArray ChecksumCalculator::result() const
+{
+    const auto checksums = results();
+    return checksums.isEmpty() ? QByteArray() : checksums.first();
+}
+
+QByteArrayList ChecksumCalculator::results() const
+{
+    QByteArrayList checksums;
+    if (!_isInitialized) {
+        return checksums;
     }
 
-    _isInitialized = true;
+    for (const auto &algorithm : _algorithms) {
+        if (algorithm.type == AlgorithmType::Adler32) {
+            checksums.append(QByteArray::number(algorithm.adlerHash, 16));
+        } else {
+            Q_ASSERT(algorithm.cryptographicHash);
+            checksums.append(algorithm.cryptographicHash ? algorithm.cryptographicHash->result().toHex() : QByteArray());
+        }
+    }
+    return checksums;
 }
 
-bool ChecksumCalculator::addChunk(const QByteArray &chunk, const qint64 size)
+bool ChecksumCalculator::addData(const char *data, const qint64 size)
 {
-    Q_ASSERT(_algorithmType != AlgorithmType::Undefined);
-    if (_algorithmType == AlgorithmType::Undefined) {
+    Q_ASSERT(_isInitialized);
+    if (!_isInitialized) {
         qCWarning(lcChecksumCalculator) << "_algorithmType is Undefined, impossible to add a chunk!";
         return false;
     }
 
-    if (_algorithmType == AlgorithmType::Adler32) {
-        _adlerHash = adler32(_adlerHash, (const Bytef *)chunk.data(), size);
-        return true;
-    } else {
-        Q_ASSERT(_cryptographicHash);
-        if (_cryptographicHash) {
-            _cryptographicHash->addData(chunk.data(), size);
-            return true;
+    for (auto &algorithm : _algorithms) {
+        if (algorithm.type == AlgorithmType::Adler32) {
+            algorithm.adlerHash = adler32(algorithm.adlerHash, (const Bytef *)data, size);
+        } else {
+            Q_ASSERT(algorithm.cryptographicHash);
+            if (!algorithm.cryptographicHash) {
+                return false;
+            }
+            algorithm.cryptographicHash->addData(data, size);
         }
     }
-    return false;
+    return true;
 }
 
 }
@@ -20,10 +20,12 @@
 
 #include <QObject>
 #include <QByteArray>
+#include <QByteArrayList>
 #include <QFutureWatcher>
 #include <QMutex>
 
 #include <memory>
+#include <vector>
 
 class QCryptographicHash;
 
@@ -43,17 +45,37 @@ public:
     };
 
     ChecksumCalculator(QSharedPointer<QIODevice> sharedDevice, const QByteArray &checksumTypeName);
+    /// Computes all the checksum types in one pass over the device, see calculateAll()
+    ChecksumCalculator(QSharedPointer<QIODevice> sharedDevice, const QByteArrayList &checksumTypeNames);
+    /// Without a device, for feeding the data with addData() while it streams by
+    explicit ChecksumCalculator(const QByteArray &checksumTypeName);
     ~ChecksumCalculator();
     [[nodiscard]] QByteArray calculate();
 
+    /// One checksum per type given to the constructor, in that order. Empty on failure.
+    [[nodiscard]] QByteArrayList calculateAll();
+
+    /// False if a checksum type is unknown
+    [[nodiscard]] bool isValid() const { return _isInitialized; }
+
+    bool addData(const char *data, const qint64 size);
+
+    /// The checksum of the data added so far, empty if the checksum type is unknown
+    [[nodiscard]] QByteArray result() const;
+
 private:
-    void initChecksumAlgorithm();
-    bool addChunk(const QByteArray &chunk, const qint64 size);
+    struct Algorithm
+    {
+        AlgorithmType type = AlgorithmType::Undefined;
+        std::unique_ptr<QCryptographicHash> cryptographicHash;
+        unsigned int adlerHash = 0;
+    };
+
+    void initChecksumAlgorithms(const QByteArrayList &checksumTypeNames);
+    [[nodiscard]] QByteArrayList results() const;
     QSharedPointer<QIODevice> _device;
-    QScopedPointer<QCryptographicHash> _cryptographicHash;
-    unsigned int _adlerHash = 0;
+    std::vector<Algorithm> _algorithms;
     bool _isInitialized = false;
-    AlgorithmType _algorithmType = AlgorithmType::Undefined;
     QMutex _deviceMutex;
 };
 }
@@ -184,6 +184,16 @@ QByteArray ComputeChecksum::checksumType() const
     return _checksumType;
 }
 
+void ComputeChecksum::setAdditionalChecksumType(const QByteArray &type)
+{
+    _additionalChecksumType = type;
+}
+
+QByteArray ComputeChecksum::additionalChecksum() const
+{
+    return _additionalChecksum;
+}
+
 void ComputeChecksum::start(const QString &filePath)
 {
     qCInfo(lcChecksums) << "Computing" << checksumType() << "checksum of" << filePath << "in a thread";
@@ -205,9 +215,13 @@ void ComputeChecksum::startImpl(QSharedPointer<QIODevice> device)
         this, &ComputeChecksum::slotCalculationDone,
         Qt::UniqueConnection);
 
-    _checksumCalculator.reset(new ChecksumCalculator(device, _checksumType));
+    auto checksumTypes = QByteArrayList{_checksumType};
+    if (!_additionalChecksumType.isEmpty()) {
+        checksumTypes.append(_additionalChecksumType);
+    }
+    _checksumCalculator.reset(new ChecksumCalculator(device, checksumTypes));
     _watcher.setFuture(QtConcurrent::run([this]() {
-        return _checksumCalculator->calculate();
+        return _checksumCalculator->calculateAll();
     }));
 }
 
@@ -229,7 +243,9 @@ QByteArray ComputeChecksum::computeNow(QSharedPointer<QIODevice> device, const Q
 
 void ComputeChecksum::slotCalculationDone()
 {
-    QByteArray checksum = _watcher.future().result();
+    const auto checksums = _watcher.future().result();
+    const auto checksum = checksums.value(0);
+    _additionalChecksum = checksums.value(1);
     if (!checksum.isNull()) {
         emit done(_checksumType, checksum);
     } else {
@@ -243,17 +259,25 @@ ValidateChecksumHeader::ValidateChecksumHeader(QObject *parent)
 {
 }
 
-ComputeChecksum *ValidateChecksumHeader::prepareStart(const QByteArray &checksumHeader)
+bool ValidateChecksumHeader::parseExpectedChecksum(const QByteArray &checksumHeader)
 {
     // If the incoming header is empty no validation can happen. Just continue.
     if (checksumHeader.isEmpty()) {
         emit validated(QByteArray(), QByteArray());
-        return nullptr;
+        return false;
     }
 
     if (!parseChecksumHeader(checksumHeader, &_expectedChecksumType, &_expectedChecksum)) {
         qCWarning(lcChecksums) << "Checksum header malformed:" << checksumHeader;
         emit validationFailed(tr("The checksum header is malformed."), _calculatedChecksumType, _calculatedChecksum, ChecksumHeaderMalformed);
+        return false;
+    }
+    return true;
+}
+
+ComputeChecksum *ValidateChecksumHeader::prepareStart(const QByteArray &checksumHeader)
+{
+    if (!parseExpectedChecksum(checksumHeader)) {
         return nullptr;
     }
 
@@ -277,6 +301,13 @@ void ValidateChecksumHeader::start(QSharedPointer<QIODevice> device, const QByte
     }
 }
 
+void ValidateChecksumHeader::validate(const QByteArray &checksumHeader, const QByteArray &calculatedChecksumType, const QByteArray &calculatedChecksum)
+{
+    if (parseExpectedChecksum(checksumHeader)) {
+        slotChecksumCalculated(calculatedChecksumType, calculatedChecksum);
+    }
+}
+
 QByteArray ValidateChecksumHeader::calculatedChecksumType() const
 {
     return _calculatedChecksumType;
@@ -74,6 +74,20 @@ public:
 
     QByteArray checksumType() const;
 
+    /**
+     * Sets a checksum type to compute in the same pass over the data. The default is empty.
+     *
+     * Saves reading the data twice when two checksum types are needed.
+     */
+    void setAdditionalChecksumType(const QByteArray &type);
+
+    /**
+     * The checksum of the additional type, valid once done() was emitted.
+     *
+     * Empty if there is no additional type or if the computation failed.
+     */
+    [[nodiscard]] QByteArray additionalChecksum() const;
+
     /**
      * Computes the checksum for the given file path.
      *
@@ -111,9 +125,11 @@ private:
     void startImpl(QSharedPointer<QIODevice> device);
 
     QByteArray _checksumType;
+    QByteArray _additionalChecksumType;
+    QByteArray _additionalChecksum;
 
     // watcher for the checksum calculation thread
-    QFutureWatcher<QByteArray> _watcher;
+    QFutureWatcher<QByteArrayList> _watcher;
 
     QScopedPointer<ChecksumCalculator> _checksumCalculator;
 };
@@ -155,6 +171,14 @@ public:
      */
     void start(QSharedPointer<QIODevice> device, const QByteArray &checksumHeader);
 
+    /**
+     * Check an already calculated checksum against the provided checksumHeader
+     *
+     * For data that was hashed while it was written. The signals are emitted
+     * before this returns.
+     */
+    void validate(const QByteArray &checksumHeader, const QByteArray &calculatedChecksumType, const QByteArray &calculatedChecksum);
+
     [[nodiscard]] QByteArray calculatedChecksumType() const;
     [[nodiscard]] QByteArray calculatedChecksum() const;
 
@@ -167,6 +191,8 @@ private slots:
     void slotChecksumCalculated(const QByteArray &checksumType, const QByteArray &checksum);
 
 private:
+    /// Returns false if the validation is already decided
+    bool parseExpectedChecksum(const QByteArray &checksumHeader);
     ComputeChecksum *prepareStart(const QByteArray &checksumHeader);
 
     QByteArray _expectedChecksumType;
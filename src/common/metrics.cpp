@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "common/metrics.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include <map>
+#include <memory>
+
+namespace OCC {
+
+namespace {
+
+    struct Registry
+    {
+        Registry() { enabledTimer.start(); }
+
+        QMutex mutex;
+        QElapsedTimer enabledTimer;
+        // std::map keeps the snapshot sorted, the unique_ptrs keep references stable
+        std::map<QByteArray, std::unique_ptr<Metrics::Counter>> counters;
+        std::map<QByteArray, std::unique_ptr<Metrics::Gauge>> gauges;
+        std::map<QByteArray, std::unique_ptr<Metrics::Histogram>> histograms;
+    };
+
+    Registry *registry()
+    {
+        static Registry registry;
+        return &registry;
+    }
+
+    template <typename T>
+    T &findOrCreate(std::map<QByteArray, std::unique_ptr<T>> &metrics, const QByteArray &name)
+    {
+        QMutexLocker lock(&registry()->mutex);
+        auto &metric = metrics[name];
+        if (!metric) {
+            metric = std::make_unique<T>();
+        }
+        return *metric;
+    }
+
+    int bucketOf(qint64 value)
+    {
+        int bucket = 0;
+        while (value > 0 && bucket < Metrics::Histogram::BucketCount - 1) {
+            value >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // Bucket 0 holds 0, bucket n holds values up to 2^n - 1
+    qint64 bucketUpperBound(int bucket)
+    {
+        return (qint64(1) << bucket) - 1;
+    }
+
+}
+
+std::atomic<bool> Metrics::_enabled{ qEnvironmentVariableIntValue("OWNCLOUD_METRICS") != 0 };
+
+void Metrics::Histogram::record(qint64 value)
+{
+    if (!Metrics::isEnabled()) {
+        return;
+    }
+    value = qMax(value, qint64(0));
+    _buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = _max.load(std::memory_order_relaxed);
+    while (value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+qint64 Metrics::Histogram::quantile(double quantile) const
+{
+    const auto total = count();
+    if (total == 0) {
+        return 0;
+    }
+    const auto rank = static_cast<qint64>(quantile * total);
+    qint64 seen = 0;
+    for (int bucket = 0; bucket < BucketCount; ++bucket) {
+        seen += _buckets[bucket].load(std::memory_order_relaxed);
+        if (seen > rank) {
+            return qMin(bucketUpperBound(bucket), max());
+        }
+    }
+    return max();
+}
+
+void Metrics::setEnabled(bool enabled)
+{
+    QMutexLocker lock(&registry()->mutex);
+    if (enabled && !isEnabled()) {
+        registry()->enabledTimer.restart();
+    }
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Metrics::Counter &Metrics::counter(const QByteArray &name)
+{
+    return findOrCreate(registry()->counters, name);
+}
+
+Metrics::Gauge &Metrics::gauge(const QByteArray &name)
+{
+    return findOrCreate(registry()->gauges, name);
+}
+
+Metrics::Histogram &Metrics::histogram(const QByteArray &name)
+{
+    return findOrCreate(registry()->histograms, name);
+}
+
+QJsonObject Metrics::snapshot()
+{
+    auto reg = registry();
+    QMutexLocker lock(&reg->mutex);
+
+    QJsonObject counters;
+    for (const auto &[name, counter] : reg->counters) {
+        counters.insert(QString::fromUtf8(name), counter->value());
+    }
+    QJsonObject gauges;
+    for (const auto &[name, gauge] : reg->gauges) {
+        gauges.insert(QString::fromUtf8(name), gauge->value());
+    }
+    QJsonObject histograms;
+    for (const auto &[name, histogram] : reg->histograms) {
+        const auto count = histogram->count();
+        histograms.insert(QString::fromUtf8(name), QJsonObject{
+            { QStringLiteral("count"), count },
+            { QStringLiteral("sum"), histogram->sum() },
+            { QStringLiteral("mean"), count > 0 ? double(histogram->sum()) / count : 0.0 },
+            { QStringLiteral("p50"), histogram->quantile(0.5) },
+            { QStringLiteral("p90"), histogram->quantile(0.9) },
+            { QStringLiteral("p99"), histogram->quantile(0.99) },
+            { QStringLiteral("max"), histogram->max() },
+        });
+    }
+
+    return {
+        { QStringLiteral("enabled"), isEnabled() },
+        { QStringLiteral("elapsedMsec"), reg->enabledTimer.elapsed() },
+        { QStringLiteral("counters"), counters },
+        { QStringLiteral("gauges"), gauges },
+        { QStringLiteral("histograms"), histograms },
+    };
+}
+
+}
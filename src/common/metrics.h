@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "ocsynclib.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QJsonObject>
+
+#include <array>
+#include <atomic>
+
+namespace OCC {
+
+/**
+ * @brief Process wide registry of counters, gauges and histograms
+ *
+ * Instrumented code looks a metric up once and keeps the reference:
+ *
+ *     static auto &queries = Metrics::counter("journal.queries");
+ *     queries.add();
+ *
+ * Metrics are never removed, references stay valid for the lifetime of the
+ * process. While metrics are disabled, updating one costs a single atomic load.
+ * They are enabled with OWNCLOUD_METRICS=1 or setEnabled().
+ *
+ * @ingroup libsync
+ */
+class OCSYNC_EXPORT Metrics
+{
+public:
+    class Counter
+    {
+    public:
+        void add(qint64 value = 1)
+        {
+            if (Metrics::isEnabled()) {
+                _value.fetch_add(value, std::memory_order_relaxed);
+            }
+        }
+        [[nodiscard]] qint64 value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> _value{0};
+    };
+
+    class Gauge
+    {
+    public:
+        void set(qint64 value)
+        {
+            if (Metrics::isEnabled()) {
+                _value.store(value, std::memory_order_relaxed);
+            }
+        }
+        [[nodiscard]] qint64 value() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<qint64> _value{0};
+    };
+
+    /** Distribution of non-negative values, in power of two buckets */
+    class Histogram
+    {
+    public:
+        static constexpr int BucketCount = 40;
+
+        void record(qint64 value);
+
+        [[nodiscard]] qint64 count() const { return _count.load(std::memory_order_relaxed); }
+        [[nodiscard]] qint64 sum() const { return _sum.load(std::memory_order_relaxed); }
+        [[nodiscard]] qint64 max() const { return _max.load(std::memory_order_relaxed); }
+        /** Upper bound of the bucket containing the given quantile, 0 <= quantile <= 1 */
+        [[nodiscard]] qint64 quantile(double quantile) const;
+
+    private:
+        std::array<std::atomic<qint64>, BucketCount> _buckets{};
+        std::atomic<qint64> _count{0};
+        std::atomic<qint64> _sum{0};
+        std::atomic<qint64> _max{0};
+    };
+
+    /** Records the microseconds from construction to destruction into a histogram */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram &histogram)
+            : _histogram(histogram)
+        {
+            if (Metrics::isEnabled()) {
+                _timer.start();
+            }
+        }
+        ~ScopedTimer()
+        {
+            if (_timer.isValid()) {
+                _histogram.record(_timer.nsecsElapsed() / 1000);
+            }
+        }
+
+    private:
+        Histogram &_histogram;
+        QElapsedTimer _timer;
+    };
+
+    [[nodiscard]] static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+
+    static Counter &counter(const QByteArray &name);
+    static Gauge &gauge(const QByteArray &name);
+    static Histogram &histogram(const QByteArray &name);
+
+    /** All metrics with their current values, and the time since they were enabled */
+    [[nodiscard]] static QJsonObject snapshot();
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+}
@@ -26,6 +26,7 @@
 #include "ownsql.h"
 #include "common/utility.h"
 #include "common/asserts.h"
+#include "common/metrics.h"
 #include <sqlite3.h>
 
 #define SQLITE_SLEEP_TIME_USEC 100000
@@ -297,6 +298,9 @@ bool SqlQuery::exec()
         return false;
     }
 
+    static auto &queries = Metrics::counter("journal.queries");
+    queries.add();
+
     // Don't do anything for selects, that is how we use the lib :-|
     if (!isSelect() && !isPragma()) {
         int rc = 0, n = 0;
@@ -63,6 +63,7 @@ public:
         GetFileRecordQueryByMangledName,
         GetFileRecordQueryByInode,
         GetFileRecordQueryByFileId,
+        GetFileRecordQueryByNumericFileId,
         GetFilesBelowPathQuery,
         GetAllFilesQuery,
         ListFilesInPathQuery,
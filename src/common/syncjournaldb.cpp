@@ -27,6 +27,8 @@
 #include <cstring>
 
 #include "common/syncjournaldb.h"
+#include "common/metrics.h"
+#include "common/synctrace.h"
 #include "version.h"
 #include "filesystembase.h"
 #include "common/asserts.h"
@@ -111,6 +113,14 @@ SyncJournalDb::SyncJournalDb(const QString &dbFilePath, QObject *parent)
     if (_journalMode.isEmpty()) {
         _journalMode = defaultJournalMode(_dbFile);
     }
+
+    _groupCommitTimer.setSingleShot(true);
+    connect(&_groupCommitTimer, &QTimer::timeout, this, [this] {
+        QMutexLocker lock(&_mutex);
+        if (_groupCommitPending > 0 && _transaction == 1) {
+            commitInternal(QStringLiteral("group commit delay"));
+        }
+    });
 }
 
 QString SyncJournalDb::makeDbName(const QString &localPath,
@@ -689,6 +699,9 @@ void SyncJournalDb::close()
     qCInfo(lcDb) << "Closing DB" << _dbFile;
 
     commitTransaction();
+    _groupCommitPending = 0;
+    _groupCommitTimer.stop();
+    _metadataSnapshot.reset();
 
     _db.close();
     clearEtagStorageFilter();
@@ -816,6 +829,17 @@ bool SyncJournalDb::updateMetadataTableStructure()
         commitInternal(QStringLiteral("update database structure: add e2eMangledName index"));
     }
 
+    if (true) {
+        SqlQuery query(_db);
+        // See getFileRecordsByNumericFileId(), the expression has to match the query for the index to be used
+        query.prepare("CREATE INDEX IF NOT EXISTS metadata_numeric_file_id ON metadata(CAST(fileid AS INTEGER));");
+        if (!query.exec()) {
+            sqlFail(QStringLiteral("updateMetadataTableStructure: create index numeric file id"), query);
+            re = false;
+        }
+        commitInternal(QStringLiteral("update database structure: add numeric file id index"));
+    }
+
     addColumn(QStringLiteral("lock"), QStringLiteral("INTEGER"));
     addColumn(QStringLiteral("lockType"), QStringLiteral("INTEGER"));
     addColumn(QStringLiteral("lockOwnerDisplayName"), QStringLiteral("TEXT"));
@@ -1027,6 +1051,14 @@ Result<void, QString> SyncJournalDb::setFileRecord(const SyncJournalFileRecord &
     // Can't be true anymore.
     _metadataTableIsEmpty = false;
 
+    if (_metadataSnapshot) {
+        // Store it the way it would be read back from the database
+        record._checksumHeader = contentChecksumTypeId ? makeChecksumHeader(checksumType, checksum) : QByteArray();
+        if (!_metadataSnapshot->replace(record)) {
+            dropMetadataSnapshot("new file record");
+        }
+    }
+
     return {};
 }
 
@@ -1090,6 +1122,8 @@ bool SyncJournalDb::deleteFileRecord(const QString &filename, bool recursively)
     QMutexLocker locker(&_mutex);
 
     if (checkConnect()) {
+        dropMetadataSnapshot("file record deleted");
+
         // if (!recursively) {
         // always delete the actual file.
 
@@ -1126,6 +1160,8 @@ bool SyncJournalDb::deleteFileRecord(const QString &filename, bool recursively)
 
 bool SyncJournalDb::getFileRecord(const QByteArray &filename, SyncJournalFileRecord *rec)
 {
+    static auto &latency = Metrics::histogram("journal.getFileRecord.usec");
+    const Metrics::ScopedTimer timer(latency);
     QMutexLocker locker(&_mutex);
 
     // Reset the output var in case the caller is reusing it.
@@ -1136,6 +1172,12 @@ bool SyncJournalDb::getFileRecord(const QByteArray &filename, SyncJournalFileRec
     if (_metadataTableIsEmpty)
         return true; // no error, yet nothing found (rec->isValid() == false)
 
+    if (_metadataSnapshot) {
+        // Leaves rec invalid if there is no record
+        _metadataSnapshot->findByPath(filename, rec);
+        return true;
+    }
+
     if (!checkConnect())
         return false;
 
@@ -1222,6 +1264,11 @@ bool SyncJournalDb::getFileRecordByInode(quint64 inode, SyncJournalFileRecord *r
     if (!inode || _metadataTableIsEmpty)
         return true; // no error, yet nothing found (rec->isValid() == false)
 
+    if (_metadataSnapshot) {
+        _metadataSnapshot->findByInode(inode, rec);
+        return true;
+    }
+
     if (!checkConnect())
         return false;
     const auto query = _queryManager.get(PreparedSqlQueryManager::GetFileRecordQueryByInode, QByteArrayLiteral(GET_FILE_RECORD_QUERY " WHERE inode=?1"), _db);
@@ -1249,6 +1296,12 @@ bool SyncJournalDb::getFileRecordsByFileId(const QByteArray &fileId, const std::
     if (fileId.isEmpty() || _metadataTableIsEmpty)
         return true; // no error, yet nothing found (rec->isValid() == false)
 
+    if (_metadataSnapshot) {
+        const auto snapshot = _metadataSnapshot;
+        snapshot->forEachWithFileId(fileId, rowCallback);
+        return true;
+    }
+
     if (!checkConnect())
         return false;
 
@@ -1277,6 +1330,45 @@ bool SyncJournalDb::getFileRecordsByFileId(const QByteArray &fileId, const std::
     return true;
 }
 
+bool SyncJournalDb::getFileRecordsByNumericFileId(qint64 numericFileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_metadataTableIsEmpty)
+        return true;
+
+    // Not answered from the metadata snapshot, which only indexes full file ids.
+    // The database has all writes as well.
+    if (!checkConnect())
+        return false;
+
+    // CAST takes the longest integer prefix: the numeric id without padding and instance id
+    const auto query = _queryManager.get(PreparedSqlQueryManager::GetFileRecordQueryByNumericFileId,
+        QByteArrayLiteral(GET_FILE_RECORD_QUERY " WHERE CAST(fileid AS INTEGER)=?1"), _db);
+    if (!query) {
+        return false;
+    }
+
+    query->bindValue(1, numericFileId);
+
+    if (!query->exec())
+        return false;
+
+    forever {
+        auto next = query->next();
+        if (!next.ok)
+            return false;
+        if (!next.hasData)
+            break;
+
+        SyncJournalFileRecord rec;
+        fillFileRecordFromGetQuery(rec, *query);
+        rowCallback(rec);
+    }
+
+    return true;
+}
+
 bool SyncJournalDb::getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback)
 {
     QMutexLocker locker(&_mutex);
@@ -1345,6 +1437,12 @@ bool SyncJournalDb::listFilesInPath(const QByteArray& path,
     if (_metadataTableIsEmpty)
         return true;
 
+    if (_metadataSnapshot) {
+        const auto snapshot = _metadataSnapshot;
+        snapshot->forEachChild(path, rowCallback);
+        return true;
+    }
+
     if (!checkConnect())
         return false;
 
@@ -1376,6 +1474,61 @@ bool SyncJournalDb::listFilesInPath(const QByteArray& path,
     return true;
 }
 
+bool SyncJournalDb::loadMetadataSnapshot()
+{
+    QMutexLocker locker(&_mutex);
+
+    if (!checkConnect())
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    SqlQuery query(QByteArrayLiteral(GET_FILE_RECORD_QUERY), _db);
+    if (!query.exec())
+        return false;
+
+    auto snapshot = std::make_shared<SyncJournalSnapshot>();
+    forever {
+        auto next = query.next();
+        if (!next.ok)
+            return false;
+        if (!next.hasData)
+            break;
+
+        SyncJournalFileRecord rec;
+        fillFileRecordFromGetQuery(rec, query);
+        snapshot->append(rec);
+    }
+    snapshot->finishLoading();
+
+    _metadataSnapshot = std::move(snapshot);
+    qCInfo(lcDb) << "Loaded metadata snapshot with" << _metadataSnapshot->size() << "records in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void SyncJournalDb::releaseMetadataSnapshot()
+{
+    QMutexLocker locker(&_mutex);
+    if (_metadataSnapshot) {
+        qCInfo(lcDb) << "Releasing metadata snapshot";
+        _metadataSnapshot.reset();
+    }
+}
+
+bool SyncJournalDb::hasMetadataSnapshot() const
+{
+    return _metadataSnapshot != nullptr;
+}
+
+void SyncJournalDb::dropMetadataSnapshot(const char *reason)
+{
+    if (_metadataSnapshot) {
+        qCInfo(lcDb) << "Dropping metadata snapshot:" << reason;
+        _metadataSnapshot.reset();
+    }
+}
+
 int SyncJournalDb::getFileRecordCount()
 {
     QMutexLocker locker(&_mutex);
@@ -1421,7 +1574,14 @@ bool SyncJournalDb::updateFileRecordChecksum(const QString &filename,
     query->bindValue(1, phash);
     query->bindValue(2, contentChecksum);
     query->bindValue(3, checksumTypeId);
-    return query->exec();
+    if (!query->exec()) {
+        return false;
+    }
+
+    if (_metadataSnapshot) {
+        _metadataSnapshot->updateChecksum(filename.toUtf8(), checksumTypeId ? makeChecksumHeader(contentChecksumType, contentChecksum) : QByteArray());
+    }
+    return true;
 }
 
 bool SyncJournalDb::updateLocalMetadata(const QString &filename,
@@ -1459,7 +1619,14 @@ bool SyncJournalDb::updateLocalMetadata(const QString &filename,
     query->bindValue(9, lockInfo._lockEditorApp);
     query->bindValue(10, lockInfo._lockTime);
     query->bindValue(11, lockInfo._lockTimeout);
-    return query->exec();
+    if (!query->exec()) {
+        return false;
+    }
+
+    if (_metadataSnapshot) {
+        _metadataSnapshot->updateLocalMetadata(filename.toUtf8(), modtime, size, inode, lockInfo);
+    }
+    return true;
 }
 
 Optional<SyncJournalDb::HasHydratedDehydrated> SyncJournalDb::hasHydratedOrDehydratedFiles(const QByteArray &filename)
@@ -2038,6 +2205,8 @@ void SyncJournalDb::avoidRenamesOnNextSync(const QByteArray &path)
         return;
     }
 
+    dropMetadataSnapshot("avoid renames");
+
     SqlQuery query(_db);
     query.prepare("UPDATE metadata SET fileid = '', inode = '0' WHERE " IS_PREFIX_PATH_OR_EQUAL("?1", "path"));
     query.bindValue(1, path);
@@ -2064,6 +2233,8 @@ void SyncJournalDb::schedulePathForRemoteDiscovery(const QByteArray &fileName)
     if (argument.endsWith('/'))
         argument.chop(1);
 
+    dropMetadataSnapshot("remote discovery scheduled");
+
     SqlQuery query(_db);
     // This query will match entries for which the path is a prefix of fileName
     // Note: CSYNC_FTW_TYPE_DIR == 2
@@ -2099,6 +2270,7 @@ void SyncJournalDb::forceRemoteDiscoveryNextSync()
 void SyncJournalDb::forceRemoteDiscoveryNextSyncLocked()
 {
     qCInfo(lcDb) << "Forcing remote re-discovery by deleting folder Etags";
+    dropMetadataSnapshot("remote discovery forced");
     SqlQuery deleteRemoteFolderEtagsQuery(_db);
     deleteRemoteFolderEtagsQuery.prepare("UPDATE metadata SET md5='_invalid_' WHERE type=2;");
 
@@ -2404,6 +2576,7 @@ QByteArray SyncJournalDb::conflictFileBaseName(const QByteArray &conflictName)
 void SyncJournalDb::clearFileTable()
 {
     QMutexLocker lock(&_mutex);
+    dropMetadataSnapshot("file table cleared");
     SqlQuery query(_db);
     query.prepare("DELETE FROM metadata;");
 
@@ -2418,6 +2591,8 @@ void SyncJournalDb::markVirtualFileForDownloadRecursively(const QByteArray &path
     if (!checkConnect())
         return;
 
+    dropMetadataSnapshot("virtual files marked for download");
+
     static_assert(ItemTypeVirtualFile == 4 && ItemTypeVirtualFileDownload == 5, "");
     SqlQuery query("UPDATE metadata SET type=5 WHERE "
                    "(" IS_PREFIX_PATH_OF("?1", "path") " OR ?1 == '') "
@@ -2680,6 +2855,49 @@ void SyncJournalDb::commitIfNeededAndStartNewTransaction(const QString &context)
     }
 }
 
+void SyncJournalDb::setGroupCommitEnabled(bool enabled)
+{
+    QMutexLocker lock(&_mutex);
+    if (_groupCommitEnabled == enabled) {
+        return;
+    }
+    qCInfo(lcDb) << "Group commit" << (enabled ? "enabled," : "disabled,")
+                 << "max pending:" << _groupCommitMaxPending << "max delay:" << _groupCommitMaxDelay.count() << "ms";
+    _groupCommitEnabled = enabled;
+    if (!enabled && _groupCommitPending > 0) {
+        commitInternal(QStringLiteral("group commit disabled"));
+    }
+}
+
+bool SyncJournalDb::isGroupCommitEnabled() const
+{
+    return _groupCommitEnabled;
+}
+
+void SyncJournalDb::setGroupCommitLimits(int maxPendingCommits, std::chrono::milliseconds maxDelay)
+{
+    QMutexLocker lock(&_mutex);
+    _groupCommitMaxPending = qMax(1, maxPendingCommits);
+    _groupCommitMaxDelay = maxDelay;
+}
+
+void SyncJournalDb::commitGrouped(const QString &context)
+{
+    QMutexLocker lock(&_mutex);
+    if (_groupCommitEnabled && _transaction == 1) {
+        ++_groupCommitPending;
+        if (_groupCommitPending < _groupCommitMaxPending
+            && _lastCommitTimer.isValid() && _lastCommitTimer.elapsed() < _groupCommitMaxDelay.count()) {
+            qCDebug(lcDb) << "Transaction commit" << context << "grouped," << _groupCommitPending << "pending";
+            if (!_groupCommitTimer.isActive()) {
+                _groupCommitTimer.start(_groupCommitMaxDelay - std::chrono::milliseconds(_lastCommitTimer.elapsed()));
+            }
+            return;
+        }
+    }
+    commitInternal(context);
+}
+
 bool SyncJournalDb::open()
 {
     QMutexLocker lock(&_mutex);
@@ -2694,8 +2912,15 @@ bool SyncJournalDb::isOpen()
 
 void SyncJournalDb::commitInternal(const QString &context, bool startTrans)
 {
-    qCDebug(lcDb) << "Transaction commit" << context << (startTrans ? "and starting new transaction" : "");
+    qCDebug(lcDb) << "Transaction commit" << context << (startTrans ? "and starting new transaction" : "")
+                  << (_groupCommitPending > 0 ? QStringLiteral("with %1 grouped").arg(_groupCommitPending) : QString());
+    const SyncTrace::Scope traceScope(SyncTrace::Journal, QStringLiteral("commit"), context);
+    static auto &latency = Metrics::histogram("journal.commit.usec");
+    const Metrics::ScopedTimer timer(latency);
     commitTransaction();
+    _groupCommitPending = 0;
+    _groupCommitTimer.stop();
+    _lastCommitTimer.start();
 
     if (startTrans) {
         startTransaction();
@@ -21,15 +21,20 @@
 
 #include <QObject>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMutex>
+#include <QTimer>
 #include <QVariant>
+#include <chrono>
 #include <functional>
+#include <memory>
 
 #include "common/utility.h"
 #include "common/ownsql.h"
 #include "common/preparedsqlquerymanager.h"
 #include "common/syncjournalfilerecord.h"
+#include "common/syncjournalsnapshot.h"
 #include "common/result.h"
 #include "common/pinstate.h"
 
@@ -67,8 +72,27 @@ public:
     [[nodiscard]] bool getFileRecordByE2eMangledName(const QString &mangledName, SyncJournalFileRecord *rec);
     [[nodiscard]] bool getFileRecordByInode(quint64 inode, SyncJournalFileRecord *rec);
     [[nodiscard]] bool getFileRecordsByFileId(const QByteArray &fileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
+    /** Like getFileRecordsByFileId(), but matches the numeric id only
+     *
+     * The journal keeps file ids as the server formats them, padded and followed
+     * by the instance id, see SyncJournalFileRecord::numericFileId().
+     */
+    [[nodiscard]] bool getFileRecordsByNumericFileId(qint64 numericFileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback);
     [[nodiscard]] bool getFilesBelowPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
     [[nodiscard]] bool listFilesInPath(const QByteArray &path, const std::function<void(const SyncJournalFileRecord&)> &rowCallback);
+
+    /** Loads the metadata table into memory
+     *
+     * While the snapshot is loaded, getFileRecord(), getFileRecordByInode(),
+     * getFileRecordsByFileId() and listFilesInPath() are answered from it instead
+     * of SQLite. Writes still go to the database and are applied to the snapshot,
+     * or drop it when that is not possible, so reads never see stale data.
+     *
+     * Used by the sync engine for the discovery phase.
+     */
+    bool loadMetadataSnapshot();
+    void releaseMetadataSnapshot();
+    [[nodiscard]] bool hasMetadataSnapshot() const;
     [[nodiscard]] Result<void, QString> setFileRecord(const SyncJournalFileRecord &record);
 
     void keyValueStoreSet(const QString &key, QVariant value);
@@ -217,6 +241,29 @@ public:
     void commit(const QString &context, bool startTrans = true);
     void commitIfNeededAndStartNewTransaction(const QString &context);
 
+    /** Group commit mode
+     *
+     * While enabled, commitGrouped() only commits once maxPendingCommits grouped
+     * commits accumulated or maxDelay passed since the last real commit. A timer
+     * commits grouped commits at the latest after maxDelay even if no further
+     * commit comes. Any commit() and close() also commit everything grouped so far.
+     *
+     * Used during propagation, where a commit (and fsync) per file dominates
+     * the time spent on many small files. Disabling flushes pending commits.
+     */
+    void setGroupCommitEnabled(bool enabled);
+    [[nodiscard]] bool isGroupCommitEnabled() const;
+    void setGroupCommitLimits(int maxPendingCommits, std::chrono::milliseconds maxDelay);
+
+    /** Like commit(), but may be grouped with later commits in group commit mode
+     *
+     * Only for writes a crash may lose without harm because the next sync
+     * rediscovers them, like the metadata of a completed transfer. Resume records
+     * (download, upload and poll infos) must be written with commit() so they are
+     * on disk before the transfer they describe starts.
+     */
+    void commitGrouped(const QString &context);
+
     /** Open the db if it isn't already.
      *
      * This usually creates some temporary files next to the db file, like
@@ -412,6 +459,9 @@ private:
     // Same as forceRemoteDiscoveryNextSync but without acquiring the lock
     void forceRemoteDiscoveryNextSyncLocked();
 
+    // For writes the metadata snapshot can't follow
+    void dropMetadataSnapshot(const char *reason);
+
     // Returns the integer id of the checksum type
     //
     // Returns 0 on failure and for empty checksum types.
@@ -424,6 +474,13 @@ private:
     int _transaction = 0;
     bool _metadataTableIsEmpty = false;
 
+    bool _groupCommitEnabled = false;
+    int _groupCommitMaxPending = 100;
+    std::chrono::milliseconds _groupCommitMaxDelay = std::chrono::seconds(1);
+    int _groupCommitPending = 0;
+    QElapsedTimer _lastCommitTimer;
+    QTimer _groupCommitTimer; /// enforces _groupCommitMaxDelay for the pending commits
+
     /* Storing etags to these folders, or their parent folders, is filtered out.
      *
      * When schedulePathForRemoteDiscovery() is called some etags to _invalid_ in the
@@ -439,6 +496,11 @@ private:
      */
     QList<QByteArray> _etagStorageFilter;
 
+    /* See loadMetadataSnapshot(). Shared so that a snapshot dropped by a write
+     * from within a row callback stays alive until the iteration is done.
+     */
+    std::shared_ptr<SyncJournalSnapshot> _metadataSnapshot;
+
     /** The journal mode to use for the db.
      *
      * Typically WAL initially, but may be set to other modes via environment
@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "common/syncjournalsnapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace OCC {
+
+namespace {
+
+    // Length of the parent directory part of path, 0 for entries in the sync root
+    int parentLength(const QByteArray &path)
+    {
+        const auto slash = path.lastIndexOf('/');
+        return slash < 0 ? 0 : slash;
+    }
+
+    // memcmp semantics, like the BINARY collation of sqlite
+    int compareBytes(const char *a, int aSize, const char *b, int bSize)
+    {
+        const auto cmp = std::memcmp(a, b, static_cast<size_t>(std::min(aSize, bSize)));
+        if (cmp != 0) {
+            return cmp;
+        }
+        return aSize < bSize ? -1 : (aSize > bSize ? 1 : 0);
+    }
+
+    int compareParent(const QByteArray &path, const QByteArray &parent)
+    {
+        return compareBytes(path.constData(), parentLength(path), parent.constData(), parent.size());
+    }
+
+    // Orders by parent directory, then like "ORDER BY path||'/'"
+    bool pathLess(const QByteArray &a, const QByteArray &b)
+    {
+        const auto parentCmp = compareBytes(a.constData(), parentLength(a), b.constData(), parentLength(b));
+        if (parentCmp != 0) {
+            return parentCmp < 0;
+        }
+
+        const auto common = std::min(a.size(), b.size());
+        const auto cmp = std::memcmp(a.constData(), b.constData(), static_cast<size_t>(common));
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+        // One is a prefix of the other: the shorter one continues with the '/'
+        const auto nextChar = [common](const QByteArray &path) {
+            return static_cast<unsigned char>(common < path.size() ? path.at(common) : '/');
+        };
+        const auto aNext = nextChar(a);
+        const auto bNext = nextChar(b);
+        if (aNext != bNext) {
+            return aNext < bNext;
+        }
+        return a.size() < b.size();
+    }
+
+    bool isUnlocked(const SyncJournalFileLockInfo &lockInfo)
+    {
+        return !lockInfo._locked && lockInfo._lockOwnerDisplayName.isEmpty() && lockInfo._lockOwnerId.isEmpty()
+            && lockInfo._lockOwnerType == 0 && lockInfo._lockEditorApp.isEmpty()
+            && lockInfo._lockTime == 0 && lockInfo._lockTimeout == 0;
+    }
+
+    // Puts column into the given row order
+    template <typename T>
+    void reorder(QVector<T> &column, const QVector<int> &order)
+    {
+        QVector<T> sorted;
+        sorted.reserve(column.size());
+        for (const auto index : order) {
+            sorted.append(std::move(column[index]));
+        }
+        column = std::move(sorted);
+    }
+
+    template <typename T>
+    void reorder(QHash<int, T> &sparseColumn, const QVector<int> &newIndexes)
+    {
+        QHash<int, T> sorted;
+        sorted.reserve(sparseColumn.size());
+        for (auto it = sparseColumn.begin(); it != sparseColumn.end(); ++it) {
+            sorted.insert(newIndexes.at(it.key()), std::move(it.value()));
+        }
+        sparseColumn = std::move(sorted);
+    }
+
+}
+
+void SyncJournalSnapshot::append(const SyncJournalFileRecord &record)
+{
+    const auto index = _paths.size();
+    _paths.append(record._path);
+    _inodes.append(0);
+    _modtimes.append(0);
+    _fileSizes.append(0);
+    _etags.append({});
+    _fileIds.append({});
+    _checksumHeaders.append({});
+    _remotePerms.append({});
+    _attributes.append({});
+    store(index, record);
+}
+
+void SyncJournalSnapshot::finishLoading()
+{
+    QVector<int> order(_paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return pathLess(_paths.at(a), _paths.at(b));
+    });
+    QVector<int> newIndexes(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        newIndexes[order.at(i)] = i;
+    }
+
+    reorder(_paths, order);
+    reorder(_inodes, order);
+    reorder(_modtimes, order);
+    reorder(_fileSizes, order);
+    reorder(_etags, order);
+    reorder(_fileIds, order);
+    reorder(_checksumHeaders, order);
+    reorder(_remotePerms, order);
+    reorder(_attributes, order);
+    reorder(_e2eMangledNames, newIndexes);
+    reorder(_lockStates, newIndexes);
+    reorder(_lastShareStateFetchedTimestamps, newIndexes);
+
+    _inodeIndex.clear();
+    _fileIdIndex.clear();
+    _inodeIndex.reserve(_paths.size());
+    _fileIdIndex.reserve(_paths.size());
+    for (int i = 0; i < _paths.size(); ++i) {
+        addToIndexes(i);
+    }
+}
+
+int SyncJournalSnapshot::indexOf(const QByteArray &path) const
+{
+    const auto it = std::lower_bound(_paths.cbegin(), _paths.cend(), path, pathLess);
+    if (it == _paths.cend() || *it != path) {
+        return -1;
+    }
+    return static_cast<int>(it - _paths.cbegin());
+}
+
+SyncJournalFileRecord SyncJournalSnapshot::recordAt(int index) const
+{
+    SyncJournalFileRecord record;
+    const auto &attributes = _attributes.at(index);
+    record._path = _paths.at(index);
+    record._inode = _inodes.at(index);
+    record._modtime = _modtimes.at(index);
+    record._type = static_cast<ItemType>(attributes.type);
+    record._etag = _etags.at(index);
+    record._fileId = _fileIds.at(index);
+    record._fileSize = _fileSizes.at(index);
+    record._remotePerm = _remotePerms.at(index);
+    record._serverHasIgnoredFiles = attributes.serverHasIgnoredFiles;
+    record._checksumHeader = _checksumHeaders.at(index);
+    record._e2eMangledName = _e2eMangledNames.value(index);
+    record._e2eEncryptionStatus = static_cast<SyncJournalFileRecord::EncryptionStatus>(attributes.e2eEncryptionStatus);
+    record._lockstate = _lockStates.value(index);
+    record._isShared = attributes.isShared;
+    record._lastShareStateFetchedTimestamp = _lastShareStateFetchedTimestamps.value(index);
+    record._sharedByMe = attributes.sharedByMe;
+    return record;
+}
+
+void SyncJournalSnapshot::store(int index, const SyncJournalFileRecord &record)
+{
+    _inodes[index] = record._inode;
+    _modtimes[index] = record._modtime;
+    _fileSizes[index] = record._fileSize;
+    _etags[index] = record._etag;
+    _fileIds[index] = record._fileId;
+    _checksumHeaders[index] = record._checksumHeader;
+    _remotePerms[index] = record._remotePerm;
+
+    auto &attributes = _attributes[index];
+    attributes.type = static_cast<quint8>(record._type);
+    attributes.e2eEncryptionStatus = static_cast<quint8>(record._e2eEncryptionStatus);
+    attributes.serverHasIgnoredFiles = record._serverHasIgnoredFiles;
+    attributes.isShared = record._isShared;
+    attributes.sharedByMe = record._sharedByMe;
+
+    if (record._e2eMangledName.isEmpty()) {
+        _e2eMangledNames.remove(index);
+    } else {
+        _e2eMangledNames.insert(index, record._e2eMangledName);
+    }
+    storeLockInfo(index, record._lockstate);
+    if (record._lastShareStateFetchedTimestamp == 0) {
+        _lastShareStateFetchedTimestamps.remove(index);
+    } else {
+        _lastShareStateFetchedTimestamps.insert(index, record._lastShareStateFetchedTimestamp);
+    }
+}
+
+void SyncJournalSnapshot::storeLockInfo(int index, const SyncJournalFileLockInfo &lockInfo)
+{
+    if (isUnlocked(lockInfo)) {
+        _lockStates.remove(index);
+    } else {
+        _lockStates.insert(index, lockInfo);
+    }
+}
+
+bool SyncJournalSnapshot::findByPath(const QByteArray &path, SyncJournalFileRecord *record) const
+{
+    const auto index = indexOf(path);
+    if (index < 0) {
+        return false;
+    }
+    *record = recordAt(index);
+    return true;
+}
+
+bool SyncJournalSnapshot::findByInode(quint64 inode, SyncJournalFileRecord *record) const
+{
+    const auto it = _inodeIndex.constFind(inode);
+    if (it == _inodeIndex.cend()) {
+        return false;
+    }
+    *record = recordAt(it.value());
+    return true;
+}
+
+void SyncJournalSnapshot::forEachWithFileId(const QByteArray &fileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback) const
+{
+    // Collect first, the callback might modify the snapshot
+    QVector<int> indexes;
+    for (auto it = _fileIdIndex.constFind(fileId); it != _fileIdIndex.cend() && it.key() == fileId; ++it) {
+        indexes.append(it.value());
+    }
+    std::sort(indexes.begin(), indexes.end());
+    for (const auto index : indexes) {
+        rowCallback(recordAt(index));
+    }
+}
+
+void SyncJournalSnapshot::forEachChild(const QByteArray &path, const std::function<void(const SyncJournalFileRecord &)> &rowCallback) const
+{
+    const auto begin = std::lower_bound(_paths.cbegin(), _paths.cend(), path, [](const QByteArray &childPath, const QByteArray &parent) {
+        return compareParent(childPath, parent) < 0;
+    });
+    const auto end = std::upper_bound(begin, _paths.cend(), path, [](const QByteArray &parent, const QByteArray &childPath) {
+        return compareParent(childPath, parent) > 0;
+    });
+
+    for (auto it = begin; it != end; ++it) {
+        // The sync root has no record, but its children have no parent part either
+        if (path.isEmpty() && it->isEmpty()) {
+            continue;
+        }
+        rowCallback(recordAt(static_cast<int>(it - _paths.cbegin())));
+    }
+}
+
+bool SyncJournalSnapshot::replace(const SyncJournalFileRecord &record)
+{
+    const auto index = indexOf(record._path);
+    if (index < 0) {
+        return false;
+    }
+    removeFromIndexes(index);
+    store(index, record);
+    addToIndexes(index);
+    return true;
+}
+
+void SyncJournalSnapshot::updateLocalMetadata(const QByteArray &path, qint64 modtime, qint64 size, quint64 inode, const SyncJournalFileLockInfo &lockInfo)
+{
+    const auto index = indexOf(path);
+    if (index < 0) {
+        return;
+    }
+    removeFromIndexes(index);
+    _inodes[index] = inode;
+    _modtimes[index] = modtime;
+    _fileSizes[index] = size;
+    storeLockInfo(index, lockInfo);
+    addToIndexes(index);
+}
+
+void SyncJournalSnapshot::updateChecksum(const QByteArray &path, const QByteArray &checksumHeader)
+{
+    const auto index = indexOf(path);
+    if (index >= 0) {
+        _checksumHeaders[index] = checksumHeader;
+    }
+}
+
+void SyncJournalSnapshot::addToIndexes(int index)
+{
+    if (const auto inode = _inodes.at(index)) {
+        _inodeIndex.insert(inode, index);
+    }
+    const auto &fileId = _fileIds.at(index);
+    if (!fileId.isEmpty()) {
+        _fileIdIndex.insert(fileId, index);
+    }
+}
+
+void SyncJournalSnapshot::removeFromIndexes(int index)
+{
+    if (const auto inode = _inodes.at(index)) {
+        _inodeIndex.remove(inode, index);
+    }
+    const auto &fileId = _fileIds.at(index);
+    if (!fileId.isEmpty()) {
+        _fileIdIndex.remove(fileId, index);
+    }
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "ocsynclib.h"
+#include "common/syncjournalfilerecord.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QMultiHash>
+#include <QVector>
+
+#include <functional>
+
+namespace OCC {
+
+/**
+ * @brief In-memory copy of the metadata table of the journal
+ *
+ * The fields are stored in columns instead of one SyncJournalFileRecord per
+ * row: the frequent ones in arrays, the rarely set ones (mangled names, lock
+ * info, share state timestamps) in hashes by row. Records are put together
+ * again on lookup.
+ *
+ * The rows are sorted by parent directory first and then like "ORDER BY path||'/'".
+ * That way the direct children of a directory are contiguous and in the order
+ * SyncJournalDb::listFilesInPath() returns them, and looking up a path is a
+ * binary search. Hash indexes map inodes and file ids to rows.
+ *
+ * The snapshot can't take new paths: the owner has to drop it when a write adds
+ * or removes records.
+ *
+ * @ingroup libsync
+ */
+class OCSYNC_EXPORT SyncJournalSnapshot
+{
+public:
+    /// Adds a record while loading, in any order
+    void append(const SyncJournalFileRecord &record);
+    /// Sorts the rows and builds the indexes, call it once all records are appended
+    void finishLoading();
+
+    [[nodiscard]] int size() const { return _paths.size(); }
+
+    /// Returns false if there is no record for the path
+    bool findByPath(const QByteArray &path, SyncJournalFileRecord *record) const;
+
+    /// Returns false if no record has that inode
+    bool findByInode(quint64 inode, SyncJournalFileRecord *record) const;
+
+    void forEachWithFileId(const QByteArray &fileId, const std::function<void(const SyncJournalFileRecord &)> &rowCallback) const;
+
+    /// Calls rowCallback for the direct children of path, "" being the sync root
+    void forEachChild(const QByteArray &path, const std::function<void(const SyncJournalFileRecord &)> &rowCallback) const;
+
+    /** Replaces the record with the same path
+     *
+     * Returns false if the path is unknown.
+     */
+    bool replace(const SyncJournalFileRecord &record);
+
+    /// Same fields as SyncJournalDb::updateLocalMetadata(). Unknown paths are ignored.
+    void updateLocalMetadata(const QByteArray &path, qint64 modtime, qint64 size, quint64 inode, const SyncJournalFileLockInfo &lockInfo);
+
+    /// Unknown paths are ignored
+    void updateChecksum(const QByteArray &path, const QByteArray &checksumHeader);
+
+private:
+    /// The small fields of a row, packed
+    struct Attributes
+    {
+        quint8 type = ItemTypeSkip;
+        quint8 e2eEncryptionStatus = 0;
+        bool serverHasIgnoredFiles = false;
+        bool isShared = false;
+        bool sharedByMe = false;
+    };
+
+    /// Returns -1 if there is no record for the path
+    [[nodiscard]] int indexOf(const QByteArray &path) const;
+    [[nodiscard]] SyncJournalFileRecord recordAt(int index) const;
+    /// Sets all fields of the row but the path
+    void store(int index, const SyncJournalFileRecord &record);
+    void storeLockInfo(int index, const SyncJournalFileLockInfo &lockInfo);
+    void addToIndexes(int index);
+    void removeFromIndexes(int index);
+
+    QVector<QByteArray> _paths;
+    QVector<quint64> _inodes;
+    QVector<qint64> _modtimes;
+    QVector<qint64> _fileSizes;
+    QVector<QByteArray> _etags;
+    QVector<QByteArray> _fileIds;
+    QVector<QByteArray> _checksumHeaders;
+    QVector<RemotePermissions> _remotePerms;
+    QVector<Attributes> _attributes;
+
+    // Rarely set, by row
+    QHash<int, QByteArray> _e2eMangledNames;
+    QHash<int, SyncJournalFileLockInfo> _lockStates;
+    QHash<int, qint64> _lastShareStateFetchedTimestamps;
+
+    QMultiHash<quint64, int> _inodeIndex;
+    QMultiHash<QByteArray, int> _fileIdIndex;
+};
+
+}
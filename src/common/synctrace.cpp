@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "common/synctrace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <thread>
+#include <utility>
+
+namespace OCC {
+
+Q_LOGGING_CATEGORY(lcSyncTrace, "nextcloud.sync.trace", QtInfoMsg)
+
+namespace {
+
+    constexpr int BufferedEventsCount = 16384;
+
+    struct TraceEvent
+    {
+        SyncTrace::Category category;
+        QString name;
+        QString path;
+        qint64 startUsec;
+        qint64 endUsec;
+        qint64 size;
+        qint64 bytes;
+        int httpStatus;
+        quintptr threadId;
+    };
+
+    QLatin1String categoryName(SyncTrace::Category category)
+    {
+        switch (category) {
+        case SyncTrace::Discovery:
+            return QLatin1String("discovery");
+        case SyncTrace::Propagation:
+            return QLatin1String("propagation");
+        case SyncTrace::Journal:
+            return QLatin1String("journal");
+        case SyncTrace::Network:
+            return QLatin1String("network");
+        }
+        return QLatin1String("unknown");
+    }
+
+    struct TraceState;
+    TraceState *traceState();
+
+    struct TraceState
+    {
+        QMutex mutex;
+        QElapsedTimer timer;
+        /// The buffer record() appends to
+        QVector<TraceEvent> events;
+
+        // Full buffers are written by a thread of their own, record() doesn't wait for the disk
+        std::thread writer;
+        QWaitCondition writerWakeup;
+        QWaitCondition buffersWritten;
+        QVector<QVector<TraceEvent>> pendingBuffers;
+        bool writing = false;
+        bool writerRunning = false;
+        bool stopWriter = false;
+
+        /// Only used by the writer while writing is set, and with the mutex held otherwise
+        QFile file;
+        quint64 nextId = 0;
+
+        TraceState()
+        {
+            // Joining a thread from a static destructor can deadlock on Windows, stop the
+            // writer while the application object goes away instead, like Logger does
+            qAddPostRoutine([] {
+                traceState()->stopWriterThread();
+            });
+        }
+
+        ~TraceState()
+        {
+            stopWriterThread();
+        }
+
+        void startWriterNoLock()
+        {
+            if (writerRunning || stopWriter) {
+                return;
+            }
+            writerRunning = true;
+            writer = std::thread([this] {
+                writerLoop();
+            });
+        }
+
+        /// Writes the queued events and stops the writer, events are written synchronously afterwards
+        void stopWriterThread()
+        {
+            {
+                QMutexLocker lock(&mutex);
+                queueEventsNoLock();
+                stopWriter = true;
+                writerWakeup.wakeOne();
+            }
+            if (writer.joinable()) {
+                writer.join();
+            }
+        }
+
+        /// Hands the recorded events over to the writer, or writes them if there is none
+        void queueEventsNoLock()
+        {
+            if (events.isEmpty()) {
+                return;
+            }
+            if (!writerRunning) {
+                write(std::exchange(events, {}));
+                return;
+            }
+            pendingBuffers.append(std::exchange(events, {}));
+            writerWakeup.wakeOne();
+        }
+
+        /// Waits until the writer is done with all queued events
+        void waitForWriterNoLock()
+        {
+            while (!pendingBuffers.isEmpty() || writing) {
+                buffersWritten.wait(&mutex);
+            }
+        }
+
+        void writerLoop()
+        {
+            QMutexLocker lock(&mutex);
+            for (;;) {
+                while (pendingBuffers.isEmpty() && !stopWriter) {
+                    writerWakeup.wait(&mutex);
+                }
+                if (pendingBuffers.isEmpty()) {
+                    writerRunning = false;
+                    break;
+                }
+                const auto buffers = std::exchange(pendingBuffers, {});
+                writing = true;
+                lock.unlock();
+                for (const auto &buffer : buffers) {
+                    write(buffer);
+                }
+                lock.relock();
+                writing = false;
+                buffersWritten.wakeAll();
+            }
+        }
+
+        // Each event becomes a pair of async begin/end events, jobs on the same
+        // thread overlap instead of nesting
+        void write(const QVector<TraceEvent> &buffer)
+        {
+            if (!file.isOpen()) {
+                return;
+            }
+            const qint64 pid = QCoreApplication::applicationPid();
+            QByteArray out;
+            for (const auto &event : buffer) {
+                QJsonObject args;
+                if (!event.path.isEmpty()) {
+                    args.insert(QStringLiteral("path"), event.path);
+                }
+                if (event.size > 0) {
+                    args.insert(QStringLiteral("size"), event.size);
+                }
+                if (event.httpStatus > 0) {
+                    args.insert(QStringLiteral("status"), event.httpStatus);
+                }
+                if (event.bytes > 0) {
+                    args.insert(QStringLiteral("bytes"), event.bytes);
+                }
+                QJsonObject begin{
+                    { QStringLiteral("cat"), categoryName(event.category) },
+                    { QStringLiteral("name"), event.name },
+                    { QStringLiteral("id"), QString::number(nextId++) },
+                    { QStringLiteral("pid"), pid },
+                    { QStringLiteral("tid"), static_cast<qint64>(event.threadId) },
+                };
+                auto end = begin;
+                begin.insert(QStringLiteral("ph"), QStringLiteral("b"));
+                begin.insert(QStringLiteral("ts"), event.startUsec);
+                begin.insert(QStringLiteral("args"), args);
+                end.insert(QStringLiteral("ph"), QStringLiteral("e"));
+                end.insert(QStringLiteral("ts"), event.endUsec);
+                out += QJsonDocument(begin).toJson(QJsonDocument::Compact) + ",\n";
+                out += QJsonDocument(end).toJson(QJsonDocument::Compact) + ",\n";
+            }
+            if (file.write(out) != out.size()) {
+                qCWarning(lcSyncTrace) << "Could not write to trace file" << file.fileName() << file.errorString();
+            }
+            file.flush();
+        }
+    };
+
+    TraceState *traceState()
+    {
+        static TraceState state;
+        return &state;
+    }
+
+}
+
+std::atomic<bool> SyncTrace::_enabled{false};
+
+void SyncTrace::setOutputFile(const QString &path)
+{
+    auto state = traceState();
+    QMutexLocker lock(&state->mutex);
+    _enabled.store(false, std::memory_order_relaxed);
+    state->queueEventsNoLock();
+    state->waitForWriterNoLock();
+    state->file.close();
+    if (path.isEmpty()) {
+        return;
+    }
+
+    state->file.setFileName(path);
+    if (!state->file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(lcSyncTrace) << "Could not open trace file" << path << state->file.errorString();
+        return;
+    }
+    // The closing bracket is optional in the JSON array format, so later syncs can append
+    if (state->file.size() == 0) {
+        state->file.write("[\n");
+    }
+    state->startWriterNoLock();
+    if (!state->timer.isValid()) {
+        state->timer.start();
+    }
+    qCInfo(lcSyncTrace) << "Recording sync trace to" << path;
+    _enabled.store(true, std::memory_order_relaxed);
+}
+
+qint64 SyncTrace::now()
+{
+    return traceState()->timer.nsecsElapsed() / 1000;
+}
+
+void SyncTrace::record(Category category, const QString &name, const QString &path, qint64 startUsec,
+    qint64 size, int httpStatus, qint64 bytes)
+{
+    if (!isEnabled()) {
+        return;
+    }
+    const auto endUsec = now();
+    const auto threadId = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+    auto state = traceState();
+    QMutexLocker lock(&state->mutex);
+    state->events.append({ category, name, path, startUsec, endUsec, size, bytes, httpStatus, threadId });
+    if (state->events.size() >= BufferedEventsCount) {
+        state->queueEventsNoLock();
+    }
+}
+
+void SyncTrace::flush()
+{
+    if (!isEnabled()) {
+        return;
+    }
+    auto state = traceState();
+    QMutexLocker lock(&state->mutex);
+    state->queueEventsNoLock();
+    state->waitForWriterNoLock();
+}
+
+}
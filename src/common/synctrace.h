@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "ocsynclib.h"
+
+#include <QString>
+
+#include <atomic>
+
+namespace OCC {
+
+/**
+ * @brief Opt-in recorder of timed sync events for post-mortem analysis
+ *
+ * Records discovery jobs, propagator jobs, journal commits and network requests
+ * with their begin and end timestamps. The events are collected in a fixed size
+ * in-memory buffer. A full buffer is handed to a writer thread, which appends it
+ * to the trace file in the Chrome trace event format, so recording never waits
+ * for the disk. flush() writes the rest, at the latest when a sync ends. The
+ * writer stops when the application object goes away, events are written
+ * synchronously after that. Open the file in chrome://tracing or
+ * https://ui.perfetto.dev.
+ *
+ * SyncEngine enables it when OWNCLOUD_SYNC_TRACE holds the path of the trace
+ * file. While disabled, recording costs a single atomic load.
+ *
+ * @ingroup libsync
+ */
+class OCSYNC_EXPORT SyncTrace
+{
+public:
+    enum Category {
+        Discovery,
+        Propagation,
+        Journal,
+        Network,
+    };
+
+    [[nodiscard]] static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+    /** Starts recording into the given file, an empty path stops recording */
+    static void setOutputFile(const QString &path);
+
+    /** Microseconds since recording started, pass it as startUsec to record() */
+    [[nodiscard]] static qint64 now();
+
+    /** Records an event that started at startUsec and ends now
+     *
+     * size, httpStatus and bytes are left out of the trace if negative or 0.
+     * Network requests pass the bytes sent as size and the bytes received as bytes.
+     */
+    static void record(Category category, const QString &name, const QString &path, qint64 startUsec,
+        qint64 size = -1, int httpStatus = 0, qint64 bytes = -1);
+
+    /** Writes the buffered events to the trace file and waits for it */
+    static void flush();
+
+    /** Records an event lasting from construction to destruction */
+    class Scope
+    {
+    public:
+        Scope(Category category, const QString &name, const QString &path)
+            : _category(category)
+            , _startUsec(isEnabled() ? now() : -1)
+            , _name(_startUsec >= 0 ? name : QString())
+            , _path(_startUsec >= 0 ? path : QString())
+        {
+        }
+        ~Scope()
+        {
+            if (_startUsec >= 0) {
+                record(_category, _name, _path, _startUsec);
+            }
+        }
+
+    private:
+        Category _category;
+        qint64 _startUsec;
+        // Only copied while recording
+        QString _name;
+        QString _path;
+    };
+
+private:
+    static std::atomic<bool> _enabled;
+};
+
+}
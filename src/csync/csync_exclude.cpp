@@ -37,6 +37,8 @@
 #include <QFileInfo>
 #include <QDir>
 
+#include <algorithm>
+
 /** Expands C-like escape sequences (in place)
  */
 OCSYNC_EXPORT void csync_exclude_expand_escapes(QByteArray &input)
@@ -321,30 +323,13 @@ bool ExcludedFiles::reloadExcludeFiles()
     _fullTraversalRegexDir.clear();
     _fullRegexFile.clear();
     _fullRegexDir.clear();
+    clearTraversalCaches();
 
     bool success = true;
     const auto keys = _excludeFiles.keys();
     for (const auto& basePath : keys) {
-        const auto itValue = _excludeFiles.find(basePath);
-        if (itValue == std::end(_excludeFiles)) {
-            continue;
-        }
-        auto &excludeFiles = *itValue;
-        for (auto excludeFileIt = std::begin(excludeFiles); excludeFileIt != std::end(excludeFiles); ) {
-            const auto &excludeFile = *excludeFileIt;
-            QFile file(excludeFile);
-            if (!file.exists()) {
-                excludeFileIt = excludeFiles.erase(excludeFileIt);
-                continue;
-            }
-
-            if (file.open(QIODevice::ReadOnly)) {
-                loadExcludeFilePatterns(basePath, file);
-            } else {
-                success = false;
-                qWarning() << "System exclude list file could not be opened:" << excludeFile;
-            }
-            ++excludeFileIt;
+        if (!loadExcludeFiles(basePath)) {
+            success = false;
         }
     }
 
@@ -357,6 +342,101 @@ bool ExcludedFiles::reloadExcludeFiles()
     return success;
 }
 
+bool ExcludedFiles::reloadBasePathExcludes(const BasePathString &basePath)
+{
+    _allExcludes.remove(basePath);
+    _bnameTraversalRegexFile.remove(basePath);
+    _bnameTraversalRegexDir.remove(basePath);
+    _fullTraversalRegexFile.remove(basePath);
+    _fullTraversalRegexDir.remove(basePath);
+    _fullRegexFile.remove(basePath);
+    _fullRegexDir.remove(basePath);
+    clearTraversalCaches();
+
+    const bool success = loadExcludeFiles(basePath);
+
+    const auto manualExcludes = _manualExcludes.value(basePath);
+    if (!manualExcludes.isEmpty()) {
+        _allExcludes[basePath].append(manualExcludes);
+        prepare(basePath);
+    }
+
+    return success;
+}
+
+bool ExcludedFiles::loadExcludeFiles(const BasePathString &basePath)
+{
+    const auto itValue = _excludeFiles.find(basePath);
+    if (itValue == std::end(_excludeFiles)) {
+        return true;
+    }
+
+    bool success = true;
+    auto &excludeFiles = *itValue;
+    for (auto excludeFileIt = std::begin(excludeFiles); excludeFileIt != std::end(excludeFiles); ) {
+        const auto &excludeFile = *excludeFileIt;
+        QFile file(excludeFile);
+        if (!file.exists()) {
+            _excludeFileModTimes.remove(excludeFile);
+            excludeFileIt = excludeFiles.erase(excludeFileIt);
+            continue;
+        }
+
+        if (file.open(QIODevice::ReadOnly)) {
+            _excludeFileModTimes.insert(excludeFile, QFileInfo(file).lastModified());
+            loadExcludeFilePatterns(basePath, file);
+        } else {
+            success = false;
+            qWarning() << "System exclude list file could not be opened:" << excludeFile;
+        }
+        ++excludeFileIt;
+    }
+    return success;
+}
+
+QStringList ExcludedFiles::basePathsForDirectory(const QString &directory)
+{
+    const auto it = _basePathsByDirectory.constFind(directory);
+    if (it != _basePathsByDirectory.cend()) {
+        return *it;
+    }
+
+    QStringList basePaths;
+    if (_allExcludes.contains(directory)) {
+        basePaths.append(directory);
+    }
+    if (directory.size() > _localPath.size()) {
+        basePaths.append(basePathsForDirectory(leftIncludeLast(directory, QLatin1Char('/'))));
+    }
+    _basePathsByDirectory.insert(directory, basePaths);
+    return basePaths;
+}
+
+std::shared_ptr<const ExcludedFiles::TraversalMatcher> ExcludedFiles::traversalMatcherForDirectory(const QString &directory)
+{
+    const auto basePaths = basePathsForDirectory(directory);
+    if (basePaths.isEmpty()) {
+        return nullptr;
+    }
+
+    // All directories below the same deepest base path share the matcher
+    auto &matcher = _traversalMatchers[basePaths.first()];
+    if (!matcher) {
+        PatternGroups groups;
+        for (const auto &basePath : basePaths) {
+            addPatterns(basePath, groups);
+        }
+        matcher = std::make_shared<const TraversalMatcher>(makeTraversalMatcher(groups));
+    }
+    return matcher;
+}
+
+void ExcludedFiles::clearTraversalCaches()
+{
+    _basePathsByDirectory.clear();
+    _traversalMatchers.clear();
+}
+
 bool ExcludedFiles::versionDirectiveKeepNextLine(const QByteArray &directive) const
 {
     if (!directive.startsWith("#!version"))
@@ -439,8 +519,13 @@ CSYNC_EXCLUDE_TYPE ExcludedFiles::traversalPatternMatch(const QString &path, Ite
         QFileInfo excludeFileInfo(absolutePath);
 
         if (excludeFileInfo.isReadable()) {
-            addExcludeFilePath(absolutePath);
-            reloadExcludeFiles();
+            // Only the patterns of this directory need to be (re)loaded, and only
+            // if the file is new or changed since it was last read
+            const auto modTime = _excludeFileModTimes.constFind(absolutePath);
+            if (modTime == _excludeFileModTimes.cend() || *modTime != excludeFileInfo.lastModified()) {
+                addExcludeFilePath(absolutePath);
+                reloadBasePathExcludes(basePath);
+            }
         } else {
 #if !defined QT_NO_DEBUG
             qWarning() << "System exclude list file could not be read:" << absolutePath;
@@ -455,51 +540,58 @@ CSYNC_EXCLUDE_TYPE ExcludedFiles::traversalPatternMatch(const QString &path, Ite
     if (lastSlash >= 0) {
         bnameStr = path.midRef(lastSlash + 1);
     }
+    const auto foldedBname = foldBnameCase(bnameStr.toString());
+
+    // The patterns of all base paths that apply to this path, merged.
+    // Shared by all entries of a directory.
+    const auto matcher = path.isEmpty()
+        ? nullptr
+        : traversalMatcherForDirectory(leftIncludeLast(_localPath + path, QLatin1Char('/')));
+    if (!matcher) {
+        return CSYNC_NOT_EXCLUDED;
+    }
 
-    QString basePath(_localPath + path);
-    while (basePath.size() > _localPath.size()) {
-        basePath = leftIncludeLast(basePath, QLatin1Char('/'));
-        QRegularExpressionMatch m;
-        if (filetype == ItemTypeDirectory
-            && _bnameTraversalRegexDir.contains(basePath)) {
-            m = _bnameTraversalRegexDir[basePath].match(bnameStr);
-        } else if (filetype == ItemTypeFile
-            && _bnameTraversalRegexFile.contains(basePath)) {
-            m = _bnameTraversalRegexFile[basePath].match(bnameStr);
+    const auto &bnameMatcher = filetype == ItemTypeDirectory ? matcher->bnameMatcherDir : matcher->bnameMatcherFile;
+
+    // Same precedence as in the regex: exclude, excluderemove, trigger
+    if (bnameMatcher.exclude.matches(foldedBname)) {
+        return CSYNC_FILE_EXCLUDE_LIST;
+    }
+    QRegularExpressionMatch m;
+    if (bnameMatcher.needsRegex) {
+        if (filetype == ItemTypeDirectory) {
+            m = matcher->bnameRegexDir.match(bnameStr);
         } else {
-            continue;
+            m = matcher->bnameRegexFile.match(bnameStr);
         }
+    }
+    if (m.hasMatch() && m.capturedStart(QStringLiteral("exclude")) != -1) {
+        return CSYNC_FILE_EXCLUDE_LIST;
+    }
+    if (bnameMatcher.excludeRemove.matches(foldedBname)) {
+        return CSYNC_FILE_EXCLUDE_AND_REMOVE;
+    }
 
-        if (!m.hasMatch())
-            return CSYNC_NOT_EXCLUDED;
-        if (m.capturedStart(QStringLiteral("exclude")) != -1) {
-            return CSYNC_FILE_EXCLUDE_LIST;
-        } else if (m.capturedStart(QStringLiteral("excluderemove")) != -1) {
-            return CSYNC_FILE_EXCLUDE_AND_REMOVE;
-        }
+    if (!m.hasMatch())
+        return CSYNC_NOT_EXCLUDED;
+    if (m.capturedStart(QStringLiteral("excluderemove")) != -1) {
+        return CSYNC_FILE_EXCLUDE_AND_REMOVE;
     }
 
     // third capture: full path matching is triggered
-    basePath = _localPath + path;
-    while (basePath.size() > _localPath.size()) {
-        basePath = leftIncludeLast(basePath, QLatin1Char('/'));
-        QRegularExpressionMatch m;
-        if (filetype == ItemTypeDirectory
-            && _fullTraversalRegexDir.contains(basePath)) {
-            m = _fullTraversalRegexDir[basePath].match(path);
-        } else if (filetype == ItemTypeFile
-            && _fullTraversalRegexFile.contains(basePath)) {
-            m = _fullTraversalRegexFile[basePath].match(path);
-        } else {
-            continue;
-        }
+    if (filetype == ItemTypeDirectory) {
+        m = matcher->fullRegexDir.match(path);
+    } else if (filetype == ItemTypeFile) {
+        m = matcher->fullRegexFile.match(path);
+    } else {
+        return CSYNC_NOT_EXCLUDED;
+    }
 
-        if (m.hasMatch()) {
-            if (m.capturedStart(QStringLiteral("exclude")) != -1) {
-                return CSYNC_FILE_EXCLUDE_LIST;
-            } else if (m.capturedStart(QStringLiteral("excluderemove")) != -1) {
-                return CSYNC_FILE_EXCLUDE_AND_REMOVE;
-            }
+    if (m.hasMatch()) {
+        if (m.capturedStart(QStringLiteral("exclude")) != -1) {
+            return CSYNC_FILE_EXCLUDE_LIST;
+        } else if (m.capturedStart(QStringLiteral("excluderemove")) != -1) {
+            return CSYNC_FILE_EXCLUDE_AND_REMOVE;
         }
     }
     return CSYNC_NOT_EXCLUDED;
@@ -676,6 +768,56 @@ QString ExcludedFiles::extractBnameTrigger(const QString &exclude, bool wildcard
     return pattern;
 }
 
+QString ExcludedFiles::foldBnameCase(const QString &bname)
+{
+    // Matches the CaseInsensitiveOption of the regexes
+    return OCC::Utility::fsCasePreserving() ? bname.toCaseFolded() : bname;
+}
+
+bool ExcludedFiles::SimpleBnameMatcher::add(const QString &pattern)
+{
+    auto isLiteral = [](QStringView str) {
+        return std::none_of(str.cbegin(), str.cend(), [](QChar c) {
+            return c == QLatin1Char('*') || c == QLatin1Char('?') || c == QLatin1Char('[') || c == QLatin1Char('\\');
+        });
+    };
+
+    if (isLiteral(pattern)) {
+        literals.insert(foldBnameCase(pattern));
+        return true;
+    }
+    const auto patternView = QStringView(pattern);
+    if (pattern.startsWith(QLatin1Char('*')) && isLiteral(patternView.mid(1))) {
+        const auto suffix = foldBnameCase(pattern.mid(1));
+        suffixes[suffix.size()].insert(suffix);
+        return true;
+    }
+    if (pattern.endsWith(QLatin1Char('*')) && isLiteral(patternView.chopped(1))) {
+        const auto prefix = foldBnameCase(pattern.chopped(1));
+        prefixes[prefix.size()].insert(prefix);
+        return true;
+    }
+    return false;
+}
+
+bool ExcludedFiles::SimpleBnameMatcher::matches(const QString &bname) const
+{
+    if (literals.contains(bname)) {
+        return true;
+    }
+    for (auto it = suffixes.cbegin(); it != suffixes.cend(); ++it) {
+        if (it.key() <= bname.size() && it->contains(bname.right(it.key()))) {
+            return true;
+        }
+    }
+    for (auto it = prefixes.cbegin(); it != prefixes.cend(); ++it) {
+        if (it.key() <= bname.size() && it->contains(bname.left(it.key()))) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void ExcludedFiles::prepare()
 {
     // clear all regex
@@ -685,6 +827,7 @@ void ExcludedFiles::prepare()
     _fullTraversalRegexDir.clear();
     _fullRegexFile.clear();
     _fullRegexDir.clear();
+    clearTraversalCaches();
 
     const auto keys = _allExcludes.keys();
     for (auto const & basePath : keys)
@@ -695,6 +838,52 @@ void ExcludedFiles::prepare(const BasePathString & basePath)
 {
     Q_ASSERT(_allExcludes.contains(basePath));
 
+    // basePath may be new, and the merged matchers of its subdirectories are outdated
+    clearTraversalCaches();
+
+    PatternGroups groups;
+    addPatterns(basePath, groups);
+    auto traversalMatcher = makeTraversalMatcher(groups);
+    _bnameTraversalRegexFile[basePath] = std::move(traversalMatcher.bnameRegexFile);
+    _bnameTraversalRegexDir[basePath] = std::move(traversalMatcher.bnameRegexDir);
+    _fullTraversalRegexFile[basePath] = std::move(traversalMatcher.fullRegexFile);
+    _fullTraversalRegexDir[basePath] = std::move(traversalMatcher.fullRegexDir);
+
+    // The full regex is applied to the full path and incorporates both bname and
+    // full-path patterns. It has the form "(exclude)|(excluderemove)".
+    _fullRegexFile[basePath].setPattern(
+        QStringLiteral("(?P<exclude>"
+                       // Full patterns are anchored to the beginning
+                       "^(?:%1)(?:$|/)|"
+                       // Simple bname patterns can be any path component
+                       "(?:^|/)(?:%2)(?:$|/)|"
+                       // When checking a file for exclusion we must check all parent paths
+                       // against the dir-only patterns as well.
+                       "(?:^|/)(?:%3)/)"
+                       "|"
+                       "(?P<excluderemove>"
+                       "^(?:%4)(?:$|/)|"
+                       "(?:^|/)(?:%5)(?:$|/)|"
+                       "(?:^|/)(?:%6)/)")
+            .arg(groups.fullFileDirKeep, groups.bnameFileDirKeep, groups.bnameDirKeep, groups.fullFileDirRemove, groups.bnameFileDirRemove, groups.bnameDirRemove));
+    _fullRegexDir[basePath].setPattern(
+        QStringLiteral("(?P<exclude>"
+                       "^(?:%1|%2)(?:$|/)|"
+                       "(?:^|/)(?:%3|%4)(?:$|/))"
+                       "|"
+                       "(?P<excluderemove>"
+                       "^(?:%5|%6)(?:$|/)|"
+                       "(?:^|/)(?:%7|%8)(?:$|/))")
+            .arg(groups.fullFileDirKeep, groups.fullDirKeep, groups.bnameFileDirKeep, groups.bnameDirKeep, groups.fullFileDirRemove, groups.fullDirRemove, groups.bnameFileDirRemove, groups.bnameDirRemove));
+
+    _fullRegexFile[basePath].setPatternOptions(patternOptions());
+    _fullRegexFile[basePath].optimize();
+    _fullRegexDir[basePath].setPatternOptions(patternOptions());
+    _fullRegexDir[basePath].optimize();
+}
+
+void ExcludedFiles::addPatterns(const BasePathString &basePath, PatternGroups &groups) const
+{
     // Build regular expressions for the different cases.
     //
     // To compose the _bnameTraversalRegex, _fullTraversalRegex and _fullRegex
@@ -715,19 +904,9 @@ void ExcludedFiles::prepare(const BasePathString & basePath)
     // * trailing-slash patterns match directories only. They get collected
     //   in the pattern strings saying "Dir", the others go into "FileDir"
     //   because they match files and directories.
-
-    QString fullFileDirKeep;
-    QString fullFileDirRemove;
-    QString fullDirKeep;
-    QString fullDirRemove;
-
-    QString bnameFileDirKeep;
-    QString bnameFileDirRemove;
-    QString bnameDirKeep;
-    QString bnameDirRemove;
-
-    QString bnameTriggerFileDir;
-    QString bnameTriggerDir;
+    //
+    // Full patterns are made relative to _localPath, so the groups of several
+    // base paths can be combined.
 
     auto regexAppend = [](QString &fileDirPattern, QString &dirPattern, const QString &appendMe, bool dirOnly) {
         QString &pattern = dirOnly ? dirPattern : fileDirPattern;
@@ -753,10 +932,10 @@ void ExcludedFiles::prepare(const BasePathString & basePath)
         bool fullPath = exclude.contains(QLatin1Char('/'));
 
         /* Use QRegularExpression, append to the right pattern */
-        auto &bnameFileDir = removeExcluded ? bnameFileDirRemove : bnameFileDirKeep;
-        auto &bnameDir = removeExcluded ? bnameDirRemove : bnameDirKeep;
-        auto &fullFileDir = removeExcluded ? fullFileDirRemove : fullFileDirKeep;
-        auto &fullDir = removeExcluded ? fullDirRemove : fullDirKeep;
+        auto &bnameFileDir = removeExcluded ? groups.bnameFileDirRemove : groups.bnameFileDirKeep;
+        auto &bnameDir = removeExcluded ? groups.bnameDirRemove : groups.bnameDirKeep;
+        auto &fullFileDir = removeExcluded ? groups.fullFileDirRemove : groups.fullFileDirKeep;
+        auto &fullDir = removeExcluded ? groups.fullDirRemove : groups.fullDirKeep;
 
         if (fullPath) {
             // The full pattern is matched against a path relative to _localPath, however exclude is
@@ -770,106 +949,106 @@ void ExcludedFiles::prepare(const BasePathString & basePath)
         auto regexExclude = convertToRegexpSyntax(exclude, _wildcardsMatchSlash);
         if (!fullPath) {
             regexAppend(bnameFileDir, bnameDir, regexExclude, matchDirOnly);
+
+            auto &simpleMatcherFile = removeExcluded ? groups.bnameTraversalMatcherFile.excludeRemove : groups.bnameTraversalMatcherFile.exclude;
+            auto &simpleMatcherDir = removeExcluded ? groups.bnameTraversalMatcherDir.excludeRemove : groups.bnameTraversalMatcherDir.exclude;
+            const bool isSimple = matchDirOnly
+                ? simpleMatcherDir.add(exclude)
+                : simpleMatcherFile.add(exclude) && simpleMatcherDir.add(exclude);
+            if (!isSimple) {
+                auto &complexBnameFileDir = removeExcluded ? groups.complexBnameFileDirRemove : groups.complexBnameFileDirKeep;
+                auto &complexBnameDir = removeExcluded ? groups.complexBnameDirRemove : groups.complexBnameDirKeep;
+                regexAppend(complexBnameFileDir, complexBnameDir, regexExclude, matchDirOnly);
+            }
         } else {
             regexAppend(fullFileDir, fullDir, regexExclude, matchDirOnly);
 
             // For activation, trigger on the 'bname' part of the full pattern.
             QString bnameExclude = extractBnameTrigger(exclude, _wildcardsMatchSlash);
             auto regexBname = convertToRegexpSyntax(bnameExclude, true);
-            regexAppend(bnameTriggerFileDir, bnameTriggerDir, regexBname, matchDirOnly);
+            regexAppend(groups.bnameTriggerFileDir, groups.bnameTriggerDir, regexBname, matchDirOnly);
         }
     }
+}
+
+ExcludedFiles::TraversalMatcher ExcludedFiles::makeTraversalMatcher(PatternGroups &groups)
+{
+    TraversalMatcher matcher;
+
+    groups.bnameTraversalMatcherFile.needsRegex = !groups.complexBnameFileDirKeep.isEmpty() || !groups.complexBnameFileDirRemove.isEmpty()
+        || !groups.bnameTriggerFileDir.isEmpty();
+    groups.bnameTraversalMatcherDir.needsRegex = groups.bnameTraversalMatcherFile.needsRegex || !groups.complexBnameDirKeep.isEmpty()
+        || !groups.complexBnameDirRemove.isEmpty() || !groups.bnameTriggerDir.isEmpty();
+    matcher.bnameMatcherFile = groups.bnameTraversalMatcherFile;
+    matcher.bnameMatcherDir = groups.bnameTraversalMatcherDir;
 
     // The empty pattern would match everything - change it to match-nothing
     auto emptyMatchNothing = [](QString &pattern) {
         if (pattern.isEmpty())
             pattern = QStringLiteral("a^");
     };
-    emptyMatchNothing(fullFileDirKeep);
-    emptyMatchNothing(fullFileDirRemove);
-    emptyMatchNothing(fullDirKeep);
-    emptyMatchNothing(fullDirRemove);
+    emptyMatchNothing(groups.fullFileDirKeep);
+    emptyMatchNothing(groups.fullFileDirRemove);
+    emptyMatchNothing(groups.fullDirKeep);
+    emptyMatchNothing(groups.fullDirRemove);
 
-    emptyMatchNothing(bnameFileDirKeep);
-    emptyMatchNothing(bnameFileDirRemove);
-    emptyMatchNothing(bnameDirKeep);
-    emptyMatchNothing(bnameDirRemove);
+    emptyMatchNothing(groups.bnameFileDirKeep);
+    emptyMatchNothing(groups.bnameFileDirRemove);
+    emptyMatchNothing(groups.bnameDirKeep);
+    emptyMatchNothing(groups.bnameDirRemove);
 
-    emptyMatchNothing(bnameTriggerFileDir);
-    emptyMatchNothing(bnameTriggerDir);
+    emptyMatchNothing(groups.bnameTriggerFileDir);
+    emptyMatchNothing(groups.bnameTriggerDir);
+
+    emptyMatchNothing(groups.complexBnameFileDirKeep);
+    emptyMatchNothing(groups.complexBnameFileDirRemove);
+    emptyMatchNothing(groups.complexBnameDirKeep);
+    emptyMatchNothing(groups.complexBnameDirRemove);
 
     // The bname regex is applied to the bname only, so it must be
     // anchored in the beginning and in the end. It has the structure:
     // (exclude)|(excluderemove)|(bname triggers).
     // If the third group matches, the fullActivatedRegex needs to be applied
-    // to the full path.
-    _bnameTraversalRegexFile[basePath].setPattern(
+    // to the full path. The simple patterns are left to the BnameTraversalMatcher.
+    matcher.bnameRegexFile.setPattern(
         QStringLiteral("^(?P<exclude>%1)$|"
                        "^(?P<excluderemove>%2)$|"
                        "^(?P<trigger>%3)$")
-            .arg(bnameFileDirKeep, bnameFileDirRemove, bnameTriggerFileDir));
-    _bnameTraversalRegexDir[basePath].setPattern(
+            .arg(groups.complexBnameFileDirKeep, groups.complexBnameFileDirRemove, groups.bnameTriggerFileDir));
+    matcher.bnameRegexDir.setPattern(
         QStringLiteral("^(?P<exclude>%1|%2)$|"
                        "^(?P<excluderemove>%3|%4)$|"
                        "^(?P<trigger>%5|%6)$")
-            .arg(bnameFileDirKeep, bnameDirKeep, bnameFileDirRemove, bnameDirRemove, bnameTriggerFileDir, bnameTriggerDir));
+            .arg(groups.complexBnameFileDirKeep, groups.complexBnameDirKeep, groups.complexBnameFileDirRemove, groups.complexBnameDirRemove, groups.bnameTriggerFileDir, groups.bnameTriggerDir));
 
     // The full traveral regex is applied to the full path if the trigger capture of
     // the bname regex matches. Its basic form is (exclude)|(excluderemove)".
     // This pattern can be much simpler than fullRegex since we can assume a traversal
     // situation and doesn't need to look for bname patterns in parent paths.
-    _fullTraversalRegexFile[basePath].setPattern(
+    matcher.fullRegexFile.setPattern(
         // Full patterns are anchored to the beginning
         QStringLiteral("^(?P<exclude>%1)(?:$|/)"
                        "|"
                        "^(?P<excluderemove>%2)(?:$|/)")
-            .arg(fullFileDirKeep, fullFileDirRemove));
-    _fullTraversalRegexDir[basePath].setPattern(
+            .arg(groups.fullFileDirKeep, groups.fullFileDirRemove));
+    matcher.fullRegexDir.setPattern(
         QStringLiteral("^(?P<exclude>%1|%2)(?:$|/)"
                        "|"
                        "^(?P<excluderemove>%3|%4)(?:$|/)")
-            .arg(fullFileDirKeep, fullDirKeep, fullFileDirRemove, fullDirRemove));
+            .arg(groups.fullFileDirKeep, groups.fullDirKeep, groups.fullFileDirRemove, groups.fullDirRemove));
 
-    // The full regex is applied to the full path and incorporates both bname and
-    // full-path patterns. It has the form "(exclude)|(excluderemove)".
-    _fullRegexFile[basePath].setPattern(
-        QStringLiteral("(?P<exclude>"
-                       // Full patterns are anchored to the beginning
-                       "^(?:%1)(?:$|/)|"
-                       // Simple bname patterns can be any path component
-                       "(?:^|/)(?:%2)(?:$|/)|"
-                       // When checking a file for exclusion we must check all parent paths
-                       // against the dir-only patterns as well.
-                       "(?:^|/)(?:%3)/)"
-                       "|"
-                       "(?P<excluderemove>"
-                       "^(?:%4)(?:$|/)|"
-                       "(?:^|/)(?:%5)(?:$|/)|"
-                       "(?:^|/)(?:%6)/)")
-            .arg(fullFileDirKeep, bnameFileDirKeep, bnameDirKeep, fullFileDirRemove, bnameFileDirRemove, bnameDirRemove));
-    _fullRegexDir[basePath].setPattern(
-        QStringLiteral("(?P<exclude>"
-                       "^(?:%1|%2)(?:$|/)|"
-                       "(?:^|/)(?:%3|%4)(?:$|/))"
-                       "|"
-                       "(?P<excluderemove>"
-                       "^(?:%5|%6)(?:$|/)|"
-                       "(?:^|/)(?:%7|%8)(?:$|/))")
-            .arg(fullFileDirKeep, fullDirKeep, bnameFileDirKeep, bnameDirKeep, fullFileDirRemove, fullDirRemove, bnameFileDirRemove, bnameDirRemove));
+    for (auto regex : { &matcher.bnameRegexFile, &matcher.bnameRegexDir, &matcher.fullRegexFile, &matcher.fullRegexDir }) {
+        regex->setPatternOptions(patternOptions());
+        regex->optimize();
+    }
 
+    return matcher;
+}
+
+QRegularExpression::PatternOptions ExcludedFiles::patternOptions()
+{
     QRegularExpression::PatternOptions patternOptions = QRegularExpression::NoPatternOption;
     if (OCC::Utility::fsCasePreserving())
         patternOptions |= QRegularExpression::CaseInsensitiveOption;
-    _bnameTraversalRegexFile[basePath].setPatternOptions(patternOptions);
-    _bnameTraversalRegexFile[basePath].optimize();
-    _bnameTraversalRegexDir[basePath].setPatternOptions(patternOptions);
-    _bnameTraversalRegexDir[basePath].optimize();
-    _fullTraversalRegexFile[basePath].setPatternOptions(patternOptions);
-    _fullTraversalRegexFile[basePath].optimize();
-    _fullTraversalRegexDir[basePath].setPatternOptions(patternOptions);
-    _fullTraversalRegexDir[basePath].optimize();
-    _fullRegexFile[basePath].setPatternOptions(patternOptions);
-    _fullRegexFile[basePath].optimize();
-    _fullRegexDir[basePath].setPatternOptions(patternOptions);
-    _fullRegexDir[basePath].optimize();
+    return patternOptions;
 }
@@ -25,12 +25,15 @@
 
 #include "csync.h"
 
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QSet>
 #include <QString>
 #include <QRegularExpression>
 
 #include <functional>
+#include <memory>
 
 enum CSYNC_EXCLUDE_TYPE {
   CSYNC_NOT_EXCLUDED   = 0,
@@ -226,12 +229,34 @@ private:
      * Note: The traversal matcher will return not-excluded on some paths that the
      * full matcher would exclude. Example: "b" is excluded. traversal("b/c")
      * returns not-excluded because "c" isn't a bname activation pattern.
+     *
+     * Most bname patterns are plain names ("Thumbs.db"), suffixes ("*.part") or
+     * prefixes (".nfs*"). Those don't go into _bnameTraversalRegex at all but
+     * into the hash sets of BnameTraversalMatcher, which are checked first.
+     *
+     * The traversal regexes of a single base path are kept for inspection. During
+     * traversal the patterns of a directory's base path and of all its ancestors
+     * are merged into one TraversalMatcher, see traversalMatcherForDirectory().
      */
     void prepare(const BasePathString &basePath);
 
     void prepare();
 
+    /// Reloads the exclude files and manual excludes of a single base path
+    bool reloadBasePathExcludes(const BasePathString &basePath);
+
+    /// Loads the exclude files of basePath into _allExcludes
+    bool loadExcludeFiles(const BasePathString &basePath);
+
+    /**
+     * Returns the base paths whose patterns apply to the entries of directory, deepest first.
+     *
+     * @param directory is absolute and ends with a /
+     */
+    QStringList basePathsForDirectory(const QString &directory);
+
     static QString extractBnameTrigger(const QString &exclude, bool wildcardsMatchSlash);
+    static QString foldBnameCase(const QString &bname);
     static QString convertToRegexpSyntax(QString exclude, bool wildcardsMatchSlash);
 
     QString _localPath;
@@ -239,6 +264,9 @@ private:
     /// Files to load excludes from
     QMap<BasePathString, QStringList> _excludeFiles;
 
+    /// Modification time of the exclude files when they were last loaded
+    QHash<QString, QDateTime> _excludeFileModTimes;
+
     /// Exclude patterns added with addManualExclude()
     QMap<BasePathString, QStringList> _manualExcludes;
 
@@ -253,6 +281,90 @@ private:
     QMap<BasePathString, QRegularExpression> _fullRegexFile;
     QMap<BasePathString, QRegularExpression> _fullRegexDir;
 
+    /// Matches bname patterns without wildcards, or with a single leading or trailing *
+    struct SimpleBnameMatcher
+    {
+        QSet<QString> literals;
+        /// keyed by the length of the suffixes/prefixes in the set
+        QHash<int, QSet<QString>> suffixes;
+        QHash<int, QSet<QString>> prefixes;
+
+        /// Returns false if the pattern needs a regex
+        bool add(const QString &pattern);
+        [[nodiscard]] bool matches(const QString &bname) const;
+    };
+
+    /// see prepare()
+    struct BnameTraversalMatcher
+    {
+        SimpleBnameMatcher exclude;
+        SimpleBnameMatcher excludeRemove;
+        /// Whether _bnameTraversalRegex has any pattern that can match
+        bool needsRegex = false;
+    };
+
+    /// The patterns of one or more base paths, grouped as described in prepare()
+    struct PatternGroups
+    {
+        QString fullFileDirKeep;
+        QString fullFileDirRemove;
+        QString fullDirKeep;
+        QString fullDirRemove;
+
+        QString bnameFileDirKeep;
+        QString bnameFileDirRemove;
+        QString bnameDirKeep;
+        QString bnameDirRemove;
+
+        QString bnameTriggerFileDir;
+        QString bnameTriggerDir;
+
+        /// The bname patterns that are too complex for the BnameTraversalMatcher
+        QString complexBnameFileDirKeep;
+        QString complexBnameFileDirRemove;
+        QString complexBnameDirKeep;
+        QString complexBnameDirRemove;
+
+        BnameTraversalMatcher bnameTraversalMatcherFile;
+        BnameTraversalMatcher bnameTraversalMatcherDir;
+    };
+
+    /// Everything traversalPatternMatch() needs for the entries of a directory
+    struct TraversalMatcher
+    {
+        BnameTraversalMatcher bnameMatcherFile;
+        BnameTraversalMatcher bnameMatcherDir;
+        QRegularExpression bnameRegexFile;
+        QRegularExpression bnameRegexDir;
+        QRegularExpression fullRegexFile;
+        QRegularExpression fullRegexDir;
+    };
+
+    /// Adds the patterns of basePath to groups
+    void addPatterns(const BasePathString &basePath, PatternGroups &groups) const;
+
+    /// Turns the collected groups into the traversal matchers, see prepare()
+    static TraversalMatcher makeTraversalMatcher(PatternGroups &groups);
+
+    static QRegularExpression::PatternOptions patternOptions();
+
+    /**
+     * Returns the merged matcher of the base paths that apply to the entries of directory,
+     * or null if there are none.
+     *
+     * @param directory is absolute and ends with a /
+     */
+    std::shared_ptr<const TraversalMatcher> traversalMatcherForDirectory(const QString &directory);
+
+    /// Drops the caches of basePathsForDirectory() and traversalMatcherForDirectory()
+    void clearTraversalCaches();
+
+    /// see basePathsForDirectory(), cleared whenever the set of base paths may change
+    QHash<QString, QStringList> _basePathsByDirectory;
+
+    /// see traversalMatcherForDirectory(), keyed by the deepest base path, cleared whenever patterns change
+    QHash<QString, std::shared_ptr<const TraversalMatcher>> _traversalMatchers;
+
     bool _excludeConflictFiles = true;
 
     /**
@@ -664,6 +664,8 @@ void Application::setupLogging()
     }
     logger->setLogExpire(_logExpire > 0 ? _logExpire : ConfigFile().logExpire());
     logger->setLogFlush(_logFlush || ConfigFile().logFlush());
+    logger->setLogMaxFileSize(qint64(ConfigFile().logMaxFileSize()) * 1024 * 1024);
+    logger->setLogMaxTotalSize(qint64(ConfigFile().logMaxTotalSize()) * 1024 * 1024);
     logger->setLogDebug(_logDebug || ConfigFile().logDebug());
     if (!logger->isLoggingToFile() && ConfigFile().automaticLogDir()) {
         logger->setupTemporaryFolderLogDir();
@@ -127,6 +127,9 @@ Folder::Folder(const FolderDefinition &definition,
         _localDiscoveryTracker.data(), &LocalDiscoveryTracker::slotItemCompleted);
 
     connect(_accountState->account().data(), &Account::capabilitiesChanged, this, &Folder::slotCapabilitiesChanged);
+    // Lock jobs write the lock state to the journal outside of a sync
+    connect(_accountState->account().data(), &Account::lockFileSuccess,
+        &_engine->syncFileStatusTracker(), &SyncFileStatusTracker::slotClearPathInfoCache);
 
     // Potentially upgrade suffix vfs to windows vfs
     ENFORCE(_vfs);
@@ -892,6 +895,26 @@ bool Folder::pathIsIgnored(const QString &path) const
     return false;
 }
 
+std::function<bool(const QString &)> Folder::pathIsIgnoredSnapshot() const
+{
+#ifndef OWNCLOUD_TEST
+    // ExcludedFiles isn't thread safe, the copy belongs to the returned function alone
+    auto excludedFiles = std::make_shared<ExcludedFiles>(path());
+    ConfigFile::setupDefaultExcludeFilePaths(*excludedFiles);
+    excludedFiles->reloadExcludeFiles();
+    excludedFiles->moveToThread(nullptr);
+
+    return [excludedFiles, folderPath = path(), ignoreHiddenFiles = _definition.ignoreHiddenFiles](const QString &path) {
+        return path.isEmpty()
+            || (excludedFiles->isExcluded(path, folderPath, ignoreHiddenFiles) && !Utility::isConflictFile(path));
+    };
+#else
+    return [](const QString &path) {
+        return path.isEmpty();
+    };
+#endif
+}
+
 void Folder::appendPathToSelectiveSyncList(const QString &path, const SyncJournalDb::SelectiveSyncListType listType)
 {
     const auto folderPath = Utility::trailingSlashPath(path);
@@ -1103,6 +1126,7 @@ SyncOptions Folder::initializeSyncOptions() const
     opt.setMaxChunkSize(cfgFile.maxChunkSize());
     opt._initialChunkSize = ::qBound(opt.minChunkSize(), cfgFile.chunkSize(), opt.maxChunkSize());
     opt._targetChunkUploadDuration = cfgFile.targetChunkUploadDuration();
+    opt._parallelChunkUploads = cfgFile.parallelChunkUploads();
 
     opt.fillFromEnvironmentVariables();
     opt.verifyChunkSizes();
@@ -28,6 +28,7 @@
 #include <QUuid>
 #include <set>
 #include <chrono>
+#include <functional>
 #include <memory>
 
 class QThread;
@@ -237,6 +238,12 @@ public:
     /* Check if the path is ignored. */
     [[nodiscard]] bool pathIsIgnored(const QString &path) const;
 
+    /**
+     * Like pathIsIgnored(), but with its own copy of the exclude patterns so that
+     * it may be called from any thread. Later changes of the exclude files are not seen.
+     */
+    [[nodiscard]] std::function<bool(const QString &)> pathIsIgnoredSnapshot() const;
+
     /**
       * Returns whether a file inside this folder should be excluded.
       */
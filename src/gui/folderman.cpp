@@ -1896,6 +1896,47 @@ void FolderMan::slotProcessFilesPushNotification(Account *account)
     }
 }
 
+void FolderMan::slotProcessFileIdsPushNotification(Account *account, const QVector<qint64> &fileIds)
+{
+    qCInfo(lcFolderMan) << "Got files push notification for account" << account << "with file ids" << fileIds;
+
+    // Only rediscover the directories of the changed files, in the folders that have them
+    auto unknownFileIds = QSet<qint64>(fileIds.cbegin(), fileIds.cend());
+    QHash<Folder *, QSet<QByteArray>> pathsToDiscover;
+    for (auto folder : qAsConst(_folderMap)) {
+        if (folder->accountState()->account() != account) {
+            continue;
+        }
+
+        for (const auto fileId : fileIds) {
+            if (!folder->journalDb()->getFileRecordsByNumericFileId(fileId, [&](const SyncJournalFileRecord &record) {
+                    unknownFileIds.remove(fileId);
+                    const auto path = record.isDirectory() ? record._path : record._path.left(qMax(0, record._path.lastIndexOf('/')));
+                    pathsToDiscover[folder].insert(path);
+                })) {
+                qCWarning(lcFolderMan) << "Could not look up file id" << fileId << "in" << folder;
+            }
+        }
+    }
+
+    // New files, or ones we don't sync: let the etags tell what changed
+    if (!unknownFileIds.isEmpty()) {
+        qCInfo(lcFolderMan) << "File ids" << unknownFileIds << "are unknown, schedule all folders";
+        slotProcessFilesPushNotification(account);
+        return;
+    }
+
+    for (auto it = pathsToDiscover.cbegin(); it != pathsToDiscover.cend(); ++it) {
+        const auto folder = it.key();
+        for (const auto &path : it.value()) {
+            folder->journalDb()->schedulePathForRemoteDiscovery(path);
+        }
+
+        qCInfo(lcFolderMan) << "Schedule folder" << folder << "for sync of" << it.value();
+        scheduleFolder(folder);
+    }
+}
+
 void FolderMan::slotConnectToPushNotifications(Account *account)
 {
     const auto pushNotifications = account->pushNotifications();
@@ -1903,6 +1944,7 @@ void FolderMan::slotConnectToPushNotifications(Account *account)
     if (pushNotificationsFilesReady(account)) {
         qCInfo(lcFolderMan) << "Push notifications ready";
         connect(pushNotifications, &PushNotifications::filesChanged, this, &FolderMan::slotProcessFilesPushNotification, Qt::UniqueConnection);
+        connect(pushNotifications, &PushNotifications::fileIdsChanged, this, &FolderMan::slotProcessFileIdsPushNotification, Qt::UniqueConnection);
     }
 }
 
@@ -324,6 +324,7 @@ private slots:
 
     void slotSetupPushNotifications(const OCC::Folder::Map &);
     void slotProcessFilesPushNotification(OCC::Account *account);
+    void slotProcessFileIdsPushNotification(OCC::Account *account, const QVector<qint64> &fileIds);
     void slotConnectToPushNotifications(OCC::Account *account);
 
 private:
@@ -100,6 +100,16 @@ bool FolderWatcher::pathIsIgnored(const QString &path) const
     return path.isEmpty();
 }
 
+std::function<bool(const QString &)> FolderWatcher::pathIsIgnoredSnapshot() const
+{
+    if (_folder) {
+        return _folder->pathIsIgnoredSnapshot();
+    }
+    return [](const QString &path) {
+        return path.isEmpty();
+    };
+}
+
 bool FolderWatcher::isReliable() const
 {
     return _isReliable;
@@ -29,6 +29,8 @@
 #include <QDir>
 #include <QTimer>
 
+#include <functional>
+
 namespace OCC {
 
 Q_DECLARE_LOGGING_CATEGORY(lcFolderWatcher)
@@ -153,6 +155,9 @@ private:
     /* Check if the path should be ignored by the FolderWatcher. */
     [[nodiscard]] bool pathIsIgnored(const QString &path) const;
 
+    /* Check if the path should be ignored, may be called from any thread, see Folder::pathIsIgnoredSnapshot() */
+    [[nodiscard]] std::function<bool(const QString &)> pathIsIgnoredSnapshot() const;
+
     /** Path of the expected test notification */
     QString _testNotificationPath;
 
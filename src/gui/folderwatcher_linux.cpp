@@ -15,22 +15,78 @@
 #include "config.h"
 
 #include <sys/inotify.h>
+#include <sys/fanotify.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "folder.h"
 #include "folderwatcher_linux.h"
 
+#include <array>
 #include <cerrno>
+#include <climits>
+#include <QFile>
 #include <QStringList>
 #include <QObject>
 #include <QVarLengthArray>
+#include <QtConcurrentRun>
+
+namespace {
+
+constexpr uint32_t inotifyWatchMask = IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_ONLYDIR;
+
+// Number of watches the registration worker collects before handing them over
+constexpr int registrationBatchSize = 1000;
+
+// Filter out journal changes - redundant with filtering in
+// FolderWatcher::pathIsIgnored.
+bool isJournalFile(const QByteArray &fileName)
+{
+    return fileName.startsWith("._sync_")
+        || fileName.startsWith(".csync_journal.db")
+        || fileName.startsWith(".sync_");
+}
+
+}
 
 namespace OCC {
 
+FanotifyDirectoryCache::FanotifyDirectoryCache(int maxSize)
+    : _maxSize(maxSize)
+{
+}
+
+QString FanotifyDirectoryCache::path(const QByteArray &fileHandle, const Resolver &resolve)
+{
+    const auto it = _paths.constFind(fileHandle);
+    if (it != _paths.cend()) {
+        return *it;
+    }
+
+    const auto path = resolve(fileHandle);
+    if (path.isEmpty()) {
+        return path;
+    }
+    // Renames within the folder clear the cache, but on a busy folder with
+    // only a few renames it shouldn't grow without bounds either
+    if (_paths.size() >= _maxSize) {
+        _paths.clear();
+    }
+    _paths.insert(fileHandle, path);
+    return path;
+}
+
 FolderWatcherPrivate::FolderWatcherPrivate(FolderWatcher *p, const QString &path)
     : QObject()
     , _parent(p)
     , _folder(path)
 {
+    if (qEnvironmentVariableIntValue("OWNCLOUD_FANOTIFY_WATCHER") && fanotifyInit(path)) {
+        _socket.reset(new QSocketNotifier(_fd, QSocketNotifier::Read));
+        connect(_socket.data(), &QSocketNotifier::activated, this, &FolderWatcherPrivate::slotReceivedFanotifyNotification);
+        return;
+    }
+
     _fd = inotify_init();
     if (_fd != -1) {
         _socket.reset(new QSocketNotifier(_fd, QSocketNotifier::Read));
@@ -39,10 +95,160 @@ FolderWatcherPrivate::FolderWatcherPrivate(FolderWatcher *p, const QString &path
         qCWarning(lcFolderWatcher) << "notify_init() failed: " << strerror(errno);
     }
 
-    QMetaObject::invokeMethod(this, "slotAddFolderRecursive", Q_ARG(QString, path));
+    if (_fd != -1) {
+        startInotifyRegistration(path);
+    }
+}
+
+void FolderWatcherPrivate::startInotifyRegistration(const QString &path)
+{
+    _ready = false;
+    _registrationTimer.start();
+    qCInfo(lcFolderWatcher) << "Registering watches for" << path;
+
+    const int fd = _fd;
+    // The exclude patterns of the folder must not be used from the worker
+    const auto pathIsIgnored = _parent->pathIsIgnoredSnapshot();
+    _registration = QtConcurrent::run([this, fd, path, pathIsIgnored] {
+        QVector<QPair<int, QString>> watches;
+        QStringList pendingDirectories = { QDir(path).absolutePath() };
+        bool exhausted = false;
+
+        while (!pendingDirectories.isEmpty() && !_abortRegistration.loadRelaxed()) {
+            const auto directory = pendingDirectories.takeLast();
+            const int wd = inotify_add_watch(fd, QFile::encodeName(directory).constData(), inotifyWatchMask);
+            if (wd > -1) {
+                watches.append({ wd, directory });
+            } else if (errno == ENOMEM || errno == ENOSPC) {
+                exhausted = true;
+                break;
+            }
+
+            const auto subdirectories = QDir(directory).entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks | QDir::Hidden);
+            for (const auto &subdirectory : subdirectories) {
+                const auto subdirectoryPath = directory + QLatin1Char('/') + subdirectory;
+                // Neither watch nor walk ignored directories
+                if (pathIsIgnored(subdirectoryPath)) {
+                    continue;
+                }
+                pendingDirectories.append(subdirectoryPath);
+            }
+
+            if (watches.size() >= registrationBatchSize) {
+                QMetaObject::invokeMethod(this, [this, watches] { addRegisteredWatches(watches, false, false); }, Qt::QueuedConnection);
+                watches.clear();
+            }
+        }
+
+        if (!_abortRegistration.loadRelaxed()) {
+            QMetaObject::invokeMethod(this, [this, watches, exhausted] { addRegisteredWatches(watches, true, exhausted); }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void FolderWatcherPrivate::addRegisteredWatches(const QVector<QPair<int, QString>> &watches, bool finished, bool exhausted)
+{
+    for (const auto &[wd, path] : watches) {
+        _watchToPath.insert(wd, path);
+        _pathToWatch.insert(path, wd);
+    }
+    if (exhausted) {
+        inotifyWatchesExhausted();
+    }
+
+    if (finished) {
+        _ready = true;
+        qCInfo(lcFolderWatcher) << "Registered" << _pathToWatch.size() << "watches for" << _folder << "in" << _registrationTimer.elapsed() << "ms";
+    } else {
+        qCInfo(lcFolderWatcher) << "Registered" << _pathToWatch.size() << "watches for" << _folder << "so far";
+    }
+}
+
+FolderWatcherPrivate::~FolderWatcherPrivate()
+{
+    _abortRegistration.storeRelaxed(1);
+    _registration.waitForFinished();
+
+    if (_fanotifyMountFd != -1) {
+        _socket.reset();
+        close(_fd);
+        close(_fanotifyMountFd);
+    }
+}
+
+bool FolderWatcherPrivate::fanotifyInit(const QString &path)
+{
+#ifdef FAN_REPORT_DFID_NAME
+    const int fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME, O_RDONLY | O_LARGEFILE);
+    if (fd == -1) {
+        qCInfo(lcFolderWatcher) << "fanotify is not available, using inotify:" << strerror(errno);
+        return false;
+    }
+
+    const auto encodedPath = QFile::encodeName(path);
+    const int mountFd = open(encodedPath.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    const uint64_t mask = FAN_CLOSE_WRITE | FAN_ATTRIB | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_CREATE | FAN_DELETE | FAN_ONDIR;
+    // Filesystem marks need CAP_SYS_ADMIN, but unlike mount marks they report directory entry changes
+    if (mountFd == -1 || fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, encodedPath.constData()) == -1) {
+        const int error = errno;
+        qCInfo(lcFolderWatcher) << "Could not add a fanotify mark for" << path << ", using inotify:" << strerror(error);
+        if (mountFd != -1) {
+            close(mountFd);
+        }
+        close(fd);
+        return false;
+    }
+
+    _fd = fd;
+    _fanotifyMountFd = mountFd;
+    _fanotifyCanonicalFolder = QDir(path).canonicalPath();
+    qCInfo(lcFolderWatcher) << "Watching" << path << "with fanotify";
+    return true;
+#else
+    Q_UNUSED(path);
+    return false;
+#endif
 }
 
-FolderWatcherPrivate::~FolderWatcherPrivate() = default;
+QString FolderWatcherPrivate::fanotifyDirectoryPath(const QByteArray &fileHandle)
+{
+    return _fanotifyDirectories.path(fileHandle, [this](const QByteArray &handle) {
+        return fanotifyResolveDirectory(handle);
+    });
+}
+
+QString FolderWatcherPrivate::fanotifyResolveDirectory(const QByteArray &fileHandle) const
+{
+#ifdef FAN_REPORT_DFID_NAME
+    // open_by_handle_at wants a mutable handle
+    auto handle = fileHandle;
+    const int dirFd = open_by_handle_at(_fanotifyMountFd, reinterpret_cast<struct file_handle *>(handle.data()), O_PATH | O_CLOEXEC);
+    if (dirFd == -1) {
+        // e.g. ESTALE if the directory is gone already
+        qCDebug(lcFolderWatcher) << "Could not open directory handle:" << strerror(errno);
+        return {};
+    }
+    std::array<char, PATH_MAX> target{};
+    const auto targetSize = readlink(QByteArray("/proc/self/fd/" + QByteArray::number(dirFd)).constData(), target.data(), target.size());
+    close(dirFd);
+
+    if (targetSize <= 0) {
+        return {};
+    }
+    const auto canonicalPath = QFile::decodeName(QByteArray(target.data(), static_cast<int>(targetSize)));
+    // Report the paths below the folder the way they were given to us, like inotify does
+    if (canonicalPath == _fanotifyCanonicalFolder) {
+        return QDir(_folder).absolutePath();
+    }
+    if (canonicalPath.startsWith(_fanotifyCanonicalFolder + QLatin1Char('/'))) {
+        return QDir(_folder).absolutePath() + canonicalPath.mid(_fanotifyCanonicalFolder.size());
+    }
+    return {};
+#else
+    Q_UNUSED(fileHandle);
+    return {};
+#endif
+}
 
 // attention: result list passed by reference!
 bool FolderWatcherPrivate::findFoldersBelow(const QDir &dir, QStringList &fullList)
@@ -74,20 +280,24 @@ void FolderWatcherPrivate::inotifyRegisterPath(const QString &path)
     if (path.isEmpty())
         return;
 
-    int wd = inotify_add_watch(_fd, path.toUtf8().constData(),
-        IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_ONLYDIR);
+    int wd = inotify_add_watch(_fd, path.toUtf8().constData(), inotifyWatchMask);
     if (wd > -1) {
         _watchToPath.insert(wd, path);
         _pathToWatch.insert(path, wd);
-    } else {
-        // If we're running out of memory or inotify watches, become
-        // unreliable.
-        if (_parent->_isReliable && (errno == ENOMEM || errno == ENOSPC)) {
-            _parent->_isReliable = false;
-            emit _parent->becameUnreliable(
-                tr("This problem usually happens when the inotify watches are exhausted. "
-                   "Check the FAQ for details."));
-        }
+    } else if (errno == ENOMEM || errno == ENOSPC) {
+        inotifyWatchesExhausted();
+    }
+}
+
+void FolderWatcherPrivate::inotifyWatchesExhausted()
+{
+    // If we're running out of memory or inotify watches, become
+    // unreliable.
+    if (_parent->_isReliable) {
+        _parent->_isReliable = false;
+        emit _parent->becameUnreliable(
+            tr("This problem usually happens when the inotify watches are exhausted. "
+               "Check the FAQ for details."));
     }
 }
 
@@ -169,18 +379,20 @@ void FolderWatcherPrivate::slotReceivedNotification(int fd)
         if (event->len == 0 || event->wd <= -1)
             continue;
         QByteArray fileName(event->name);
-        // Filter out journal changes - redundant with filtering in
-        // FolderWatcher::pathIsIgnored.
-        if (fileName.startsWith("._sync_")
-            || fileName.startsWith(".csync_journal.db")
-            || fileName.startsWith(".sync_")) {
+        if (isJournalFile(fileName)) {
+            continue;
+        }
+        const auto watchedPath = _watchToPath.constFind(event->wd);
+        if (watchedPath == _watchToPath.cend()) {
+            // The watch was added by the registration worker but not handed over yet,
+            // the sync after startup discovers these changes anyway
             continue;
         }
-        const QString p = _watchToPath[event->wd] + '/' + fileName;
+        const QString p = *watchedPath + '/' + fileName;
         _parent->changeDetected(p);
 
         if ((event->mask & (IN_MOVED_TO | IN_CREATE))
-            && QFileInfo(p).isDir()
+            && (event->mask & IN_ISDIR)
             && !_parent->pathIsIgnored(p)) {
             slotAddFolderRecursive(p);
         }
@@ -190,6 +402,54 @@ void FolderWatcherPrivate::slotReceivedNotification(int fd)
     }
 }
 
+void FolderWatcherPrivate::slotReceivedFanotifyNotification(int fd)
+{
+#ifdef FAN_REPORT_DFID_NAME
+    alignas(struct fanotify_event_metadata) std::array<char, 8192> buffer{};
+
+    // The fd is non-blocking, read until all pending events are consumed
+    ssize_t len = 0;
+    while ((len = read(fd, buffer.data(), buffer.size())) > 0) {
+        auto metadata = reinterpret_cast<const struct fanotify_event_metadata *>(buffer.data());
+        for (; FAN_EVENT_OK(metadata, len); metadata = FAN_EVENT_NEXT(metadata, len)) {
+            if (metadata->vers != FANOTIFY_METADATA_VERSION) {
+                qCWarning(lcFolderWatcher) << "Unexpected fanotify metadata version" << metadata->vers;
+                return;
+            }
+            if (metadata->mask & FAN_Q_OVERFLOW) {
+                qCWarning(lcFolderWatcher) << "fanotify event queue overflowed";
+                emit _parent->lostChanges();
+                continue;
+            }
+
+            const auto info = reinterpret_cast<const struct fanotify_event_info_fid *>(metadata + 1);
+            if (info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                continue;
+            }
+            const auto handle = reinterpret_cast<const struct file_handle *>(info->handle);
+            const auto fileName = QByteArray(reinterpret_cast<const char *>(handle->f_handle + handle->handle_bytes));
+            if (isJournalFile(fileName)) {
+                continue;
+            }
+
+            const auto directory = fanotifyDirectoryPath(QByteArray(reinterpret_cast<const char *>(handle), sizeof(struct file_handle) + handle->handle_bytes));
+
+            // The cached paths of the directories below a moved directory are stale
+            if ((metadata->mask & FAN_ONDIR) && (metadata->mask & (FAN_MOVED_FROM | FAN_DELETE))) {
+                _fanotifyDirectories.clear();
+            }
+
+            if (directory.isEmpty()) {
+                continue;
+            }
+            _parent->changeDetected(directory + '/' + QFile::decodeName(fileName));
+        }
+    }
+#else
+    Q_UNUSED(fd);
+#endif
+}
+
 void FolderWatcherPrivate::removeFoldersBelow(const QString &path)
 {
     auto it = _pathToWatch.find(path);
@@ -20,6 +20,12 @@
 #include <QSocketNotifier>
 #include <QHash>
 #include <QDir>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <functional>
 
 #include "folderwatcher.h"
 
@@ -27,8 +33,40 @@ class QTimer;
 
 namespace OCC {
 
+/**
+ * @brief Maps the struct file_handle of directories reported by fanotify to their paths
+ *
+ * Only directories inside the folder are cached. A directory outside of it
+ * may be moved into the folder later, so it is resolved again every time.
+ *
+ * @ingroup gui
+ */
+class FanotifyDirectoryCache
+{
+public:
+    /// Resolves a file handle to the directory path, empty if it is outside of the folder
+    using Resolver = std::function<QString(const QByteArray &fileHandle)>;
+
+    explicit FanotifyDirectoryCache(int maxSize = 10000);
+
+    /// Cached path of the directory, calls resolve() on a miss
+    QString path(const QByteArray &fileHandle, const Resolver &resolve);
+    /// Drops all entries, e.g. because a directory was moved and the paths below it are stale
+    void clear() { _paths.clear(); }
+    [[nodiscard]] int size() const { return _paths.size(); }
+
+private:
+    QHash<QByteArray, QString> _paths;
+    int _maxSize;
+};
+
 /**
  * @brief Linux (inotify) API implementation of FolderWatcher
+ *
+ * When OWNCLOUD_FANOTIFY_WATCHER is set and the process may use fanotify
+ * filesystem marks (CAP_SYS_ADMIN, Linux 5.9 or later), a single fanotify
+ * mark covers the whole folder instead of one inotify watch per directory.
+ *
  * @ingroup gui
  */
 class FolderWatcherPrivate : public QObject
@@ -41,17 +79,31 @@ public:
 
     [[nodiscard]] int testWatchCount() const { return _pathToWatch.size(); }
 
-    /// On linux the watcher is ready when the ctor finished.
+    /// With inotify the watcher is ready when the initial watches are registered.
     bool _ready = true;
 
 protected slots:
     void slotReceivedNotification(int fd);
+    void slotReceivedFanotifyNotification(int fd);
     void slotAddFolderRecursive(const QString &path);
 
 protected:
     bool findFoldersBelow(const QDir &dir, QStringList &fullList);
     void inotifyRegisterPath(const QString &path);
     void removeFoldersBelow(const QString &path);
+    void inotifyWatchesExhausted();
+
+    /// Walks the folder and registers its watches in a worker thread, see addRegisteredWatches()
+    void startInotifyRegistration(const QString &path);
+    /// Takes over a batch of watches registered by the worker, which skips ignored directories
+    void addRegisteredWatches(const QVector<QPair<int, QString>> &watches, bool finished, bool exhausted);
+
+    /// Sets up _fd with a fanotify mark for the filesystem of path, returns false if that isn't possible
+    bool fanotifyInit(const QString &path);
+    /// Path of the directory with the given struct file_handle, empty if it is outside of the folder
+    QString fanotifyDirectoryPath(const QByteArray &fileHandle);
+    /// Like fanotifyDirectoryPath(), without the cache
+    QString fanotifyResolveDirectory(const QByteArray &fileHandle) const;
 
 private:
     FolderWatcher *_parent = nullptr;
@@ -61,6 +113,16 @@ private:
     QMap<QString, int> _pathToWatch;
     QScopedPointer<QSocketNotifier> _socket;
     int _fd = 0;
+
+    /// The initial inotify registration, see startInotifyRegistration()
+    QFuture<void> _registration;
+    QAtomicInt _abortRegistration = 0;
+    QElapsedTimer _registrationTimer;
+
+    /// Only used with fanotify
+    int _fanotifyMountFd = -1;
+    QString _fanotifyCanonicalFolder;
+    FanotifyDirectoryCache _fanotifyDirectories;
 };
 }
 
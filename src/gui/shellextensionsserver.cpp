@@ -19,6 +19,7 @@
 #include <libsync/vfs/cfapi/shellext/configvfscfapishellext.h>
 #include "folder.h"
 #include "folderman.h"
+#include "syncengine.h"
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -206,6 +207,7 @@ void ShellExtensionsServer::processCustomStateRequest(QLocalSocket *socket, cons
             emit directoryListingIterationFinished(folderAlias);
             return;
         }
+        folder->syncEngine().syncFileStatusTracker().slotClearPathInfoCache();
     });
 
     QObject::connect(lsColJob, &LsColJob::finishedWithError, this, [this, folderAlias, lsColJobPath](QNetworkReply *reply) {
@@ -39,11 +39,13 @@
 #include "accountmanager.h"
 #include "capabilities.h"
 #include "common/asserts.h"
+#include "common/metrics.h"
 #include "guiutility.h"
 #ifndef OWNCLOUD_TEST
 #include "sharemanager.h"
 #endif
 
+#include <algorithm>
 #include <array>
 #include <QBitArray>
 #include <QUrl>
@@ -298,6 +300,11 @@ SocketApi::SocketApi(QObject *parent)
 
     // folder watcher
     connect(FolderMan::instance(), &FolderMan::folderSyncStateChange, this, &SocketApi::slotUpdateFolderView);
+
+    // STATUS pushes are sent at most every 100ms
+    _statusPushTimer.setSingleShot(true);
+    _statusPushTimer.setInterval(100);
+    connect(&_statusPushTimer, &QTimer::timeout, this, &SocketApi::flushStatusPushMessages);
 }
 
 SocketApi::~SocketApi()
@@ -496,6 +503,9 @@ void SocketApi::slotUpdateFolderView(Folder *f)
 
 void SocketApi::broadcastMessage(const QString &msg, bool doWait)
 {
+    // Keep the order: e.g. an UPDATE_VIEW must come after the statuses it refers to
+    flushStatusPushMessages();
+
     for (const auto &listener : qAsConst(_listeners)) {
         listener->sendMessage(msg, doWait);
     }
@@ -618,12 +628,44 @@ void SocketApi::processLeaveShareRequest(const QString &localFile, SocketListene
 
 void SocketApi::broadcastStatusPushMessage(const QString &systemPath, SyncFileStatus fileStatus)
 {
-    QString msg = buildMessage(QLatin1String("STATUS"), systemPath, fileStatus.toSocketAPIString());
     Q_ASSERT(!systemPath.endsWith('/'));
-    uint directoryHash = qHash(systemPath.left(systemPath.lastIndexOf('/')));
-    for (const auto &listener : qAsConst(_listeners)) {
-        listener->sendMessageIfDirectoryMonitored(msg, directoryHash);
+    if (_listeners.isEmpty()) {
+        return;
+    }
+
+    // During a sync the status of a file usually changes several times in a row,
+    // only its latest status is sent when the timer fires.
+    _pendingStatusPushes.insert(systemPath, { ++_statusPushSequence, fileStatus });
+    if (!_statusPushTimer.isActive()) {
+        _statusPushTimer.start();
+    }
+}
+
+void SocketApi::flushStatusPushMessages()
+{
+    _statusPushTimer.stop();
+    if (_pendingStatusPushes.isEmpty()) {
+        return;
+    }
+
+    // Send in the order of the last change, the tracker relies on children
+    // getting their new status before their parents.
+    QVector<QPair<quint64, QString>> paths;
+    paths.reserve(_pendingStatusPushes.size());
+    for (auto it = _pendingStatusPushes.cbegin(); it != _pendingStatusPushes.cend(); ++it) {
+        paths.append({ it->sequence, it.key() });
+    }
+    std::sort(paths.begin(), paths.end());
+
+    for (const auto &entry : qAsConst(paths)) {
+        const auto &systemPath = entry.second;
+        const auto msg = buildMessage(QLatin1String("STATUS"), systemPath, _pendingStatusPushes.value(systemPath).status.toSocketAPIString());
+        const auto directoryHash = qHash(systemPath.left(systemPath.lastIndexOf('/')));
+        for (const auto &listener : qAsConst(_listeners)) {
+            listener->sendMessageIfDirectoryMonitored(msg, directoryHash);
+        }
     }
+    _pendingStatusPushes.clear();
 }
 
 void SocketApi::command_RETRIEVE_FOLDER_STATUS(const QString &argument, SocketListener *listener)
@@ -642,7 +684,7 @@ void SocketApi::command_RETRIEVE_FILE_STATUS(const QString &argument, SocketList
         statusString = QLatin1String("NOP");
     } else {
         // The user probably visited this directory in the file shell.
-        // Let the listener know that it should now send status pushes for sibblings of this file.
+        // Let the listener know that it should now send status pushes for siblings of this file.
         QString directory = fileData.localPath.left(fileData.localPath.lastIndexOf('/'));
         listener->registerMonitoredDirectory(qHash(directory));
 
@@ -1118,6 +1160,51 @@ void SocketApi::command_V2_UPLOAD_FILES_FROM(const QSharedPointer<SocketApiJobV2
     uploadJob->start();
 }
 
+void SocketApi::command_V2_GET_METRICS(const QSharedPointer<SocketApiJobV2> &job) const
+{
+    job->success(Metrics::snapshot());
+}
+
+void SocketApi::command_V2_RETRIEVE_FILE_STATUSES(const QSharedPointer<SocketApiJobV2> &job)
+{
+    const auto paths = job->arguments()[QStringLiteral("paths")];
+    if (!paths.isArray()) {
+        job->failure(QStringLiteral("paths must be an array"));
+        return;
+    }
+
+    const auto pathsArray = paths.toArray();
+    QVector<QString> statusStrings(pathsArray.size(), QStringLiteral("NOP"));
+
+    // Each folder computes the statuses of its paths in one go
+    QHash<Folder *, QPair<QVector<int>, QStringList>> pathsByFolder;
+    for (int i = 0; i < pathsArray.size(); ++i) {
+        const auto fileData = FileData::get(pathsArray.at(i).toString());
+        if (!fileData.folder) {
+            continue;
+        }
+        // Like RETRIEVE_FILE_STATUS, the listener now wants status pushes for the siblings
+        const auto directory = fileData.localPath.left(fileData.localPath.lastIndexOf('/'));
+        job->listener()->registerMonitoredDirectory(qHash(directory));
+
+        auto &folderPaths = pathsByFolder[fileData.folder];
+        folderPaths.first.append(i);
+        folderPaths.second.append(fileData.folderRelativePath);
+    }
+    for (auto it = pathsByFolder.cbegin(); it != pathsByFolder.cend(); ++it) {
+        const auto statuses = it.key()->syncEngine().syncFileStatusTracker().fileStatuses(it.value().second);
+        for (int i = 0; i < statuses.size(); ++i) {
+            statusStrings[it.value().first.at(i)] = statuses.at(i).toSocketAPIString();
+        }
+    }
+
+    QJsonArray out;
+    for (int i = 0; i < pathsArray.size(); ++i) {
+        out << QJsonObject({ { "path", pathsArray.at(i).toString() }, { "status", statusStrings.at(i) } });
+    }
+    job->success({ { "statuses", out } });
+}
+
 void SocketApi::emailPrivateLink(const QString &link)
 {
     Utility::openEmailComposer(
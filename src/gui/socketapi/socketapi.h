@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <QLocalServer>
+#include <QTimer>
 
 class QUrl;
 class QLocalSocket;
@@ -109,6 +110,8 @@ private:
     };
 
     void broadcastMessage(const QString &msg, bool doWait = false);
+    // Sends the STATUS pushes collected by broadcastStatusPushMessage
+    void flushStatusPushMessages();
 
     // opens share dialog, sends reply
     void processShareRequest(const QString &localFile, SocketListener *listener);
@@ -155,6 +158,18 @@ private:
     Q_INVOKABLE void command_V2_LIST_ACCOUNTS(const QSharedPointer<OCC::SocketApiJobV2> &job) const;
     Q_INVOKABLE void command_V2_UPLOAD_FILES_FROM(const QSharedPointer<OCC::SocketApiJobV2> &job) const;
 
+    /** Replies with the status of all files in the "paths" array at once, e.g.
+     * V2/RETRIEVE_FILE_STATUSES:{"id":"1","arguments":{"paths":["/a","/b"]}}
+     * gets a {"statuses":[{"path":"/a","status":"OK"},...]} result. The status
+     * strings are the same as in the STATUS messages of RETRIEVE_FILE_STATUS.
+     */
+    Q_INVOKABLE void command_V2_RETRIEVE_FILE_STATUSES(const QSharedPointer<OCC::SocketApiJobV2> &job);
+
+    /** Replies with Metrics::snapshot(), e.g. V2/GET_METRICS:{"id":"1","arguments":{}}
+     * gets a {"enabled":true,"elapsedMsec":...,"counters":{...},"gauges":{...},"histograms":{...}} result.
+     */
+    Q_INVOKABLE void command_V2_GET_METRICS(const QSharedPointer<OCC::SocketApiJobV2> &job) const;
+
     // Fetch the private link and call targetFun
     void fetchPrivateLinkUrlHelper(const QString &localFile, const std::function<void(const QString &url)> &targetFun);
 
@@ -208,6 +223,16 @@ private:
     QSet<QString> _registeredAliases;
     QMap<QIODevice *, QSharedPointer<SocketListener>> _listeners;
     QLocalServer _localServer;
+
+    // Latest status per path, sent in batches so a large sync doesn't flood the shell extensions
+    struct PendingStatusPush
+    {
+        quint64 sequence;
+        SyncFileStatus status;
+    };
+    QHash<QString, PendingStatusPush> _pendingStatusPushes;
+    quint64 _statusPushSequence = 0;
+    QTimer _statusPushTimer;
 };
 }
 
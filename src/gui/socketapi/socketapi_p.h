@@ -149,6 +149,7 @@ public:
 
     [[nodiscard]] const QJsonObject &arguments() const { return _arguments; }
     [[nodiscard]] QByteArray command() const { return _command; }
+    [[nodiscard]] SocketListener *listener() const { return _socketListener.data(); }
 
 Q_SIGNALS:
     void finished() const;
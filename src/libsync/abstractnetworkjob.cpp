@@ -31,6 +31,7 @@
 #include <QRegularExpression>
 
 #include "common/asserts.h"
+#include "common/synctrace.h"
 #include "networkjobs.h"
 #include "account.h"
 #include "owncloudpropagator.h"
@@ -161,6 +162,18 @@ void AbstractNetworkJob::adoptRequest(QNetworkReply *reply)
     addTimer(reply);
     setReply(reply);
     setupConnections(reply);
+    if (SyncTrace::isEnabled()) {
+        _traceStartUsec = SyncTrace::now();
+        _traceBytesSent = 0;
+        _traceBytesReceived = 0;
+        // The bytes that actually went over the wire, Content-Length is missing for chunked replies
+        connect(reply, &QNetworkReply::uploadProgress, this, [this](qint64 bytesSent, qint64) {
+            _traceBytesSent = bytesSent;
+        });
+        connect(reply, &QNetworkReply::downloadProgress, this, [this](qint64 bytesReceived, qint64) {
+            _traceBytesReceived = bytesReceived;
+        });
+    }
     newReplyHook(reply);
 }
 
@@ -178,6 +191,16 @@ void AbstractNetworkJob::slotFinished()
 {
     _timer.stop();
 
+    if (_traceStartUsec >= 0) {
+        SyncTrace::record(SyncTrace::Network,
+            QString::fromLatin1(HttpLogger::requestVerb(*_reply) + ' ' + metaObject()->className()),
+            path(), _traceStartUsec,
+            _traceBytesSent,
+            _reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(),
+            _traceBytesReceived);
+        _traceStartUsec = -1;
+    }
+
     if (_reply->error() == QNetworkReply::SslHandshakeFailedError) {
         qCWarning(lcNetworkJob) << "SslHandshakeFailedError: " << errorString() << " : can be caused by a webserver wanting SSL client certificates";
     }
@@ -214,6 +214,9 @@ private:
     QTimer _timer;
     int _redirectCount = 0;
     int _http2ResendCount = 0;
+    qint64 _traceStartUsec = -1; // see SyncTrace
+    qint64 _traceBytesSent = 0;
+    qint64 _traceBytesReceived = 0;
 
     // Set by the xyzRequest() functions and needed to be able to redirect
     // requests, should it be required.
@@ -16,6 +16,7 @@
 #include "propagatedownload.h"
 #include "propagateupload.h"
 #include "propagatorjobs.h"
+#include "common/metrics.h"
 #include "common/utility.h"
 
 #ifdef Q_OS_WIN
@@ -27,6 +28,10 @@
 #include <QTimer>
 #include <QObject>
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 namespace OCC {
 
 Q_LOGGING_CATEGORY(lcBandwidthManager, "nextcloud.sync.bandwidthmanager", QtInfoMsg)
@@ -37,6 +42,14 @@ Q_LOGGING_CATEGORY(lcBandwidthManager, "nextcloud.sync.bandwidthmanager", QtInfo
 static qint64 relativeLimitMeasuringTimerIntervalMsec = 1000 * 2;
 // See also WritingState in http://code.woboq.org/qt5/qtbase/src/network/access/qhttpprotocolhandler.cpp.html#_ZN20QHttpProtocolHandler11sendRequestEv
 
+// Absolute limits hand out quota in small slices so parallel transfers flow evenly
+// instead of all bursting once per second.
+static constexpr qint64 absoluteLimitTimerIntervalMsec = 250;
+
+// A transfer that left more than this fraction of its quota unused is not limited
+// by the bandwidth manager: it only gets about as much as it used, plus some headroom.
+static constexpr qint64 absoluteLimitUnusedFraction = 4;
+
 // FIXME At some point:
 //  * Register device only after the QNR received its metaDataChanged() signal
 //  * Incorporate Qt buffer fill state (it's a negative absolute delta).
@@ -58,7 +71,7 @@ BandwidthManager::BandwidthManager(OwncloudPropagator *p)
 
     // absolute uploads/downloads
     QObject::connect(&_absoluteLimitTimer, &QTimer::timeout, this, &BandwidthManager::absoluteLimitTimerExpired);
-    _absoluteLimitTimer.setInterval(1000);
+    _absoluteLimitTimer.setInterval(absoluteLimitTimerIntervalMsec);
     _absoluteLimitTimer.start();
 
     // Relative uploads
@@ -107,6 +120,7 @@ void BandwidthManager::unregisterUploadDevice(QObject *o)
     auto p = reinterpret_cast<UploadDevice *>(o); // note, we might already be in the ~QObject
     _absoluteUploadDeviceList.remove(p);
     _relativeUploadDeviceList.remove(p);
+    _absoluteQuotaGiven.remove(o);
     if (p == _relativeLimitCurrentMeasuredDevice) {
         _relativeLimitCurrentMeasuredDevice = nullptr;
         _relativeUploadLimitProgressAtMeasuringRestart = 0;
@@ -134,6 +148,7 @@ void BandwidthManager::unregisterDownloadJob(QObject *o)
 {
     auto *j = reinterpret_cast<GETFileJob *>(o); // note, we might already be in the ~QObject
     _downloadJobList.remove(j);
+    _absoluteQuotaGiven.remove(o);
     if (_relativeLimitCurrentMeasuredJob == j) {
         _relativeLimitCurrentMeasuredJob = nullptr;
         _relativeDownloadLimitProgressAtMeasuringRestart = 0;
@@ -228,6 +243,8 @@ void BandwidthManager::relativeUploadDelayTimerExpired()
     _relativeLimitCurrentMeasuredDevice->setChoked(false);
 
     // choke all other UploadDevices
+    static auto &chokedMsec = Metrics::counter("bandwidth.upload.chokedMsec");
+    chokedMsec.add(qint64(_relativeUploadDeviceList.size() - 1) * relativeLimitMeasuringTimerIntervalMsec);
     for (const auto uploadDevice : _relativeUploadDeviceList) {
         if (uploadDevice == _relativeLimitCurrentMeasuredDevice) {
             continue;
@@ -327,6 +344,8 @@ void BandwidthManager::relativeDownloadDelayTimerExpired()
     _relativeLimitCurrentMeasuredJob->setChoked(false);
 
     // choke all other download jobs
+    static auto &chokedMsec = Metrics::counter("bandwidth.download.chokedMsec");
+    chokedMsec.add(qint64(_downloadJobList.size() - 1) * relativeLimitMeasuringTimerIntervalMsec);
     for (const auto getFileJob : _downloadJobList) {
         if (getFileJob == _relativeLimitCurrentMeasuredJob) {
             continue;
@@ -386,27 +405,89 @@ void BandwidthManager::switchingTimerExpired()
     }
 }
 
+QVector<qint64> BandwidthManager::fairShares(const QVector<qint64> &demands, qint64 budget)
+{
+    QVector<int> order(demands.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&demands](int a, int b) {
+        return demands.at(a) < demands.at(b);
+    });
+
+    QVector<qint64> shares(demands.size(), 0);
+    auto remaining = qMax(budget, qint64(0));
+    auto transfersLeft = demands.size();
+    for (const auto index : order) {
+        // Round up so that a tiny budget still moves something
+        const auto equalShare = (remaining + transfersLeft - 1) / transfersLeft;
+        const auto share = qMin(qMax(demands.at(index), qint64(0)), equalShare);
+        shares[index] = share;
+        remaining -= share;
+        --transfersLeft;
+    }
+    return shares;
+}
+
+qint64 BandwidthManager::absoluteDemand(const QObject *transfer, qint64 quotaLeft) const
+{
+    const auto given = _absoluteQuotaGiven.value(transfer, 0);
+    if (given <= 0 || quotaLeft * absoluteLimitUnusedFraction < given) {
+        // New, or used most of its quota: it could use more
+        return std::numeric_limits<qint64>::max();
+    }
+    const auto used = given - quotaLeft;
+    return qMax(used * 2, given / absoluteLimitUnusedFraction);
+}
+
 void BandwidthManager::absoluteLimitTimerExpired()
 {
     if (usingAbsoluteUploadLimit() && !_absoluteUploadDeviceList.empty()) {
-        const auto quotaPerDevice = _currentUploadLimit / qMax((std::list<UploadDevice *>::size_type)1, _absoluteUploadDeviceList.size());
+        const auto budget = _currentUploadLimit * absoluteLimitTimerIntervalMsec / 1000;
+
+        // Transfers that used up their quota had to wait for this refill
+        static auto &exhausted = Metrics::counter("bandwidth.upload.quotaExhausted");
+        QVector<qint64> demands;
+        demands.reserve(static_cast<int>(_absoluteUploadDeviceList.size()));
+        for (const auto device : _absoluteUploadDeviceList) {
+            demands.append(absoluteDemand(device, device->bandwidthQuota()));
+            if (device->bandwidthQuota() <= 0) {
+                exhausted.add();
+            }
+        }
+        const auto shares = fairShares(demands, budget);
 
-        qCDebug(lcBandwidthManager) << quotaPerDevice << _absoluteUploadDeviceList.size() << _currentUploadLimit;
+        qCDebug(lcBandwidthManager) << budget << _absoluteUploadDeviceList.size() << _currentUploadLimit;
 
+        auto share = shares.cbegin();
         for (const auto device : _absoluteUploadDeviceList) {
-            device->giveBandwidthQuota(quotaPerDevice);
-            qCDebug(lcBandwidthManager) << "Gave " << quotaPerDevice / 1024.0 << " kB to" << device;
+            _absoluteQuotaGiven.insert(device, *share);
+            device->giveBandwidthQuota(*share);
+            qCDebug(lcBandwidthManager) << "Gave " << *share / 1024.0 << " kB to" << device;
+            ++share;
         }
     }
 
     if (usingAbsoluteDownloadLimit() && !_downloadJobList.empty()) {
-        const auto quotaPerJob = _currentDownloadLimit / qMax((std::list<GETFileJob *>::size_type)1, _downloadJobList.size());
+        const auto budget = _currentDownloadLimit * absoluteLimitTimerIntervalMsec / 1000;
+
+        static auto &exhausted = Metrics::counter("bandwidth.download.quotaExhausted");
+        QVector<qint64> demands;
+        demands.reserve(static_cast<int>(_downloadJobList.size()));
+        for (const auto job : _downloadJobList) {
+            demands.append(absoluteDemand(job, job->bandwidthQuota()));
+            if (job->bandwidthQuota() <= 0) {
+                exhausted.add();
+            }
+        }
+        const auto shares = fairShares(demands, budget);
 
-        qCDebug(lcBandwidthManager) << quotaPerJob << _downloadJobList.size() << _currentDownloadLimit;
+        qCDebug(lcBandwidthManager) << budget << _downloadJobList.size() << _currentDownloadLimit;
 
+        auto share = shares.cbegin();
         for (const auto job : _downloadJobList) {
-            job->giveBandwidthQuota(quotaPerJob);
-            qCDebug(lcBandwidthManager) << "Gave " << quotaPerJob / 1024.0 << " kB to" << job;
+            _absoluteQuotaGiven.insert(job, *share);
+            job->giveBandwidthQuota(*share);
+            qCDebug(lcBandwidthManager) << "Gave " << *share / 1024.0 << " kB to" << job;
+            ++share;
         }
     }
 }
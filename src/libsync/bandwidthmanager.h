@@ -15,9 +15,13 @@
 #ifndef BANDWIDTHMANAGER_H
 #define BANDWIDTHMANAGER_H
 
+#include "owncloudlib.h"
+
 #include <QObject>
 #include <QTimer>
 #include <QIODevice>
+#include <QHash>
+#include <QVector>
 #include <list>
 
 namespace OCC {
@@ -28,15 +32,31 @@ class OwncloudPropagator;
 
 /**
  * @brief The BandwidthManager class
+ *
+ * With an absolute limit, every absoluteLimitTimerExpired() hands out the
+ * budget for one interval, shared by all registered transfers: a transfer
+ * that left most of its last quota unused only gets about what it used, the
+ * rest is split evenly between the transfers that can use more. The quota
+ * given replaces any leftover, so the transfers together never use more
+ * than the limit, however many run in parallel.
+ *
  * @ingroup libsync
  */
-class BandwidthManager : public QObject
+class OWNCLOUDSYNC_EXPORT BandwidthManager : public QObject
 {
     Q_OBJECT
 public:
     BandwidthManager(OwncloudPropagator *p);
     ~BandwidthManager() override;
 
+    /** Splits budget between transfers wanting demands (max-min fairness)
+     *
+     * Transfers wanting less than an equal share get what they want, what
+     * they leave is split evenly between the others. The shares add up to
+     * at most budget.
+     */
+    static QVector<qint64> fairShares(const QVector<qint64> &demands, qint64 budget);
+
     bool usingAbsoluteUploadLimit() { return _currentUploadLimit > 0; }
     bool usingRelativeUploadLimit() { return _currentUploadLimit < 0; }
     bool usingAbsoluteDownloadLimit() { return _currentDownloadLimit > 0; }
@@ -60,6 +80,9 @@ public slots:
     void relativeDownloadDelayTimerExpired();
 
 private:
+    // Demand of a transfer for the next absolute quota, from how much of the last one it used
+    qint64 absoluteDemand(const QObject *transfer, qint64 quotaLeft) const;
+
     // for switching between absolute and relative bw limiting
     QTimer _switchingTimer;
 
@@ -70,6 +93,9 @@ private:
     // for absolute up/down bw limiting
     QTimer _absoluteLimitTimer;
 
+    // The absolute quota given to each transfer on the last timer expiry
+    QHash<const QObject *, qint64> _absoluteQuotaGiven;
+
     // FIXME merge these two lists
     std::list<UploadDevice *> _absoluteUploadDeviceList;
     std::list<UploadDevice *> _relativeUploadDeviceList;
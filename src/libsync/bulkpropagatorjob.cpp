@@ -33,6 +33,8 @@
 #include <QJsonObject>
 #include <QJsonValue>
 
+#include <numeric>
+
 namespace {
 
 QByteArray getEtagFromJsonReply(const QJsonObject &reply)
@@ -58,8 +60,9 @@ QByteArray getHeaderFromJsonReply(const QJsonObject &reply, const QByteArray &he
     return reply.value(headerName).toString().toLatin1();
 }
 
-constexpr auto batchSize = 100;
-constexpr auto parallelJobsMaximumCount = 1;
+// Long enough to amortize the latency of the request, short enough to not lose
+// much on a failed request
+constexpr auto targetBatchUploadDuration = std::chrono::seconds(10);
 
 }
 
@@ -71,22 +74,27 @@ BulkPropagatorJob::BulkPropagatorJob(OwncloudPropagator *propagator, const std::
     : PropagatorJob(propagator)
     , _items(items)
 {
-    _filesToUpload.reserve(batchSize);
-    _pendingChecksumFiles.reserve(batchSize);
+    _batchLimits._bytes = propagator->_chunkSize;
+    _filesToUpload.reserve(_batchLimits._files);
+    _pendingChecksumFiles.reserve(_batchLimits._files);
 }
 
 bool BulkPropagatorJob::scheduleSelfOrChild()
 {
-    if (_items.empty() || !_pendingChecksumFiles.empty()) {
+    // Only one batch is prepared at a time, it waits if all batches in flight are busy
+    if (_items.empty() || !_pendingChecksumFiles.empty() || !_filesToUpload.empty()
+        || _jobs.size() > _batchLimits._parallelBatches) {
         return false;
     }
 
     _state = Running;
 
-    for(auto i = 0; i < batchSize && !_items.empty(); ++i) {
+    auto batchBytes = 0LL;
+    for(auto i = 0; i < _batchLimits._files && !_items.empty() && (i == 0 || batchBytes < _batchLimits._bytes); ++i) {
         const auto currentItem = _items.front();
         _items.pop_front();
         _pendingChecksumFiles.insert(currentItem->_file);
+        batchBytes += currentItem->_size;
 
         QMetaObject::invokeMethod(this, [this, currentItem] {
             UploadFileInfo fileToUpload;
@@ -197,6 +205,11 @@ void BulkPropagatorJob::doStartUpload(SyncFileItemPtr item,
 
 void BulkPropagatorJob::triggerUpload()
 {
+    if (_jobs.size() >= _batchLimits._parallelBatches) {
+        // Started from checkPropagationIsDone() once a batch in flight finished
+        return;
+    }
+
     auto uploadParametersData = std::vector<SingleUploadFileData>{};
     uploadParametersData.reserve(_filesToUpload.size());
 
@@ -240,17 +253,56 @@ void BulkPropagatorJob::triggerUpload()
 
     adjustLastJobTimeout(job, timeout);
     _jobs.append(job);
+    _filesInFlight.insert(job, std::move(_filesToUpload));
+    _filesToUpload.clear();
     job->start();
 
-    if (parallelism() == PropagatorJob::JobParallelism::FullParallelism && _jobs.size() < parallelJobsMaximumCount) {
-        scheduleSelfOrChild();
+    // Prepare the next batch while this one is in flight
+    scheduleSelfOrChild();
+}
+
+void BulkUploadBatchLimits::adapt(const int batchFiles, const qint64 batchBytes, std::chrono::milliseconds uploadTime,
+                                  const SyncOptions &syncOptions, const int maxParallelBatches)
+{
+    // Whether the batch reached the limits it was made with, not whether the adapted limits are at their bounds
+    const auto isFullBatch = batchFiles >= _files || batchBytes >= _bytes;
+
+    // Same heuristic as the dynamic chunk sizing of PropagateUploadFileNG: predict the batch
+    // that would take the target duration and only go half way there
+    ++uploadTime; // add one to avoid div-by-zero
+    const qint64 predictedGoodFiles = (batchFiles * targetBatchUploadDuration) / uploadTime;
+    const qint64 predictedGoodBytes = (batchBytes * targetBatchUploadDuration) / uploadTime;
+
+    _files = static_cast<int>(qBound(qint64(minFiles), _files / 2 + predictedGoodFiles / 2, qint64(maxFiles)));
+    _bytes = qBound(syncOptions.minChunkSize(), _bytes / 2 + predictedGoodBytes / 2, syncOptions.maxChunkSize());
+
+    // A full batch that is still much faster than the target is bound by the latency
+    // of the requests, not by the bandwidth: overlap more of them.
+    if (isFullBatch && uploadTime < targetBatchUploadDuration / 2) {
+        _parallelBatches = qMin(_parallelBatches + 1, maxParallelBatches);
+    } else if (uploadTime > targetBatchUploadDuration) {
+        _parallelBatches = qMax(_parallelBatches - 1, 1);
     }
 }
 
+void BulkPropagatorJob::adjustBatchSize(const PutMultiFileJob *job, const int batchFiles, const qint64 batchBytes)
+{
+    const auto uploadTime = job->msSinceStart();
+    _batchLimits.adapt(batchFiles, batchBytes, uploadTime, propagator()->syncOptions(), propagator()->maximumActiveTransferJob());
+
+    qCInfo(lcBulkPropagatorJob) << "Bulk upload of" << batchFiles << "files with" << batchBytes << "bytes took" << uploadTime.count()
+                                << "ms, next batches have up to" << _batchLimits._files << "files and" << _batchLimits._bytes
+                                << "bytes," << _batchLimits._parallelBatches << "in parallel";
+}
+
 void BulkPropagatorJob::checkPropagationIsDone()
 {
+    if (_pendingChecksumFiles.empty() && !_filesToUpload.empty()) {
+        triggerUpload();
+    }
+
     if (_items.empty()) {
-        if (!_jobs.empty() || !_pendingChecksumFiles.empty()) {
+        if (!_jobs.empty() || !_pendingChecksumFiles.empty() || !_filesToUpload.empty()) {
             // just wait for the other job to finish.
             return;
         }
@@ -418,6 +470,7 @@ void BulkPropagatorJob::slotPutFinished()
     Q_ASSERT(job);
 
     slotJobDestroyed(job); // remove it from the _jobs list
+    auto batchFiles = _filesInFlight.take(job);
 
     const auto jobError = job->reply()->error();
 
@@ -425,7 +478,14 @@ void BulkPropagatorJob::slotPutFinished()
     const auto replyJson = QJsonDocument::fromJson(replyData);
     const auto fullReplyObject = replyJson.object();
 
-    for (const auto &singleFile : _filesToUpload) {
+    if (jobError == QNetworkReply::NoError) {
+        const auto batchBytes = std::accumulate(batchFiles.cbegin(), batchFiles.cend(), 0LL, [](qint64 bytes, const BulkUploadItem &singleFile) {
+            return bytes + singleFile._fileSize;
+        });
+        adjustBatchSize(job, static_cast<int>(batchFiles.size()), batchBytes);
+    }
+
+    for (const auto &singleFile : batchFiles) {
         if (!fullReplyObject.contains(singleFile._remotePath)) {
             if (jobError != QNetworkReply::NoError) {
                 singleFile._item->_status = SyncFileItem::NormalError;
@@ -437,7 +497,7 @@ void BulkPropagatorJob::slotPutFinished()
         slotPutFinishedOneFile(singleFile, job, singleReplyObject);
     }
 
-    finalize(fullReplyObject);
+    finalize(fullReplyObject, batchFiles);
 }
 
 void BulkPropagatorJob::slotUploadProgress(SyncFileItemPtr item, qint64 sent, qint64 total)
@@ -494,18 +554,15 @@ void BulkPropagatorJob::finalizeOneFile(const BulkUploadItem &oneFile)
 
     // Remove from the progress database:
     propagator()->_journal->setUploadInfo(oneFile._item->_file, SyncJournalDb::UploadInfo());
-    propagator()->_journal->commit("upload file start");
+    propagator()->_journal->commitGrouped(QStringLiteral("upload file start"));
 }
 
-void BulkPropagatorJob::finalize(const QJsonObject &fullReply)
+void BulkPropagatorJob::finalize(const QJsonObject &fullReply, const std::vector<BulkUploadItem> &batchFiles)
 {
     qCDebug(lcBulkPropagatorJob) << "Received a full reply" << fullReply;
 
-    for(auto singleFileIt = std::begin(_filesToUpload); singleFileIt != std::end(_filesToUpload); ) {
-        const auto &singleFile = *singleFileIt;
-
+    for (const auto &singleFile : batchFiles) {
         if (!fullReply.contains(singleFile._remotePath)) {
-            ++singleFileIt;
             continue;
         }
         if (!singleFile._item->hasErrorStatus()) {
@@ -513,8 +570,6 @@ void BulkPropagatorJob::finalize(const QJsonObject &fullReply)
         }
 
         done(singleFile._item, singleFile._item->_status, {}, ErrorCategory::GenericError);
-
-        singleFileIt = _filesToUpload.erase(singleFileIt);
     }
 
     checkPropagationIsDone();
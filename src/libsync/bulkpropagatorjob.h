@@ -20,7 +20,9 @@
 #include <QLoggingCategory>
 #include <QVector>
 #include <QMap>
+#include <QHash>
 #include <QByteArray>
+#include <chrono>
 #include <deque>
 
 namespace OCC {
@@ -30,6 +32,27 @@ Q_DECLARE_LOGGING_CATEGORY(lcBulkPropagatorJob)
 class ComputeChecksum;
 class PutMultiFileJob;
 
+/**
+ * @brief Limits of the batches of a bulk upload
+ *
+ * The number of files and bytes per batch adapt to the duration of the previous
+ * batches, within the bounds below and the chunk size bounds of the SyncOptions.
+ */
+struct OWNCLOUDSYNC_EXPORT BulkUploadBatchLimits
+{
+    static constexpr int initialFiles = 100;
+    static constexpr int minFiles = 10;
+    static constexpr int maxFiles = 1000;
+
+    /** Adapts the limits after a successful batch of batchFiles files and batchBytes bytes */
+    void adapt(int batchFiles, qint64 batchBytes, std::chrono::milliseconds uploadTime,
+               const SyncOptions &syncOptions, int maxParallelBatches);
+
+    int _files = initialFiles; /// maximum number of files in a batch
+    qint64 _bytes = 0; /// maximum payload of a batch, exceeded by its last file
+    int _parallelBatches = 1; /// maximum number of batches in flight
+};
+
 class BulkPropagatorJob : public PropagatorJob
 {
     Q_OBJECT
@@ -99,7 +122,10 @@ private:
     void adjustLastJobTimeout(AbstractNetworkJob *job,
                               qint64 fileSize) const;
 
-    void finalize(const QJsonObject &fullReply);
+    /** Sizes the next batches and the number of batches in flight after a successful batch */
+    void adjustBatchSize(const OCC::PutMultiFileJob *job, const int batchFiles, const qint64 batchBytes);
+
+    void finalize(const QJsonObject &fullReply, const std::vector<BulkUploadItem> &batchFiles);
 
     void finalizeOneFile(const BulkUploadItem &oneFile);
 
@@ -161,7 +187,11 @@ private:
 
     QSet<QString> _pendingChecksumFiles;
 
-    std::vector<BulkUploadItem> _filesToUpload;
+    std::vector<BulkUploadItem> _filesToUpload; /// the batch that is prepared
+
+    QHash<PutMultiFileJob *, std::vector<BulkUploadItem>> _filesInFlight; /// the batches being uploaded, by job
+
+    BulkUploadBatchLimits _batchLimits;
 
     SyncFileItem::Status _finalStatus = SyncFileItem::Status::NoStatus;
 };
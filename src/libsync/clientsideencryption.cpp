@@ -33,10 +33,12 @@
 #include <QScopeGuard>
 #include <QRandomGenerator>
 #include <QCryptographicHash>
+#include <QtEndian>
 
 #include <map>
 #include <string>
 #include <algorithm>
+#include <limits>
 
 #include <cstdio>
 
@@ -70,7 +72,10 @@ constexpr char e2e_mnemonic[] = "_e2e-mnemonic";
 
 constexpr auto metadataKeyJsonKey = "metadataKey";
 
-constexpr qint64 blockSize = 1024;
+// Files and downloads are encrypted and decrypted in larger pieces to save on reads and EVP calls
+constexpr qint64 fileBlockSize = 1024 * 1024;
+
+constexpr int aesBlockSize = 16;
 
 constexpr auto metadataKeySize = 16;
 
@@ -2126,7 +2131,7 @@ bool EncryptionHelper::fileEncryption(const QByteArray &key, const QByteArray &i
     if (!input->open(QIODevice::ReadOnly)) {
         qCDebug(lcCse) << "Could not open input file for reading" << input->errorString();
     }
-    if (!output->open(QIODevice::WriteOnly)) {
+    if (output && !output->open(QIODevice::WriteOnly)) {
         qCDebug(lcCse) << "Could not oppen output file for writing" << output->errorString();
     }
 
@@ -2159,31 +2164,36 @@ bool EncryptionHelper::fileEncryption(const QByteArray &key, const QByteArray &i
         return false;
     }
 
-    QByteArray out(blockSize + OCC::Constants::e2EeTagSize - 1, '\0');
+    QByteArray out(fileBlockSize + OCC::Constants::e2EeTagSize - 1, '\0');
+    QByteArray data(fileBlockSize, '\0');
     int len = 0;
 
     qCDebug(lcCse) << "Starting to encrypt the file" << input->fileName() << input->atEnd();
     while(!input->atEnd()) {
-        const auto data = input->read(blockSize);
+        const auto bytesRead = input->read(data.data(), fileBlockSize);
 
-        if (data.size() == 0) {
+        if (bytesRead <= 0) {
             qCInfo(lcCse()) << "Could not read data from file";
             return false;
         }
 
-        if(!EVP_EncryptUpdate(ctx, unsignedData(out), &len, (unsigned char *)data.constData(), data.size())) {
+        if(!EVP_EncryptUpdate(ctx, unsignedData(out), &len, (unsigned char *)data.constData(), static_cast<int>(bytesRead))) {
             qCInfo(lcCse()) << "Could not encrypt";
             return false;
         }
 
-        output->write(out, len);
+        if (output) {
+            output->write(out, len);
+        }
     }
 
     if(1 != EVP_EncryptFinal_ex(ctx, unsignedData(out), &len)) {
         qCInfo(lcCse()) << "Could finalize encryption";
         return false;
     }
-    output->write(out, len);
+    if (output) {
+        output->write(out, len);
+    }
 
     /* Get the e2EeTag */
     QByteArray e2EeTag(OCC::Constants::e2EeTagSize, '\0');
@@ -2193,10 +2203,12 @@ bool EncryptionHelper::fileEncryption(const QByteArray &key, const QByteArray &i
     }
 
     returnTag = e2EeTag;
-    output->write(e2EeTag, OCC::Constants::e2EeTagSize);
 
     input->close();
-    output->close();
+    if (output) {
+        output->write(e2EeTag, OCC::Constants::e2EeTagSize);
+        output->close();
+    }
     qCDebug(lcCse) << "File Encrypted Successfully";
     return true;
 }
@@ -2238,14 +2250,14 @@ bool EncryptionHelper::fileDecryption(const QByteArray &key, const QByteArray& i
 
     qint64 size = input->size() - OCC::Constants::e2EeTagSize;
 
-    QByteArray out(blockSize + OCC::Constants::e2EeTagSize - 1, '\0');
+    QByteArray out(fileBlockSize + OCC::Constants::e2EeTagSize - 1, '\0');
     int len = 0;
 
     while(input->pos() < size) {
 
         auto toRead = size - input->pos();
-        if (toRead > blockSize) {
-            toRead = blockSize;
+        if (toRead > fileBlockSize) {
+            toRead = fileBlockSize;
         }
 
         QByteArray data = input->read(toRead);
@@ -2284,8 +2296,9 @@ bool EncryptionHelper::fileDecryption(const QByteArray &key, const QByteArray& i
 
 EncryptionHelper::StreamingDecryptor::StreamingDecryptor(const QByteArray &key, const QByteArray &iv, quint64 totalSize) : _totalSize(totalSize)
 {
-    if (_ctx && !key.isEmpty() && !iv.isEmpty() && totalSize > 0) {
+    if (_ctx && !key.isEmpty() && !iv.isEmpty() && totalSize >= static_cast<quint64>(OCC::Constants::e2EeTagSize)) {
         _isInitialized = true;
+        _tag.reserve(OCC::Constants::e2EeTagSize);
 
         /* Initialize the decryption operation. */
         if(!EVP_DecryptInit_ex(_ctx, EVP_aes_128_gcm(), nullptr, nullptr, nullptr)) {
@@ -2309,34 +2322,18 @@ EncryptionHelper::StreamingDecryptor::StreamingDecryptor(const QByteArray &key,
     }
 }
 
-QByteArray EncryptionHelper::StreamingDecryptor::chunkDecryption(const char *input, quint64 chunkSize)
+qint64 EncryptionHelper::StreamingDecryptor::chunkDecryption(const char *input, quint64 chunkSize, char *output)
 {
-    QByteArray byteArray;
-    QBuffer buffer(&byteArray);
-    buffer.open(QIODevice::WriteOnly);
-
     Q_ASSERT(isInitialized());
     if (!isInitialized()) {
         qCritical(lcCse()) << "Decryption failed. Decryptor is not initialized!";
-        return QByteArray();
+        return -1;
     }
 
-    Q_ASSERT(buffer.isOpen() && buffer.isWritable());
-    if (!buffer.isOpen() || !buffer.isWritable()) {
-        qCritical(lcCse()) << "Decryption failed. Incorrect output device!";
-        return QByteArray();
-    }
-
-    Q_ASSERT(input);
-    if (!input) {
-        qCritical(lcCse()) << "Decryption failed. Incorrect input!";
-        return QByteArray();
-    }
-
-    Q_ASSERT(chunkSize > 0);
-    if (chunkSize <= 0) {
-        qCritical(lcCse()) << "Decryption failed. Incorrect chunkSize!";
-        return QByteArray();
+    Q_ASSERT(input && output);
+    if (!input || !output) {
+        qCritical(lcCse()) << "Decryption failed. Incorrect input or output!";
+        return -1;
     }
 
     if (_decryptedSoFar == 0) {
@@ -2346,112 +2343,164 @@ QByteArray EncryptionHelper::StreamingDecryptor::chunkDecryption(const char *inp
     Q_ASSERT(_decryptedSoFar + chunkSize <= _totalSize);
     if (_decryptedSoFar + chunkSize > _totalSize) {
         qCritical(lcCse()) << "Decryption failed. Chunk is out of range!";
-        return QByteArray();
+        return -1;
     }
 
-    Q_ASSERT(_decryptedSoFar + chunkSize < OCC::Constants::e2EeTagSize || _totalSize - OCC::Constants::e2EeTagSize >= _decryptedSoFar + chunkSize - OCC::Constants::e2EeTagSize);
-    if (_decryptedSoFar + chunkSize > OCC::Constants::e2EeTagSize && _totalSize - OCC::Constants::e2EeTagSize < _decryptedSoFar + chunkSize - OCC::Constants::e2EeTagSize) {
-        qCritical(lcCse()) << "Decryption failed. Incorrect chunk!";
-        return QByteArray();
-    }
+    // last OCC::Constants::e2EeTagSize bytes is ALWAYS a e2EeTag!!!
+    const quint64 cipherTextSize = _totalSize - OCC::Constants::e2EeTagSize;
+    const quint64 size = _decryptedSoFar < cipherTextSize ? qMin(chunkSize, cipherTextSize - _decryptedSoFar) : 0;
 
-    const bool isLastChunk = _decryptedSoFar + chunkSize == _totalSize;
+    // GCM decrypts as many bytes as it is given, straight into output
+    quint64 inputPos = 0;
+    while (inputPos < size) {
+        const auto blockLength = static_cast<int>(qMin(size - inputPos, static_cast<quint64>(fileBlockSize)));
+        int outLen = 0;
 
-    // last OCC::Constants::e2EeTagSize bytes is ALWAYS a e2EeTag!!!
-    const qint64 size = isLastChunk ? chunkSize - OCC::Constants::e2EeTagSize : chunkSize;
+        if (!EVP_DecryptUpdate(_ctx, reinterpret_cast<unsigned char *>(output + inputPos), &outLen, reinterpret_cast<const unsigned char *>(input + inputPos), blockLength)
+            || outLen != blockLength) {
+            qCritical(lcCse()) << "Could not decrypt";
+            return -1;
+        }
 
-    // either the size is more than 0 and an e2EeTag is at the end of chunk, or, chunk is the e2EeTag itself
-    Q_ASSERT(size > 0 || chunkSize == OCC::Constants::e2EeTagSize);
-    if (size <= 0 && chunkSize != OCC::Constants::e2EeTagSize) {
-        qCritical(lcCse()) << "Decryption failed. Invalid input size: " << size << " !";
-        return QByteArray();
+        inputPos += blockLength;
     }
+    _decryptedSoFar += size;
 
-    qint64 inputPos = 0;
-
-    QByteArray decryptedBlock(blockSize + OCC::Constants::e2EeTagSize - 1, '\0');
+    if (inputPos < chunkSize) {
+        _tag.append(input + inputPos, static_cast<int>(chunkSize - inputPos));
+        _decryptedSoFar += chunkSize - inputPos;
+    }
 
-    while(inputPos < size) {
-        // read blockSize or less bytes
-        const QByteArray encryptedBlock(input + inputPos, qMin(size - inputPos, blockSize));
+    if (_decryptedSoFar == _totalSize && !_isFinished) {
+        // the whole e2EeTag is there, finalize the decryption
+        Q_ASSERT(_tag.size() == OCC::Constants::e2EeTagSize);
 
-        if (encryptedBlock.size() == 0) {
-            qCritical(lcCse()) << "Could not read data from the input buffer.";
-            return QByteArray();
+        /* Set expected e2EeTag value. Works in OpenSSL 1.0.1d and later */
+        if(!EVP_CIPHER_CTX_ctrl(_ctx, EVP_CTRL_GCM_SET_TAG, _tag.size(), unsignedData(_tag))) {
+            qCritical(lcCse()) << "Could not set expected e2EeTag";
+            return -1;
         }
 
+        // GCM has no padding, nothing is left to output
+        unsigned char finalBlock[aesBlockSize] = {};
         int outLen = 0;
-
-        if(!EVP_DecryptUpdate(_ctx, unsignedData(decryptedBlock), &outLen, reinterpret_cast<const unsigned char*>(encryptedBlock.data()), encryptedBlock.size())) {
-            qCritical(lcCse()) << "Could not decrypt";
-            return QByteArray();
+        if(1 != EVP_DecryptFinal_ex(_ctx, finalBlock, &outLen) || outLen != 0) {
+            qCritical(lcCse()) << "Could finalize decryption";
+            return -1;
         }
 
-        const auto writtenToOutput = buffer.write(decryptedBlock, outLen);
+        _isFinished = true;
+        qCDebug(lcCse()) << "Decryption complete";
+    }
 
-        Q_ASSERT(writtenToOutput == outLen);
-        if (writtenToOutput != outLen) {
-            qCritical(lcCse()) << "Failed to write decrypted data to device.";
-            return QByteArray();
-        }
+    return static_cast<qint64>(size);
+}
 
-        // advance input position for further read
-        inputPos += encryptedBlock.size();
+bool EncryptionHelper::StreamingDecryptor::isInitialized() const
+{
+    return _isInitialized;
+}
 
-        _decryptedSoFar += encryptedBlock.size();
+bool EncryptionHelper::StreamingDecryptor::isFinished() const
+{
+    return _isFinished;
+}
+
+EncryptionHelper::StreamingEncryptor::StreamingEncryptor(const QByteArray &key, const QByteArray &iv, const QByteArray &tag)
+    : _tag(tag)
+{
+    if (!_ctx || key.size() != 16 || iv.isEmpty() || tag.size() != OCC::Constants::e2EeTagSize) {
+        qCritical(lcCse()) << "Could not create encryptor, invalid parameters";
+        return;
     }
 
-    if (isLastChunk) {
-        // if it's a last chunk, we'd need to read a e2EeTag at the end and finalize the decryption
+    // OpenSSL does not expose the GCM counter: encrypt a block of zeros to get the
+    // key stream of the first block, and decrypt that into the counter.
+    CipherCtx gcmCtx;
+    QByteArray keyStream(aesBlockSize, '\0');
+    int len = 0;
+    if (!gcmCtx
+        || !EVP_EncryptInit_ex(gcmCtx, EVP_aes_128_gcm(), nullptr, nullptr, nullptr)
+        || !EVP_CIPHER_CTX_ctrl(gcmCtx, EVP_CTRL_GCM_SET_IVLEN, iv.size(), nullptr)
+        || !EVP_EncryptInit_ex(gcmCtx, nullptr, nullptr, reinterpret_cast<const unsigned char *>(key.constData()), reinterpret_cast<const unsigned char *>(iv.constData()))
+        || !EVP_EncryptUpdate(gcmCtx, unsignedData(keyStream), &len, unsignedData(keyStream), aesBlockSize)
+        || len != aesBlockSize) {
+        qCritical(lcCse()) << "Could not compute the key stream";
+        return;
+    }
 
-        Q_ASSERT(chunkSize - inputPos == OCC::Constants::e2EeTagSize);
-        if (chunkSize - inputPos != OCC::Constants::e2EeTagSize) {
-            qCritical(lcCse()) << "Decryption failed. e2EeTag is missing!";
-            return QByteArray();
-        }
+    CipherCtx ecbCtx;
+    _firstCounter = QByteArray(aesBlockSize, '\0');
+    if (!ecbCtx
+        || !EVP_DecryptInit_ex(ecbCtx, EVP_aes_128_ecb(), nullptr, reinterpret_cast<const unsigned char *>(key.constData()), nullptr)
+        || !EVP_CIPHER_CTX_set_padding(ecbCtx, 0)
+        || !EVP_DecryptUpdate(ecbCtx, unsignedData(_firstCounter), &len, unsignedData(keyStream), aesBlockSize)
+        || len != aesBlockSize) {
+        qCritical(lcCse()) << "Could not compute the counter";
+        return;
+    }
 
-        int outLen = 0;
+    if (!EVP_EncryptInit_ex(_ctx, EVP_aes_128_ctr(), nullptr, reinterpret_cast<const unsigned char *>(key.constData()), nullptr)) {
+        qCritical(lcCse()) << "Could not init cipher";
+        return;
+    }
 
-        QByteArray e2EeTag = QByteArray(input + inputPos, OCC::Constants::e2EeTagSize);
+    _isInitialized = true;
+}
 
-        /* Set expected e2EeTag value. Works in OpenSSL 1.0.1d and later */
-        if(!EVP_CIPHER_CTX_ctrl(_ctx, EVP_CTRL_GCM_SET_TAG, e2EeTag.size(), reinterpret_cast<unsigned char*>(e2EeTag.data()))) {
-            qCritical(lcCse()) << "Could not set expected e2EeTag";
-            return QByteArray();
-        }
+bool EncryptionHelper::StreamingEncryptor::encrypt(quint64 offset, char *data, qint64 size)
+{
+    Q_ASSERT(isInitialized());
+    if (!isInitialized()) {
+        qCritical(lcCse()) << "Encryption failed. Encryptor is not initialized!";
+        return false;
+    }
 
-        if(1 != EVP_DecryptFinal_ex(_ctx, unsignedData(decryptedBlock), &outLen)) {
-            qCritical(lcCse()) << "Could finalize decryption";
-            return QByteArray();
+    while (size > 0) {
+        // GCM only increments the low 32 bits of the counter while CTR carries into
+        // the others, so start over at the wrap around
+        auto counter = _firstCounter;
+        const auto counterLow = qFromBigEndian<quint32>(counter.constData() + 12) + static_cast<quint32>(offset / aesBlockSize);
+        qToBigEndian(counterLow, counter.data() + 12);
+        const auto blocksUntilWrap = (quint64(1) << 32) - counterLow;
+        const auto skip = static_cast<int>(offset % aesBlockSize);
+        const auto segmentSize = static_cast<int>(std::min({ static_cast<quint64>(size),
+            blocksUntilWrap * aesBlockSize - skip,
+            static_cast<quint64>(std::numeric_limits<int>::max()) }));
+
+        int len = 0;
+        if (!EVP_EncryptInit_ex(_ctx, nullptr, nullptr, nullptr, unsignedData(counter))) {
+            qCritical(lcCse()) << "Could not set the counter";
+            return false;
         }
-
-        const auto writtenToOutput = buffer.write(decryptedBlock, outLen);
-
-        Q_ASSERT(writtenToOutput == outLen);
-        if (writtenToOutput != outLen) {
-            qCritical(lcCse()) << "Failed to write decrypted data to device.";
-            return QByteArray();
+        if (skip > 0) {
+            // Drop the key stream of the block before offset
+            unsigned char skipped[aesBlockSize] = {};
+            if (!EVP_EncryptUpdate(_ctx, skipped, &len, skipped, skip)) {
+                qCritical(lcCse()) << "Could not encrypt";
+                return false;
+            }
+        }
+        if (!EVP_EncryptUpdate(_ctx, reinterpret_cast<unsigned char *>(data), &len, reinterpret_cast<const unsigned char *>(data), segmentSize)
+            || len != segmentSize) {
+            qCritical(lcCse()) << "Could not encrypt";
+            return false;
         }
 
-        _decryptedSoFar += OCC::Constants::e2EeTagSize;
-
-        _isFinished = true;
-    }
-
-    if (isFinished()) {
-        qCDebug(lcCse()) << "Decryption complete";
+        data += segmentSize;
+        size -= segmentSize;
+        offset += segmentSize;
     }
-
-    return byteArray;
+    return true;
 }
 
-bool EncryptionHelper::StreamingDecryptor::isInitialized() const
+bool EncryptionHelper::StreamingEncryptor::isInitialized() const
 {
     return _isInitialized;
 }
 
-bool EncryptionHelper::StreamingDecryptor::isFinished() const
+QByteArray EncryptionHelper::StreamingEncryptor::tag() const
 {
-    return _isFinished;
+    return _tag;
 }
 }
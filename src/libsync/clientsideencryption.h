@@ -63,6 +63,11 @@ namespace EncryptionHelper {
             const QByteArray& data
     );
 
+    /** Encrypts input into output and appends the tag
+     *
+     * Without an output only the tag is computed, for uploads that encrypt
+     * the file on the fly with a StreamingEncryptor.
+     */
     OWNCLOUDSYNC_EXPORT bool fileEncryption(const QByteArray &key, const QByteArray &iv,
                       QFile *input, QFile *output, QByteArray& returnTag);
 
@@ -100,7 +105,13 @@ public:
     StreamingDecryptor(const QByteArray &key, const QByteArray &iv, quint64 totalSize);
     ~StreamingDecryptor() = default;
 
-    QByteArray chunkDecryption(const char *input, quint64 chunkSize);
+    /** Decrypts the next chunkSize bytes of the stream into output
+     *
+     * output needs room for chunkSize bytes. The tag, the last bytes of the stream,
+     * may be split across chunks. Returns the number of bytes written to output, or
+     * -1 if the decryption failed.
+     */
+    [[nodiscard]] qint64 chunkDecryption(const char *input, quint64 chunkSize, char *output);
 
     [[nodiscard]] bool isInitialized() const;
     [[nodiscard]] bool isFinished() const;
@@ -113,6 +124,35 @@ private:
     bool _isFinished = false;
     quint64 _decryptedSoFar = 0;
     quint64 _totalSize = 0;
+    QByteArray _tag;
+};
+
+/**
+ * Produces the same ciphertext as fileEncryption(), for any range of the file
+ *
+ * AES-GCM encrypts with a counter, so the ciphertext at an offset does not depend
+ * on the data before it. The tag covers the whole file and has to be computed
+ * up front with fileEncryption().
+ */
+class OWNCLOUDSYNC_EXPORT StreamingEncryptor
+{
+public:
+    StreamingEncryptor(const QByteArray &key, const QByteArray &iv, const QByteArray &tag);
+    ~StreamingEncryptor() = default;
+
+    /** Encrypts, in place, size bytes of the file that start at offset */
+    [[nodiscard]] bool encrypt(quint64 offset, char *data, qint64 size);
+
+    [[nodiscard]] bool isInitialized() const;
+    [[nodiscard]] QByteArray tag() const;
+
+private:
+    Q_DISABLE_COPY(StreamingEncryptor)
+
+    CipherCtx _ctx;
+    QByteArray _firstCounter; /// the counter block that encrypts the first block of the file
+    QByteArray _tag;
+    bool _isInitialized = false;
 };
 }
 
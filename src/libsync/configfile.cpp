@@ -77,11 +77,14 @@ static constexpr char chunkSizeC[] = "chunkSize";
 static constexpr char minChunkSizeC[] = "minChunkSize";
 static constexpr char maxChunkSizeC[] = "maxChunkSize";
 static constexpr char targetChunkUploadDurationC[] = "targetChunkUploadDuration";
+static constexpr char parallelChunkUploadsC[] = "parallelChunkUploads";
 static constexpr char automaticLogDirC[] = "logToTemporaryLogDir";
 static constexpr char logDirC[] = "logDir";
 static constexpr char logDebugC[] = "logDebug";
 static constexpr char logExpireC[] = "logExpire";
 static constexpr char logFlushC[] = "logFlush";
+static constexpr char logMaxFileSizeC[] = "logMaxFileSize";
+static constexpr char logMaxTotalSizeC[] = "logMaxTotalSize";
 static constexpr char showExperimentalOptionsC[] = "showExperimentalOptions";
 static constexpr char clientVersionC[] = "clientVersion";
 
@@ -267,6 +270,12 @@ chrono::milliseconds ConfigFile::targetChunkUploadDuration() const
     return millisecondsValue(settings, targetChunkUploadDurationC, chrono::minutes(1));
 }
 
+int ConfigFile::parallelChunkUploads() const
+{
+    QSettings settings(configFile(), QSettings::IniFormat);
+    return settings.value(QLatin1String(parallelChunkUploadsC), 1).toInt(); // default to one chunk at a time
+}
+
 void ConfigFile::setOptionalServerNotifications(bool show)
 {
     QSettings settings(configFile(), QSettings::IniFormat);
@@ -1098,6 +1107,30 @@ void ConfigFile::setLogFlush(bool enabled)
     settings.setValue(QLatin1String(logFlushC), enabled);
 }
 
+int ConfigFile::logMaxFileSize() const
+{
+    QSettings settings(configFile(), QSettings::IniFormat);
+    return settings.value(QLatin1String(logMaxFileSizeC), 64).toInt();
+}
+
+void ConfigFile::setLogMaxFileSize(int megabytes)
+{
+    QSettings settings(configFile(), QSettings::IniFormat);
+    settings.setValue(QLatin1String(logMaxFileSizeC), megabytes);
+}
+
+int ConfigFile::logMaxTotalSize() const
+{
+    QSettings settings(configFile(), QSettings::IniFormat);
+    return settings.value(QLatin1String(logMaxTotalSizeC), 1024).toInt();
+}
+
+void ConfigFile::setLogMaxTotalSize(int megabytes)
+{
+    QSettings settings(configFile(), QSettings::IniFormat);
+    settings.setValue(QLatin1String(logMaxTotalSizeC), megabytes);
+}
+
 bool ConfigFile::showExperimentalOptions() const
 {
     QSettings settings(configFile(), QSettings::IniFormat);
@@ -111,6 +111,14 @@ public:
     [[nodiscard]] bool logFlush() const;
     void setLogFlush(bool enabled);
 
+    /** Size in MB after which the log file is rotated, 0 to rotate by line count only */
+    [[nodiscard]] int logMaxFileSize() const;
+    void setLogMaxFileSize(int megabytes);
+
+    /** Size in MB of all logs in the log dir after which the oldest ones are removed, 0 for no limit */
+    [[nodiscard]] int logMaxTotalSize() const;
+    void setLogMaxTotalSize(int megabytes);
+
     // Whether experimental UI options should be shown
     [[nodiscard]] bool showExperimentalOptions() const;
 
@@ -171,6 +179,7 @@ public:
     [[nodiscard]] qint64 maxChunkSize() const;
     [[nodiscard]] qint64 minChunkSize() const;
     [[nodiscard]] std::chrono::milliseconds targetChunkUploadDuration() const;
+    [[nodiscard]] int parallelChunkUploads() const;
 
     void saveGeometry(QWidget *w);
     void restoreGeometry(QWidget *w);
@@ -29,6 +29,8 @@
 #include <QFileInfo>
 #include <QFile>
 #include <QThreadPool>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <common/checksums.h>
 #include <common/constants.h>
 #include "csync_exclude.h"
@@ -545,20 +547,40 @@ void ProcessDirectoryJob::processFile(PathTuple path,
     processFileAnalyzeLocalInfo(item, path, localEntry, serverEntry, dbEntry, _queryServer);
 }
 
-// Compute the checksum of the given file and assign the result in item->_checksumHeader
-// Returns true if the checksum was successfully computed
-static bool computeLocalChecksum(const QByteArray &header, const QString &path, const SyncFileItemPtr &item)
+// Hashing is bound by disk throughput: a few threads are enough to not stall discovery,
+// more would just compete for the same disk
+Q_GLOBAL_STATIC(QThreadPool, localChecksumThreadPool)
+static constexpr int localChecksumMaxThreadCount = 2;
+
+void ProcessDirectoryJob::computeLocalChecksumAsync(const QByteArray &header, const QString &path, const SyncFileItemPtr &item, const std::function<void(bool)> &callback)
 {
-    auto type = parseChecksumHeaderType(header);
-    if (!type.isEmpty()) {
-        // TODO: compute async?
-        QByteArray checksum = ComputeChecksum::computeNowOnFile(path, type);
+    const auto type = parseChecksumHeaderType(header);
+    if (type.isEmpty()) {
+        callback(false);
+        return;
+    }
+
+    auto pool = localChecksumThreadPool();
+    if (pool->maxThreadCount() != localChecksumMaxThreadCount) {
+        pool->setMaxThreadCount(localChecksumMaxThreadCount);
+    }
+
+    _pendingAsyncJobs++;
+    auto watcher = new QFutureWatcher<QByteArray>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [=] {
+        watcher->deleteLater();
+        _pendingAsyncJobs--;
+
+        const auto checksum = watcher->result();
         if (!checksum.isEmpty()) {
             item->_checksumHeader = makeChecksumHeader(type, checksum);
-            return true;
         }
-    }
-    return false;
+        callback(!checksum.isEmpty());
+        QTimer::singleShot(0, _discoveryData, &DiscoveryPhase::scheduleMoreJobs);
+    });
+    watcher->setFuture(QtConcurrent::run(pool, [path, type] {
+        return ComputeChecksum::computeNowOnFile(path, type);
+    }));
 }
 
 void ProcessDirectoryJob::postProcessServerNew(const SyncFileItemPtr &item,
@@ -967,6 +989,29 @@ void ProcessDirectoryJob::processFileAnalyzeRemoteInfo(const SyncFileItemPtr &it
     processFileAnalyzeLocalInfo(item, path, localEntry, serverEntry, dbEntry, _queryServer);
 }
 
+void ProcessDirectoryJob::processFileAnalyzeLocalInfoFinalize(
+    const SyncFileItemPtr &item, PathTuple path, const LocalInfo &localEntry,
+    const RemoteInfo &serverEntry, QueryMode recurseQueryServer)
+{
+    bool recurse = item->isDirectory() || localEntry.isDirectory || serverEntry.isDirectory;
+    // Even if we have a local directory: If the remote is a file that's propagated as a
+    // conflict we don't need to recurse into it. (local c1.owncloud, c1/ ; remote: c1)
+    if (item->_instruction == CSYNC_INSTRUCTION_CONFLICT && !item->isDirectory())
+        recurse = false;
+    if (_queryLocal != NormalQuery && _queryServer != NormalQuery)
+        recurse = false;
+
+    if ((item->_direction == SyncFileItem::Down || item->_instruction == CSYNC_INSTRUCTION_CONFLICT || item->_instruction == CSYNC_INSTRUCTION_NEW || item->_instruction == CSYNC_INSTRUCTION_SYNC) &&
+            (item->_modtime <= 0 || item->_modtime >= 0xFFFFFFFF)) {
+        item->_instruction = CSYNC_INSTRUCTION_ERROR;
+        item->_errorString = tr("Cannot sync due to invalid modification time");
+        item->_status = SyncFileItem::Status::NormalError;
+    }
+
+    auto recurseQueryLocal = _queryLocal == ParentNotChanged ? ParentNotChanged : localEntry.isDirectory || item->_instruction == CSYNC_INSTRUCTION_RENAME ? NormalQuery : ParentDontExist;
+    processFileFinalize(item, path, recurse, recurseQueryLocal, recurseQueryServer);
+}
+
 void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
     const SyncFileItemPtr &item, PathTuple path, const LocalInfo &localEntry,
     const RemoteInfo &serverEntry, const SyncJournalFileRecord &dbEntry, QueryMode recurseQueryServer)
@@ -999,23 +1044,7 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
     _childModified |= serverModified;
 
     auto finalize = [&] {
-        bool recurse = item->isDirectory() || localEntry.isDirectory || serverEntry.isDirectory;
-        // Even if we have a local directory: If the remote is a file that's propagated as a
-        // conflict we don't need to recurse into it. (local c1.owncloud, c1/ ; remote: c1)
-        if (item->_instruction == CSYNC_INSTRUCTION_CONFLICT && !item->isDirectory())
-            recurse = false;
-        if (_queryLocal != NormalQuery && _queryServer != NormalQuery)
-            recurse = false;
-
-        if ((item->_direction == SyncFileItem::Down || item->_instruction == CSYNC_INSTRUCTION_CONFLICT || item->_instruction == CSYNC_INSTRUCTION_NEW || item->_instruction == CSYNC_INSTRUCTION_SYNC) &&
-                (item->_modtime <= 0 || item->_modtime >= 0xFFFFFFFF)) {
-            item->_instruction = CSYNC_INSTRUCTION_ERROR;
-            item->_errorString = tr("Cannot sync due to invalid modification time");
-            item->_status = SyncFileItem::Status::NormalError;
-        }
-
-        auto recurseQueryLocal = _queryLocal == ParentNotChanged ? ParentNotChanged : localEntry.isDirectory || item->_instruction == CSYNC_INSTRUCTION_RENAME ? NormalQuery : ParentDontExist;
-        processFileFinalize(item, path, recurse, recurseQueryLocal, recurseQueryServer);
+        processFileAnalyzeLocalInfoFinalize(item, path, localEntry, serverEntry, recurseQueryServer);
     };
 
     if (!localEntry.isValid()) {
@@ -1175,11 +1204,15 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
             // check #4754 #4755
             bool isEmlFile = path._original.endsWith(QLatin1String(".eml"), Qt::CaseInsensitive);
             if (isEmlFile && dbEntry._fileSize == localEntry.size && !dbEntry._checksumHeader.isEmpty()) {
-                if (computeLocalChecksum(dbEntry._checksumHeader, _discoveryData->_localDir + path._local, item)
-                        && item->_checksumHeader == dbEntry._checksumHeader) {
-                    qCInfo(lcDisco) << "NOTE: Checksums are identical, file did not actually change: " << path._local;
-                    item->_instruction = CSYNC_INSTRUCTION_UPDATE_METADATA;
-                }
+                const auto dbChecksumHeader = dbEntry._checksumHeader;
+                computeLocalChecksumAsync(dbChecksumHeader, _discoveryData->_localDir + path._local, item, [=](bool computed) {
+                    if (computed && item->_checksumHeader == dbChecksumHeader) {
+                        qCInfo(lcDisco) << "NOTE: Checksums are identical, file did not actually change: " << path._local;
+                        item->_instruction = CSYNC_INSTRUCTION_UPDATE_METADATA;
+                    }
+                    processFileAnalyzeLocalInfoFinalize(item, path, localEntry, serverEntry, recurseQueryServer);
+                });
+                return;
             }
         }
 
@@ -1345,140 +1378,156 @@ void ProcessDirectoryJob::processFileAnalyzeLocalInfo(
             return false;
         }
 
-        // Verify the checksum where possible
-        if (!base._checksumHeader.isEmpty() && item->_type == ItemTypeFile && base._type == ItemTypeFile) {
-            if (computeLocalChecksum(base._checksumHeader, _discoveryData->_localDir + path._original, item)) {
-                qCInfo(lcDisco) << "checking checksum of potential rename " << path._original << item->_checksumHeader << base._checksumHeader;
-                if (item->_checksumHeader != base._checksumHeader) {
-                    qCInfo(lcDisco) << "Not a move, checksums differ";
-                    return false;
-                }
-            }
-        }
+        return true;
+    };
 
-        if (_discoveryData->isRenamed(originalPath)) {
+    // Continues once the move-candidate checks, including the asynchronous checksum
+    // verification, are done. Everything it needs is captured by value.
+    auto processMoveCandidate = [=](bool isMove) mutable {
+        if (isMove && _discoveryData->isRenamed(originalPath)) {
             qCInfo(lcDisco) << "Not a move, base path already renamed";
-            return false;
+            isMove = false;
         }
 
-        return true;
-    };
-
-    // If it's not a move it's just a local-NEW
-    if (!moveCheck()) {
-        if (base.isE2eEncrypted()) {
-            // renaming the encrypted folder is done via remove + re-upload hence we need to mark the newly created folder as encrypted
-            // base is a record in the SyncJournal database that contains the data about the being-renamed folder with it's old name and encryption information
-            item->_e2eEncryptionStatus = EncryptionStatusEnums::fromDbEncryptionStatus(base._e2eEncryptionStatus);
+        // If it's not a move it's just a local-NEW
+        if (!isMove) {
+            if (base.isE2eEncrypted()) {
+                // renaming the encrypted folder is done via remove + re-upload hence we need to mark the newly created folder as encrypted
+                // base is a record in the SyncJournal database that contains the data about the being-renamed folder with it's old name and encryption information
+                item->_e2eEncryptionStatus = EncryptionStatusEnums::fromDbEncryptionStatus(base._e2eEncryptionStatus);
+            }
+            postProcessLocalNew();
+            processFileAnalyzeLocalInfoFinalize(item, path, localEntry, serverEntry, recurseQueryServer);
+            return;
         }
-        postProcessLocalNew();
-        finalize();
-        return;
-    }
 
-    // Check local permission if we are allowed to put move the file here
-    // Technically we should use the permissions from the server, but we'll assume it is the same
-    auto movePerms = checkMovePermissions(base._remotePerm, originalPath, item->isDirectory());
-    if (!movePerms.sourceOk || !movePerms.destinationOk) {
-        qCInfo(lcDisco) << "Move without permission to rename base file, "
-                        << "source:" << movePerms.sourceOk
-                        << ", target:" << movePerms.destinationOk
-                        << ", targetNew:" << movePerms.destinationNewOk;
+        // Check local permission if we are allowed to put move the file here
+        // Technically we should use the permissions from the server, but we'll assume it is the same
+        auto movePerms = checkMovePermissions(base._remotePerm, originalPath, item->isDirectory());
+        if (!movePerms.sourceOk || !movePerms.destinationOk) {
+            qCInfo(lcDisco) << "Move without permission to rename base file, "
+                            << "source:" << movePerms.sourceOk
+                            << ", target:" << movePerms.destinationOk
+                            << ", targetNew:" << movePerms.destinationNewOk;
 
-        // If we can create the destination, do that.
-        // Permission errors on the destination will be handled by checkPermissions later.
-        postProcessLocalNew();
-        finalize();
+            // If we can create the destination, do that.
+            // Permission errors on the destination will be handled by checkPermissions later.
+            postProcessLocalNew();
+            processFileAnalyzeLocalInfoFinalize(item, path, localEntry, serverEntry, recurseQueryServer);
 
-        // If the destination upload will work, we're fine with the source deletion.
-        // If the source deletion can't work, checkPermissions will error.
-        if (movePerms.destinationNewOk)
+            // If the destination upload will work, we're fine with the source deletion.
+            // If the source deletion can't work, checkPermissions will error.
+            if (movePerms.destinationNewOk)
+                return;
+
+            // Here we know the new location can't be uploaded: must prevent the source delete.
+            // Two cases: either the source item was already processed or not.
+            auto wasDeletedOnClient = _discoveryData->findAndCancelDeletedJob(originalPath);
+            if (wasDeletedOnClient.first) {
+                // More complicated. The REMOVE is canceled. Restore will happen next sync.
+                qCInfo(lcDisco) << "Undid remove instruction on source" << originalPath;
+                if (!_discoveryData->_statedb->deleteFileRecord(originalPath, true)) {
+                    qCWarning(lcDisco) << "Failed to delete a file record from the local DB" << originalPath;
+                }
+                _discoveryData->_statedb->schedulePathForRemoteDiscovery(originalPath);
+                _discoveryData->_anotherSyncNeeded = true;
+            } else {
+                // Signal to future checkPermissions() to forbid the REMOVE and set to restore instead
+                qCInfo(lcDisco) << "Preventing future remove on source" << originalPath;
+                _discoveryData->_forbiddenDeletes[originalPath + '/'] = true;
+            }
             return;
+        }
 
-        // Here we know the new location can't be uploaded: must prevent the source delete.
-        // Two cases: either the source item was already processed or not.
         auto wasDeletedOnClient = _discoveryData->findAndCancelDeletedJob(originalPath);
+
+        auto processRename = [item, originalPath, base, this](PathTuple &path) {
+            auto adjustedOriginalPath = _discoveryData->adjustRenamedPath(originalPath, SyncFileItem::Down);
+            _discoveryData->_renamedItemsLocal.insert(originalPath, path._target);
+            item->_renameTarget = path._target;
+            path._server = adjustedOriginalPath;
+            item->_file = path._server;
+            path._original = originalPath;
+            item->_originalFile = path._original;
+            item->_modtime = base._modtime;
+            item->_inode = base._inode;
+            item->_instruction = CSYNC_INSTRUCTION_RENAME;
+            item->_direction = SyncFileItem::Up;
+            item->_fileId = base._fileId;
+            item->_remotePerm = base._remotePerm;
+            item->_isShared = base._isShared;
+            item->_sharedByMe = base._sharedByMe;
+            item->_lastShareStateFetchedTimestamp = base._lastShareStateFetchedTimestamp;
+            item->_etag = base._etag;
+            item->_type = base._type;
+
+            // Discard any download/dehydrate tags on the base file.
+            // They could be preserved and honored in a follow-up sync,
+            // but it complicates handling a lot and will happen rarely.
+            if (item->_type == ItemTypeVirtualFileDownload)
+                item->_type = ItemTypeVirtualFile;
+            if (item->_type == ItemTypeVirtualFileDehydration)
+                item->_type = ItemTypeFile;
+
+            qCInfo(lcDisco) << "Rename detected (up) " << item->_file << " -> " << item->_renameTarget;
+        };
         if (wasDeletedOnClient.first) {
-            // More complicated. The REMOVE is canceled. Restore will happen next sync.
-            qCInfo(lcDisco) << "Undid remove instruction on source" << originalPath;
-            if (!_discoveryData->_statedb->deleteFileRecord(originalPath, true)) {
-                qCWarning(lcDisco) << "Failed to delete a file record from the local DB" << originalPath;
-            }
-            _discoveryData->_statedb->schedulePathForRemoteDiscovery(originalPath);
-            _discoveryData->_anotherSyncNeeded = true;
+            recurseQueryServer = wasDeletedOnClient.second == base._etag ? ParentNotChanged : NormalQuery;
+            processRename(path);
         } else {
-            // Signal to future checkPermissions() to forbid the REMOVE and set to restore instead
-            qCInfo(lcDisco) << "Preventing future remove on source" << originalPath;
-            _discoveryData->_forbiddenDeletes[originalPath + '/'] = true;
-        }
-        return;
-    }
+            // We must query the server to know if the etag has not changed
+            _pendingAsyncJobs++;
+            QString serverOriginalPath = _discoveryData->_remoteFolder + _discoveryData->adjustRenamedPath(originalPath, SyncFileItem::Down);
+            if (base.isVirtualFile() && isVfsWithSuffix())
+                chopVirtualFileSuffix(serverOriginalPath);
+            auto job = new RequestEtagJob(_discoveryData->_account, serverOriginalPath, this);
+            connect(job, &RequestEtagJob::finishedWithResult, this, [=](const HttpResult<QByteArray> &etag) mutable {
 
-    auto wasDeletedOnClient = _discoveryData->findAndCancelDeletedJob(originalPath);
 
-    auto processRename = [item, originalPath, base, this](PathTuple &path) {
-        auto adjustedOriginalPath = _discoveryData->adjustRenamedPath(originalPath, SyncFileItem::Down);
-        _discoveryData->_renamedItemsLocal.insert(originalPath, path._target);
-        item->_renameTarget = path._target;
-        path._server = adjustedOriginalPath;
-        item->_file = path._server;
-        path._original = originalPath;
-        item->_originalFile = path._original;
-        item->_modtime = base._modtime;
-        item->_inode = base._inode;
-        item->_instruction = CSYNC_INSTRUCTION_RENAME;
-        item->_direction = SyncFileItem::Up;
-        item->_fileId = base._fileId;
-        item->_remotePerm = base._remotePerm;
-        item->_isShared = base._isShared;
-        item->_sharedByMe = base._sharedByMe;
-        item->_lastShareStateFetchedTimestamp = base._lastShareStateFetchedTimestamp;
-        item->_etag = base._etag;
-        item->_type = base._type;
-
-        // Discard any download/dehydrate tags on the base file.
-        // They could be preserved and honored in a follow-up sync,
-        // but it complicates handling a lot and will happen rarely.
-        if (item->_type == ItemTypeVirtualFileDownload)
-            item->_type = ItemTypeVirtualFile;
-        if (item->_type == ItemTypeVirtualFileDehydration)
-            item->_type = ItemTypeFile;
+                if (!etag || (etag.get() != base._etag && !item->isDirectory()) || _discoveryData->isRenamed(originalPath)
+                    || (isAnyParentBeingRestored(originalPath) && !isRename(originalPath))) {
+                    qCInfo(lcDisco) << "Can't rename because the etag has changed or the directory is gone or we are restoring one of the file's parents." << originalPath;
+                    // Can't be a rename, leave it as a new.
+                    postProcessLocalNew();
+                } else {
+                    // In case the deleted item was discovered in parallel
+                    _discoveryData->findAndCancelDeletedJob(originalPath);
+                    processRename(path);
+                    recurseQueryServer = etag.get() == base._etag ? ParentNotChanged : NormalQuery;
+                }
+                processFileFinalize(item, path, item->isDirectory(), NormalQuery, recurseQueryServer);
+                _pendingAsyncJobs--;
+                QTimer::singleShot(0, _discoveryData, &DiscoveryPhase::scheduleMoreJobs);
+            });
+            job->start();
+            return;
+        }
 
-        qCInfo(lcDisco) << "Rename detected (up) " << item->_file << " -> " << item->_renameTarget;
+        processFileAnalyzeLocalInfoFinalize(item, path, localEntry, serverEntry, recurseQueryServer);
     };
-    if (wasDeletedOnClient.first) {
-        recurseQueryServer = wasDeletedOnClient.second == base._etag ? ParentNotChanged : NormalQuery;
-        processRename(path);
-    } else {
-        // We must query the server to know if the etag has not changed
-        _pendingAsyncJobs++;
-        QString serverOriginalPath = _discoveryData->_remoteFolder + _discoveryData->adjustRenamedPath(originalPath, SyncFileItem::Down);
-        if (base.isVirtualFile() && isVfsWithSuffix())
-            chopVirtualFileSuffix(serverOriginalPath);
-        auto job = new RequestEtagJob(_discoveryData->_account, serverOriginalPath, this);
-        connect(job, &RequestEtagJob::finishedWithResult, this, [=](const HttpResult<QByteArray> &etag) mutable {
-
-
-            if (!etag || (etag.get() != base._etag && !item->isDirectory()) || _discoveryData->isRenamed(originalPath)
-                || (isAnyParentBeingRestored(originalPath) && !isRename(originalPath))) {
-                qCInfo(lcDisco) << "Can't rename because the etag has changed or the directory is gone or we are restoring one of the file's parents." << originalPath;
-                // Can't be a rename, leave it as a new.
-                postProcessLocalNew();
-            } else {
-                // In case the deleted item was discovered in parallel
-                _discoveryData->findAndCancelDeletedJob(originalPath);
-                processRename(path);
-                recurseQueryServer = etag.get() == base._etag ? ParentNotChanged : NormalQuery;
+
+    if (!moveCheck()) {
+        processMoveCandidate(false);
+        return;
+    }
+
+    // Verify the checksum where possible
+    if (!base._checksumHeader.isEmpty() && item->_type == ItemTypeFile && base._type == ItemTypeFile) {
+        computeLocalChecksumAsync(base._checksumHeader, _discoveryData->_localDir + path._original, item, [=](bool computed) mutable {
+            if (computed) {
+                qCInfo(lcDisco) << "checking checksum of potential rename " << path._original << item->_checksumHeader << base._checksumHeader;
+                if (item->_checksumHeader != base._checksumHeader) {
+                    qCInfo(lcDisco) << "Not a move, checksums differ";
+                    processMoveCandidate(false);
+                    return;
+                }
             }
-            processFileFinalize(item, path, item->isDirectory(), NormalQuery, recurseQueryServer);
-            _pendingAsyncJobs--;
-            QTimer::singleShot(0, _discoveryData, &DiscoveryPhase::scheduleMoreJobs);
+            processMoveCandidate(true);
         });
-        job->start();
         return;
     }
 
-    finalize();
+    processMoveCandidate(true);
 }
 
 void ProcessDirectoryJob::processFileConflict(const SyncFileItemPtr &item, ProcessDirectoryJob::PathTuple path, const LocalInfo &localEntry, const RemoteInfo &serverEntry, const SyncJournalFileRecord &dbEntry)
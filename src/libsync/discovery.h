@@ -174,6 +174,18 @@ private:
     /// processFile helper for reconciling local changes
     void processFileAnalyzeLocalInfo(const SyncFileItemPtr &item, PathTuple, const LocalInfo &, const RemoteInfo &, const SyncJournalFileRecord &, QueryMode recurseQueryServer);
 
+    /// processFile helper for the final step of processFileAnalyzeLocalInfo, may run asynchronously
+    void processFileAnalyzeLocalInfoFinalize(const SyncFileItemPtr &item, PathTuple, const LocalInfo &, const RemoteInfo &, QueryMode recurseQueryServer);
+
+    /** Compute the checksum of the file at path in a worker thread
+     *
+     * The checksum type is taken from header. On success the result is assigned
+     * to item->_checksumHeader. The callback is called with whether the checksum
+     * could be computed; it is called synchronously if the type is unknown.
+     * The computation is counted in _pendingAsyncJobs.
+     */
+    void computeLocalChecksumAsync(const QByteArray &header, const QString &path, const SyncFileItemPtr &item, const std::function<void(bool)> &callback);
+
     /// processFile helper for local/remote conflicts
     void processFileConflict(const SyncFileItemPtr &item, PathTuple, const LocalInfo &, const RemoteInfo &, const SyncJournalFileRecord &);
 
@@ -24,6 +24,8 @@
 
 #include "common/asserts.h"
 #include "common/checksums.h"
+#include "common/metrics.h"
+#include "common/synctrace.h"
 
 #include <csync_exclude.h>
 #include "vio/csync_vio_local.h"
@@ -286,6 +288,9 @@ DiscoverySingleLocalDirectoryJob::DiscoverySingleLocalDirectoryJob(const Account
 
 // Use as QRunnable
 void DiscoverySingleLocalDirectoryJob::run() {
+    const SyncTrace::Scope traceScope(SyncTrace::Discovery, QStringLiteral("local directory"), _localPath);
+    static auto &latency = Metrics::histogram("discovery.localDirectory.usec");
+    const Metrics::ScopedTimer timer(latency);
     QString localPath = _localPath;
     if (localPath.endsWith('/')) // Happens if _currentFolder._local.isEmpty()
         localPath.chop(1);
@@ -372,6 +377,26 @@ DiscoverySingleDirectoryJob::DiscoverySingleDirectoryJob(const AccountPtr &accou
 
 void DiscoverySingleDirectoryJob::start()
 {
+    if (SyncTrace::isEnabled()) {
+        const auto traceStart = SyncTrace::now();
+        connect(this, &DiscoverySingleDirectoryJob::finished, this, [this, traceStart](const HttpResult<QVector<RemoteInfo>> &result) {
+            SyncTrace::record(SyncTrace::Discovery, QStringLiteral("remote directory"), _subPath, traceStart,
+                result ? result->size() : -1, result ? 0 : result.error().code);
+        });
+    }
+    if (Metrics::isEnabled()) {
+        QElapsedTimer duration;
+        duration.start();
+        connect(this, &DiscoverySingleDirectoryJob::finished, this, [duration](const HttpResult<QVector<RemoteInfo>> &result) {
+            static auto &latency = Metrics::histogram("discovery.remoteDirectory.usec");
+            static auto &entries = Metrics::counter("discovery.remoteEntries");
+            latency.record(duration.nsecsElapsed() / 1000);
+            if (result) {
+                entries.add(result->size());
+            }
+        });
+    }
+
     // Start the actual HTTP job
     auto *lsColJob = new LsColJob(_account, _subPath, this);
 
@@ -409,7 +434,7 @@ void DiscoverySingleDirectoryJob::start()
 
     lsColJob->setProperties(props);
 
-    QObject::connect(lsColJob, &LsColJob::directoryListingIterated,
+    QObject::connect(lsColJob, &LsColJob::directoryListingRecordIterated,
         this, &DiscoverySingleDirectoryJob::directoryListingIteratedSlot);
     QObject::connect(lsColJob, &LsColJob::finishedWithError, this, &DiscoverySingleDirectoryJob::lsJobFinishedWithErrorSlot);
     QObject::connect(lsColJob, &LsColJob::finishedWithoutError, this, &DiscoverySingleDirectoryJob::lsJobFinishedWithoutErrorSlot);
@@ -435,131 +460,137 @@ bool DiscoverySingleDirectoryJob::encryptedMetadataNeedUpdate() const
     return _encryptedMetadataNeedUpdate;
 }
 
-static void propertyMapToRemoteInfo(const QMap<QString, QString> &map, RemoteInfo &result)
+static void propertyRecordToRemoteInfo(const DavPropertyRecord &record, RemoteInfo &result)
 {
-    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
-        QString property = it.key();
-        QString value = it.value();
-        if (property == QLatin1String("resourcetype")) {
-            result.isDirectory = value.contains(QLatin1String("collection"));
-        } else if (property == QLatin1String("getlastmodified")) {
-            const auto date = QDateTime::fromString(value, Qt::RFC2822Date);
-            Q_ASSERT(date.isValid());
-            result.modtime = 0;
-            if (date.toSecsSinceEpoch() > 0) {
-                result.modtime = date.toSecsSinceEpoch();
-            }
-        } else if (property == QLatin1String("getcontentlength")) {
-            // See #4573, sometimes negative size values are returned
-            bool ok = false;
-            qlonglong ll = value.toLongLong(&ok);
-            if (ok && ll >= 0) {
-                result.size = ll;
-            } else {
-                result.size = 0;
-            }
-        } else if (property == "getetag") {
-            result.etag = Utility::normalizeEtag(value.toUtf8());
-        } else if (property == "id") {
-            result.fileId = value.toUtf8();
-        } else if (property == "downloadURL") {
-            result.directDownloadUrl = value;
-        } else if (property == "dDC") {
-            result.directDownloadCookies = value;
-        } else if (property == "permissions") {
-            result.remotePerm = RemotePermissions::fromServerString(value);
-        } else if (property == "checksums") {
-            result.checksumHeader = findBestChecksum(value.toUtf8());
-        } else if (property == "share-types" && !value.isEmpty()) {
-            // Since QMap is sorted, "share-types" is always after "permissions".
-            if (result.remotePerm.isNull()) {
-                qWarning() << "Server returned a share type, but no permissions?";
-            } else {
-                // S means shared with me.
-                // But for our purpose, we want to know if the file is shared. It does not matter
-                // if we are the owner or not.
-                // Piggy back on the permission field
-                result.remotePerm.setPermission(RemotePermissions::IsShared);
-                result.sharedByMe = true;
-            }
-        } else if (property == "is-encrypted" && value == QStringLiteral("1")) {
-            result._isE2eEncrypted = true;
-        } else if (property == "lock") {
-            result.locked = (value == QStringLiteral("1") ? SyncFileItem::LockStatus::LockedItem : SyncFileItem::LockStatus::UnlockedItem);
-        }
-        if (property == "lock-owner-displayname") {
-            result.lockOwnerDisplayName = value;
+    if (record.contains(DavPropertyRecord::ResourceType)) {
+        result.isDirectory = record.value(DavPropertyRecord::ResourceType).contains(QLatin1String("collection"));
+    }
+    if (record.contains(DavPropertyRecord::GetLastModified)) {
+        const auto date = QDateTime::fromString(record.value(DavPropertyRecord::GetLastModified), Qt::RFC2822Date);
+        Q_ASSERT(date.isValid());
+        result.modtime = 0;
+        if (date.toSecsSinceEpoch() > 0) {
+            result.modtime = date.toSecsSinceEpoch();
         }
-        if (property == "lock-owner") {
-            result.lockOwnerId = value;
+    }
+    if (record.contains(DavPropertyRecord::GetContentLength)) {
+        // See #4573, sometimes negative size values are returned
+        bool ok = false;
+        qlonglong ll = record.value(DavPropertyRecord::GetContentLength).toLongLong(&ok);
+        if (ok && ll >= 0) {
+            result.size = ll;
+        } else {
+            result.size = 0;
         }
-        if (property == "lock-owner-type") {
-            auto ok = false;
-            const auto intConvertedValue = value.toULongLong(&ok);
-            if (ok) {
-                result.lockOwnerType = static_cast<SyncFileItem::LockOwnerType>(intConvertedValue);
-            } else {
-                result.lockOwnerType = SyncFileItem::LockOwnerType::UserLock;
-            }
+    }
+    if (record.contains(DavPropertyRecord::GetEtag)) {
+        result.etag = Utility::normalizeEtag(record.value(DavPropertyRecord::GetEtag).toUtf8());
+    }
+    if (record.contains(DavPropertyRecord::Id)) {
+        result.fileId = record.value(DavPropertyRecord::Id).toUtf8();
+    }
+    if (record.contains(DavPropertyRecord::DownloadUrl)) {
+        result.directDownloadUrl = record.value(DavPropertyRecord::DownloadUrl);
+    }
+    if (record.contains(DavPropertyRecord::DDC)) {
+        result.directDownloadCookies = record.value(DavPropertyRecord::DDC);
+    }
+    if (record.contains(DavPropertyRecord::Permissions)) {
+        result.remotePerm = RemotePermissions::fromServerString(record.value(DavPropertyRecord::Permissions));
+    }
+    if (record.contains(DavPropertyRecord::Checksums)) {
+        result.checksumHeader = findBestChecksum(record.value(DavPropertyRecord::Checksums).toUtf8());
+    }
+    if (!record.value(DavPropertyRecord::ShareTypes).isEmpty()) {
+        // Must be handled after "permissions"
+        if (result.remotePerm.isNull()) {
+            qWarning() << "Server returned a share type, but no permissions?";
+        } else {
+            // S means shared with me.
+            // But for our purpose, we want to know if the file is shared. It does not matter
+            // if we are the owner or not.
+            // Piggy back on the permission field
+            result.remotePerm.setPermission(RemotePermissions::IsShared);
+            result.sharedByMe = true;
         }
-        if (property == "lock-owner-editor") {
-            result.lockEditorApp = value;
+    }
+    if (record.value(DavPropertyRecord::IsEncrypted) == QStringLiteral("1")) {
+        result._isE2eEncrypted = true;
+    }
+    if (record.contains(DavPropertyRecord::Lock)) {
+        result.locked = (record.value(DavPropertyRecord::Lock) == QStringLiteral("1") ? SyncFileItem::LockStatus::LockedItem : SyncFileItem::LockStatus::UnlockedItem);
+    }
+    if (record.contains(DavPropertyRecord::LockOwnerDisplayName)) {
+        result.lockOwnerDisplayName = record.value(DavPropertyRecord::LockOwnerDisplayName);
+    }
+    if (record.contains(DavPropertyRecord::LockOwner)) {
+        result.lockOwnerId = record.value(DavPropertyRecord::LockOwner);
+    }
+    if (record.contains(DavPropertyRecord::LockOwnerType)) {
+        auto ok = false;
+        const auto intConvertedValue = record.value(DavPropertyRecord::LockOwnerType).toULongLong(&ok);
+        if (ok) {
+            result.lockOwnerType = static_cast<SyncFileItem::LockOwnerType>(intConvertedValue);
+        } else {
+            result.lockOwnerType = SyncFileItem::LockOwnerType::UserLock;
         }
-        if (property == "lock-time") {
-            auto ok = false;
-            const auto intConvertedValue = value.toULongLong(&ok);
-            if (ok) {
-                result.lockTime = intConvertedValue;
-            } else {
-                result.lockTime = 0;
-            }
+    }
+    if (record.contains(DavPropertyRecord::LockOwnerEditor)) {
+        result.lockEditorApp = record.value(DavPropertyRecord::LockOwnerEditor);
+    }
+    if (record.contains(DavPropertyRecord::LockTime)) {
+        auto ok = false;
+        const auto intConvertedValue = record.value(DavPropertyRecord::LockTime).toULongLong(&ok);
+        if (ok) {
+            result.lockTime = intConvertedValue;
+        } else {
+            result.lockTime = 0;
         }
-        if (property == "lock-timeout") {
-            auto ok = false;
-            const auto intConvertedValue = value.toULongLong(&ok);
-            if (ok) {
-                result.lockTimeout = intConvertedValue;
-            } else {
-                result.lockTimeout = 0;
-            }
+    }
+    if (record.contains(DavPropertyRecord::LockTimeout)) {
+        auto ok = false;
+        const auto intConvertedValue = record.value(DavPropertyRecord::LockTimeout).toULongLong(&ok);
+        if (ok) {
+            result.lockTimeout = intConvertedValue;
+        } else {
+            result.lockTimeout = 0;
         }
-
     }
 
-    if (result.isDirectory && map.contains("size")) {
-        result.sizeOfFolder = map.value("size").toInt();
+    if (result.isDirectory && record.contains(DavPropertyRecord::Size)) {
+        result.sizeOfFolder = record.value(DavPropertyRecord::Size).toInt();
     }
 }
 
-void DiscoverySingleDirectoryJob::directoryListingIteratedSlot(const QString &file, const QMap<QString, QString> &map)
+void DiscoverySingleDirectoryJob::directoryListingIteratedSlot(const QString &file, const DavPropertyRecord &record)
 {
     if (!_ignoredFirst) {
         // The first entry is for the folder itself, we should process it differently.
         _ignoredFirst = true;
-        if (map.contains("permissions")) {
-            auto perm = RemotePermissions::fromServerString(map.value("permissions"));
+        if (record.contains(DavPropertyRecord::Permissions)) {
+            auto perm = RemotePermissions::fromServerString(record.value(DavPropertyRecord::Permissions));
             emit firstDirectoryPermissions(perm);
             _isExternalStorage = perm.hasPermission(RemotePermissions::IsMounted);
         }
-        if (map.contains("data-fingerprint")) {
-            _dataFingerprint = map.value("data-fingerprint").toUtf8();
+        if (record.contains(DavPropertyRecord::DataFingerprint)) {
+            _dataFingerprint = record.value(DavPropertyRecord::DataFingerprint).toUtf8();
             if (_dataFingerprint.isEmpty()) {
                 // Placeholder that means that the server supports the feature even if it did not set one.
                 _dataFingerprint = "[empty]";
             }
         }
-        if (map.contains(QStringLiteral("fileid"))) {
-            _localFileId = map.value(QStringLiteral("fileid")).toUtf8();
+        if (record.contains(DavPropertyRecord::FileId)) {
+            _localFileId = record.value(DavPropertyRecord::FileId).toUtf8();
         }
-        if (map.contains("id")) {
-            _fileId = map.value("id").toUtf8();
+        if (record.contains(DavPropertyRecord::Id)) {
+            _fileId = record.value(DavPropertyRecord::Id).toUtf8();
         }
-        if (map.contains("is-encrypted") && map.value("is-encrypted") == QStringLiteral("1")) {
+        if (record.value(DavPropertyRecord::IsEncrypted) == QStringLiteral("1")) {
             _isE2eEncrypted = SyncFileItem::EncryptionStatus::Encrypted;
             Q_ASSERT(!_fileId.isEmpty());
         }
-        if (map.contains("size")) {
-            _size = map.value("size").toInt();
+        if (record.contains(DavPropertyRecord::Size)) {
+            _size = record.value(DavPropertyRecord::Size).toInt();
         }
     } else {
 
@@ -567,7 +598,7 @@ void DiscoverySingleDirectoryJob::directoryListingIteratedSlot(const QString &fi
         int slash = file.lastIndexOf('/');
         result.name = file.mid(slash + 1);
         result.size = -1;
-        propertyMapToRemoteInfo(map, result);
+        propertyRecordToRemoteInfo(record, result);
         if (result.isDirectory)
             result.size = 0;
 
@@ -582,9 +613,9 @@ void DiscoverySingleDirectoryJob::directoryListingIteratedSlot(const QString &fi
     }
 
     //This works in concerto with the RequestEtagJob and the Folder object to check if the remote folder changed.
-    if (map.contains("getetag")) {
+    if (record.contains(DavPropertyRecord::GetEtag)) {
         if (_firstEtag.isEmpty()) {
-            _firstEtag = parseEtag(map.value(QStringLiteral("getetag")).toUtf8()); // for directory itself
+            _firstEtag = parseEtag(record.value(DavPropertyRecord::GetEtag).toUtf8()); // for directory itself
         }
     }
 }
@@ -157,7 +157,7 @@ signals:
     void finished(const OCC::HttpResult<QVector<OCC::RemoteInfo>> &result);
 
 private slots:
-    void directoryListingIteratedSlot(const QString &, const QMap<QString, QString> &);
+    void directoryListingIteratedSlot(const QString &, const OCC::DavPropertyRecord &);
     void lsJobFinishedWithoutErrorSlot();
     void lsJobFinishedWithErrorSlot(QNetworkReply *);
     void fetchE2eMetadata();
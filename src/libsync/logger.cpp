@@ -13,14 +13,17 @@
  */
 
 #include "logger.h"
+#include "logringbuffer.h"
 
 #include "config.h"
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QRegularExpression>
 #include <QStringList>
 #include <QtGlobal>
 #include <QTextCodec>
+#include <QtConcurrentRun>
 #include <qmetaobject.h>
 
 #include <iostream>
@@ -37,6 +40,9 @@ namespace {
 
 constexpr int CrashLogSize = 20;
 constexpr auto MaxLogLinesCount = 50000;
+constexpr auto LogQueueSize = 16384;
+constexpr auto WriterBatchSize = 512;
+constexpr auto WriterIdleMsec = 100;
 
 static bool compressLog(const QString &originalName, const QString &targetName)
 {
@@ -64,6 +70,53 @@ static bool compressLog(const QString &originalName, const QString &targetName)
 #endif
 }
 
+/* Runs on the maintenance pool after a rotation: compresses the previous log and
+ * removes logs that are expired or exceed the total size, oldest first. */
+static void maintainLogDir(const QString &logDirectory, const QString &currentLog, QString logToCompress, int expireHours, qint64 maxTotalSize)
+{
+    QDir dir(logDirectory);
+    const QStringList nameFilters = { QStringLiteral("*owncloud.log.*"), QStringLiteral("*nextcloud.log.*") };
+
+    // On a restart there is no previous log, compress the most recent one left behind
+    if (logToCompress.isEmpty()) {
+        auto files = dir.entryList(nameFilters, QDir::Files, QDir::Name);
+        files.removeAll(QFileInfo(currentLog).fileName());
+        if (!files.isEmpty() && !files.last().endsWith(QStringLiteral(".gz"))) {
+            logToCompress = dir.absoluteFilePath(files.last());
+        }
+    }
+    if (!logToCompress.isEmpty()) {
+        const QString compressedName = logToCompress + QStringLiteral(".gz");
+        if (compressLog(logToCompress, compressedName)) {
+            QFile::remove(logToCompress);
+        } else {
+            QFile::remove(compressedName);
+        }
+    }
+
+    const auto now = QDateTime::currentDateTime();
+    const auto currentLogPath = QFileInfo(currentLog).absoluteFilePath();
+    qint64 totalSize = 0;
+    bool sizeExceeded = false;
+    // Newest first: once the logs exceed the size limit, the file that did it and all older ones go
+    const auto files = dir.entryInfoList(nameFilters, QDir::Files, QDir::Time);
+    for (const auto &fileInfo : files) {
+        if (fileInfo.absoluteFilePath() == currentLogPath) {
+            totalSize += fileInfo.size();
+            continue;
+        }
+        if (expireHours > 0 && fileInfo.lastModified().addSecs(60 * 60 * expireHours) < now) {
+            QFile::remove(fileInfo.absoluteFilePath());
+            continue;
+        }
+        totalSize += fileInfo.size();
+        sizeExceeded = sizeExceeded || (maxTotalSize > 0 && totalSize > maxTotalSize);
+        if (sizeExceeded) {
+            QFile::remove(fileInfo.absoluteFilePath());
+        }
+    }
+}
+
 }
 
 namespace OCC {
@@ -80,6 +133,13 @@ Logger::Logger(QObject *parent)
     qSetMessagePattern(QStringLiteral("%{time yyyy-MM-dd hh:mm:ss:zzz} [ %{type} %{category} %{file}:%{line} "
                                       "]%{if-debug}\t[ %{function} ]%{endif}:\t%{message}"));
     _crashLog.resize(CrashLogSize);
+    _maintenancePool.setMaxThreadCount(1);
+    _queue = std::make_unique<LogRingBuffer>(LogQueueSize);
+    // Joining a thread from a static destructor can deadlock on Windows, stop the
+    // writer while the application object goes away instead
+    qAddPostRoutine([] {
+        Logger::instance()->stopWriter();
+    });
 #ifndef NO_MSG_HANDLER
     qInstallMessageHandler([](QtMsgType type, const QMessageLogContext &ctx, const QString &message) {
         Logger::instance()->doLog(type, ctx, message);
@@ -89,6 +149,7 @@ Logger::Logger(QObject *parent)
 
 Logger::~Logger()
 {
+    stopWriter();
     if (_logstream) {
         _logstream->flush();
     }
@@ -116,7 +177,6 @@ bool Logger::isLoggingToFile() const
 
 void Logger::doLog(QtMsgType type, const QMessageLogContext &ctx, const QString &message)
 {
-    static long long int linesCounter = 0;
     const auto &msg = qFormatLogMessage(type, ctx, message);
 #if defined(Q_OS_WIN) && defined(QT_DEBUG)
     // write logs to Output window of Visual Studio
@@ -142,26 +202,39 @@ void Logger::doLog(QtMsgType type, const QMessageLogContext &ctx, const QString
         OutputDebugString(msgW.c_str());
     }
 #endif
-    {
-        QMutexLocker lock(&_mutex);
 
-        if (linesCounter >= MaxLogLinesCount) {
-            linesCounter = 0;
-            if (_logstream) {
-                _logstream->flush();
+    // Debug and info lines go through the writer thread. When it can't keep up
+    // they are dropped rather than stalling the thread that logs them.
+    const auto isVerbose = type == QtDebugMsg || type == QtInfoMsg;
+    if (isVerbose && !_doFileFlush && _writerRunning.load(std::memory_order_acquire)) {
+        auto line = msg;
+        if (_queue->tryPush(line)) {
+            if (_writerSleeping.load(std::memory_order_relaxed) && _queue->approximateSize() > _queue->capacity() / 2) {
+                QMutexLocker lock(&_writerMutex);
+                _writerWakeup.wakeOne();
             }
-            closeNoLock();
-            enterNextLogFileNoLock();
+        } else {
+            _droppedLines.fetch_add(1, std::memory_order_relaxed);
+        }
+        // stopWriter() may have done its final drain after the check above,
+        // nobody would write what was queued or counted since then
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_writerRunning.load(std::memory_order_relaxed)) {
+            QMutexLocker lock(&_mutex);
+            drainQueueNoLock();
         }
-        ++linesCounter;
+        emit logWindowLog(msg);
+        return;
+    }
 
-        _crashLogIndex = (_crashLogIndex + 1) % CrashLogSize;
-        _crashLog[_crashLogIndex] = msg;
+    {
+        QMutexLocker lock(&_mutex);
 
-        if (_logstream) {
-            (*_logstream) << msg << "\n";
-            if (_doFileFlush)
-                _logstream->flush();
+        // Keep the order with what is still queued
+        drainQueueNoLock();
+        writeLineNoLock(msg);
+        if (_logstream && _doFileFlush) {
+            _logstream->flush();
         }
         if (type == QtFatalMsg) {
             closeNoLock();
@@ -174,6 +247,138 @@ void Logger::doLog(QtMsgType type, const QMessageLogContext &ctx, const QString
     emit logWindowLog(msg);
 }
 
+bool Logger::isRotationDueNoLock() const
+{
+    // Without a log dir there is no next file to go on with
+    return _linesCounter >= MaxLogLinesCount
+        || (_logMaxFileSize > 0 && _logFileSize >= _logMaxFileSize && !_logDirectory.isEmpty());
+}
+
+void Logger::rotateNoLock()
+{
+    _linesCounter = 0;
+    if (_logstream) {
+        _logstream->flush();
+    }
+    closeNoLock();
+    enterNextLogFileNoLock();
+}
+
+void Logger::writeLineNoLock(const QString &msg)
+{
+    // The writer thread takes care of rotating while it runs, so that logging
+    // threads never wait for a new file to be opened
+    if (isRotationDueNoLock() && (!_writerRunning.load(std::memory_order_acquire) || std::this_thread::get_id() == _writerThreadId)) {
+        rotateNoLock();
+    }
+    ++_linesCounter;
+    // Counts UTF-16 code units, close enough to bytes for log output
+    _logFileSize += msg.size() + 1;
+
+    _crashLogIndex = (_crashLogIndex + 1) % CrashLogSize;
+    _crashLog[_crashLogIndex] = msg;
+
+    if (_logstream) {
+        (*_logstream) << msg << "\n";
+    }
+}
+
+void Logger::drainQueueNoLock()
+{
+    QString line;
+    while (_queue->tryPop(line)) {
+        writeLineNoLock(line);
+    }
+    writeDroppedLinesNoLock();
+}
+
+void Logger::writeDroppedLinesNoLock()
+{
+    const auto droppedLines = _droppedLines.load(std::memory_order_relaxed);
+    if (droppedLines == _writtenDroppedLines) {
+        return;
+    }
+    const QMessageLogContext ctx(__FILE__, __LINE__, Q_FUNC_INFO, "nextcloud.sync.logger");
+    writeLineNoLock(qFormatLogMessage(QtWarningMsg, ctx,
+        QStringLiteral("%1 log lines were dropped because the log queue was full").arg(droppedLines - _writtenDroppedLines)));
+    _writtenDroppedLines = droppedLines;
+}
+
+void Logger::startWriterNoLock()
+{
+    if (_writer.joinable() || _writerStopped) {
+        return;
+    }
+    _writerRunning.store(true, std::memory_order_release);
+    _writer = std::thread([this] {
+        writerLoop();
+    });
+    _writerThreadId = _writer.get_id();
+}
+
+void Logger::stopWriter()
+{
+    {
+        QMutexLocker lock(&_mutex);
+        _writerStopped = true;
+    }
+    if (!_writer.joinable()) {
+        _maintenancePool.waitForDone();
+        return;
+    }
+    {
+        QMutexLocker lock(&_writerMutex);
+        _writerRunning.store(false, std::memory_order_seq_cst);
+        _writerWakeup.wakeOne();
+    }
+    _writer.join();
+
+    // Everything from now on is written synchronously. Pairs with the fence in
+    // doLog(): a line pushed too late for this drain is drained by its producer.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        QMutexLocker lock(&_mutex);
+        drainQueueNoLock();
+        if (_logstream) {
+            _logstream->flush();
+        }
+    }
+    _maintenancePool.waitForDone();
+}
+
+void Logger::writerLoop()
+{
+    QString line;
+    for (;;) {
+        auto written = 0;
+        {
+            QMutexLocker lock(&_mutex);
+            if (isRotationDueNoLock()) {
+                rotateNoLock();
+            }
+            while (written < WriterBatchSize && _queue->tryPop(line)) {
+                writeLineNoLock(line);
+                ++written;
+            }
+            writeDroppedLinesNoLock();
+            if (written > 0 && _logstream) {
+                _logstream->flush();
+            }
+        }
+        if (written == WriterBatchSize) {
+            continue;
+        }
+
+        QMutexLocker lock(&_writerMutex);
+        if (!_writerRunning.load(std::memory_order_acquire)) {
+            break;
+        }
+        _writerSleeping.store(true, std::memory_order_relaxed);
+        _writerWakeup.wait(&_writerMutex, WriterIdleMsec);
+        _writerSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
 void Logger::closeNoLock()
 {
     dumpCrashLog();
@@ -217,6 +422,18 @@ void Logger::setLogFlush(bool flush)
     _doFileFlush = flush;
 }
 
+void Logger::setLogMaxFileSize(qint64 bytes)
+{
+    QMutexLocker locker(&_mutex);
+    _logMaxFileSize = bytes;
+}
+
+void Logger::setLogMaxTotalSize(qint64 bytes)
+{
+    QMutexLocker locker(&_mutex);
+    _logMaxTotalSize = bytes;
+}
+
 void Logger::setLogDebug(bool debug)
 {
     const QSet<QString> rules = {debug ? QStringLiteral("nextcloud.*.debug=true") : QString()};
@@ -293,20 +510,13 @@ void Logger::enterNextLogFileNoLock()
         const auto cLocale = QLocale::c(); // Some system locales generate strings that are incompatible with filesystem
         QString newLogName = cLocale.toString(now, QStringLiteral("yyyyMMdd_HHmm")) + QStringLiteral("_nextcloud.log");
 
-        // Expire old log files and deal with conflicts
-        QStringList files = dir.entryList(QStringList("*owncloud.log.*"), QDir::Files, QDir::Name) +
-            dir.entryList(QStringList("*nextcloud.log.*"), QDir::Files, QDir::Name);
+        // Deal with conflicts, only the logs of the current minute are listed
+        const QStringList files = dir.entryList(QStringList(newLogName + QStringLiteral(".*")), QDir::Files, QDir::Name);
         static const QRegularExpression rx(QRegularExpression::anchoredPattern(R"(.*(next|own)cloud\.log\.(\d+).*)"));
         int maxNumber = -1;
-        foreach (const QString &s, files) {
-            if (_logExpire > 0) {
-                QFileInfo fileInfo(dir.absoluteFilePath(s));
-                if (fileInfo.lastModified().addSecs(60 * 60 * _logExpire) < now) {
-                    dir.remove(s);
-                }
-            }
+        for (const auto &s : files) {
             const auto rxMatch = rx.match(s);
-            if (s.startsWith(newLogName) && rxMatch.hasMatch()) {
+            if (rxMatch.hasMatch()) {
                 maxNumber = qMax(maxNumber, rxMatch.captured(2).toInt());
             }
         }
@@ -315,19 +525,8 @@ void Logger::enterNextLogFileNoLock()
         auto previousLog = _logFile.fileName();
         setLogFileNoLock(dir.filePath(newLogName));
 
-        // Compress the previous log file. On a restart this can be the most recent
-        // log file.
-        auto logToCompress = previousLog;
-        if (logToCompress.isEmpty() && files.size() > 0 && !files.last().endsWith(".gz"))
-            logToCompress = dir.absoluteFilePath(files.last());
-        if (!logToCompress.isEmpty()) {
-            QString compressedName = logToCompress + ".gz";
-            if (compressLog(logToCompress, compressedName)) {
-                QFile::remove(logToCompress);
-            } else {
-                QFile::remove(compressedName);
-            }
-        }
+        // Compress the previous log file and expire old ones without holding up logging
+        QtConcurrent::run(&_maintenancePool, maintainLogDir, _logDirectory, _logFile.fileName(), previousLog, _logExpire, _logMaxTotalSize);
     }
 }
 
@@ -360,6 +559,8 @@ void Logger::setLogFileNoLock(const QString &name)
 
     _logstream.reset(new QTextStream(&_logFile));
     _logstream->setCodec(QTextCodec::codecForName("UTF-8"));
+    _logFileSize = 0;
+    startWriterNoLock();
 }
 
 void Logger::enterNextLogFile()
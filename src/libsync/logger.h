@@ -20,15 +20,30 @@
 #include <QDateTime>
 #include <QFile>
 #include <QTextStream>
+#include <QThreadPool>
+#include <QWaitCondition>
 #include <qmutex.h>
 
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include "common/utility.h"
 #include "owncloudlib.h"
 
 namespace OCC {
 
+class LogRingBuffer;
+
 /**
  * @brief The Logger class
+ *
+ * While logging to a file, debug and info lines are queued and written by a
+ * dedicated writer thread in batches. When the queue is full they are dropped
+ * and counted instead of blocking the logging thread. Warnings and more severe
+ * messages, and everything in flush mode, are written synchronously after the
+ * queued lines.
+ *
  * @ingroup libsync
  */
 class OWNCLOUDSYNC_EXPORT Logger : public QObject
@@ -54,6 +69,15 @@ public:
 
     void setLogFlush(bool flush);
 
+    /** Rotate once the log file grows beyond this many bytes, 0 to rotate by line count only */
+    void setLogMaxFileSize(qint64 bytes);
+
+    /** Remove the oldest logs once all logs in the log dir take more than this many bytes, 0 for no limit */
+    void setLogMaxTotalSize(qint64 bytes);
+
+    /** Number of lines dropped because the write queue was full */
+    [[nodiscard]] quint64 droppedLines() const { return _droppedLines.load(std::memory_order_relaxed); }
+
     bool logDebug() const { return _logDebug; }
     void setLogDebug(bool debug);
 
@@ -98,6 +122,15 @@ private:
     void dumpCrashLog();
     void enterNextLogFileNoLock();
     void setLogFileNoLock(const QString &name);
+    [[nodiscard]] bool isRotationDueNoLock() const;
+    void rotateNoLock();
+    void writeLineNoLock(const QString &msg);
+    void drainQueueNoLock();
+    void writeDroppedLinesNoLock();
+
+    void startWriterNoLock();
+    void stopWriter();
+    void writerLoop();
 
     QFile _logFile;
     bool _doFileFlush = false;
@@ -110,6 +143,26 @@ private:
     QSet<QString> _logRules;
     QVector<QString> _crashLog;
     int _crashLogIndex = 0;
+    long long _linesCounter = 0;
+    qint64 _logFileSize = 0;
+    qint64 _logMaxFileSize = 0;
+    qint64 _logMaxTotalSize = 0;
+
+    // Compresses and expires rotated logs, one job at a time
+    QThreadPool _maintenancePool;
+
+    std::unique_ptr<LogRingBuffer> _queue;
+    std::thread _writer;
+    std::thread::id _writerThreadId;
+    std::atomic<bool> _writerRunning{false};
+    std::atomic<bool> _writerSleeping{false};
+    std::atomic<quint64> _droppedLines{0};
+    quint64 _writtenDroppedLines = 0;
+    bool _writerStopped = false;
+    QMutex _writerMutex;
+    QWaitCondition _writerWakeup;
+
+    friend class TestLogger;
 };
 
 } // namespace OCC
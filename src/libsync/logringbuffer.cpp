@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#include "logringbuffer.h"
+
+#include <QtGlobal>
+
+#include <cstddef>
+
+namespace OCC {
+
+LogRingBuffer::LogRingBuffer(int capacity)
+{
+    Q_ASSERT(capacity > 0);
+    size_t size = 1;
+    while (size < static_cast<size_t>(capacity)) {
+        size <<= 1;
+    }
+    _mask = size - 1;
+
+    _slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRingBuffer::~LogRingBuffer() = default;
+
+bool LogRingBuffer::tryPush(QString &line)
+{
+    auto position = _pushPosition.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+        slot = &_slots[position & _mask];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            // The slot is free for this position, claim it
+            if (_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The slot still holds the line from one round ago
+            return false;
+        } else {
+            position = _pushPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->line = std::move(line);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRingBuffer::tryPop(QString &line)
+{
+    auto position = _popPosition.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    for (;;) {
+        slot = &_slots[position & _mask];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+        if (difference == 0) {
+            if (_popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Not filled yet
+            return false;
+        } else {
+            position = _popPosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    line = std::move(slot->line);
+    slot->line = QString();
+    // Free the slot for the next round
+    slot->sequence.store(position + _mask + 1, std::memory_order_release);
+    return true;
+}
+
+int LogRingBuffer::approximateSize() const
+{
+    const auto pushPosition = _pushPosition.load(std::memory_order_relaxed);
+    const auto popPosition = _popPosition.load(std::memory_order_relaxed);
+    return pushPosition > popPosition ? static_cast<int>(qMin(pushPosition - popPosition, _mask + 1)) : 0;
+}
+
+}
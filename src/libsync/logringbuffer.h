@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026 by Nextcloud GmbH
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ */
+
+#pragma once
+
+#include "owncloudlib.h"
+
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+namespace OCC {
+
+/**
+ * @brief Bounded lock-free queue of log lines
+ *
+ * Any number of threads may push and pop concurrently, pushing never blocks
+ * and fails when the buffer is full. Each slot carries a sequence number that
+ * tells producers and consumers whether it is free or filled for their turn.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT LogRingBuffer
+{
+public:
+    /// capacity is rounded up to a power of two
+    explicit LogRingBuffer(int capacity);
+    ~LogRingBuffer();
+
+    /// Returns false if the buffer is full, line is left untouched then
+    bool tryPush(QString &line);
+
+    /// Returns false if the buffer is empty
+    bool tryPop(QString &line);
+
+    [[nodiscard]] int capacity() const { return static_cast<int>(_mask + 1); }
+
+    /// Number of lines in the buffer, may be outdated by the time it returns
+    [[nodiscard]] int approximateSize() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        QString line;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask = 0;
+
+    // On separate cache lines, producers and consumers don't contend on each other
+    alignas(64) std::atomic<size_t> _pushPosition{0};
+    alignas(64) std::atomic<size_t> _popPosition{0};
+};
+
+}
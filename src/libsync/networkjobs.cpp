@@ -31,6 +31,7 @@
 #include <QCoreApplication>
 #include <QJsonObject>
 #include <QLoggingCategory>
+#include <QMetaMethod>
 #ifndef TOKEN_AUTH_ONLY
 #include <QPainter>
 #include <QPainterPath>
@@ -182,134 +183,258 @@ bool MkColJob::finished()
 }
 
 /*********************************************************************************************/
-// supposed to read <D:collection> when pointing to <D:resourcetype><D:collection></D:resourcetype>..
-static QString readContentsAsString(QXmlStreamReader &reader)
-{
-    QString result;
-    int level = 0;
-    do {
-        QXmlStreamReader::TokenType type = reader.readNext();
-        if (type == QXmlStreamReader::StartElement) {
-            level++;
-            result += "<" + reader.name().toString() + ">";
-        } else if (type == QXmlStreamReader::Characters) {
-            result += reader.text();
-        } else if (type == QXmlStreamReader::EndElement) {
-            level--;
-            if (level < 0) {
-                break;
-            }
-            result += "</" + reader.name().toString() + ">";
-        }
 
-    } while (!reader.atEnd());
-    return result;
+DavPropertyRecord::Property DavPropertyRecord::propertyFromName(const QStringRef &name)
+{
+    // Keyed by views of the literals, looking up a QStringRef doesn't allocate
+    static const QHash<QStringView, Property> properties = {
+        { QStringView(u"resourcetype"), ResourceType },
+        { QStringView(u"getlastmodified"), GetLastModified },
+        { QStringView(u"getcontentlength"), GetContentLength },
+        { QStringView(u"getetag"), GetEtag },
+        { QStringView(u"size"), Size },
+        { QStringView(u"id"), Id },
+        { QStringView(u"fileid"), FileId },
+        { QStringView(u"downloadURL"), DownloadUrl },
+        { QStringView(u"dDC"), DDC },
+        { QStringView(u"permissions"), Permissions },
+        { QStringView(u"checksums"), Checksums },
+        { QStringView(u"data-fingerprint"), DataFingerprint },
+        { QStringView(u"share-types"), ShareTypes },
+        { QStringView(u"is-encrypted"), IsEncrypted },
+        { QStringView(u"lock"), Lock },
+        { QStringView(u"lock-owner-displayname"), LockOwnerDisplayName },
+        { QStringView(u"lock-owner"), LockOwner },
+        { QStringView(u"lock-owner-type"), LockOwnerType },
+        { QStringView(u"lock-owner-editor"), LockOwnerEditor },
+        { QStringView(u"lock-time"), LockTime },
+        { QStringView(u"lock-timeout"), LockTimeout },
+    };
+    return properties.value(QStringView(name), PropertyCount);
+}
+
+void DavPropertyRecord::clear()
+{
+    for (int i = 0; i < PropertyCount; ++i) {
+        if (contains(static_cast<Property>(i))) {
+            _values[i].clear();
+        }
+    }
+    _present = 0;
 }
 
+/*********************************************************************************************/
 
 LsColXMLParser::LsColXMLParser() = default;
 
 bool LsColXMLParser::parse(const QByteArray &xml, QHash<QString, ExtraFolderInfo> *fileInfo, const QString &expectedPath)
 {
-    // Parse DAV response
-    QXmlStreamReader reader(xml);
-    reader.addExtraNamespaceDeclaration(QXmlStreamNamespaceDeclaration("d", "DAV:"));
-
-    QStringList folders;
-    QString currentHref;
-    QMap<QString, QString> currentTmpProperties;
-    QMap<QString, QString> currentHttp200Properties;
-    bool currentPropsHaveHttp200 = false;
-    bool insidePropstat = false;
-    bool insideProp = false;
-    bool insideMultiStatus = false;
-
-    while (!reader.atEnd()) {
-        QXmlStreamReader::TokenType type = reader.readNext();
-        QString name = reader.name().toString();
-        // Start elements with DAV:
-        if (type == QXmlStreamReader::StartElement && reader.namespaceUri() == QLatin1String("DAV:")) {
-            if (name == QLatin1String("href")) {
-                // We don't use URL encoding in our request URL (which is the expected path) (QNAM will do it for us)
-                // but the result will have URL encoding..
-                QString hrefString = QUrl::fromLocalFile(QUrl::fromPercentEncoding(reader.readElementText().toUtf8()))
-                        .adjusted(QUrl::NormalizePathSegments)
-                        .path();
-                if (!hrefString.startsWith(expectedPath)) {
-                    qCWarning(lcLsColJob) << "Invalid href" << hrefString << "expected starting with" << expectedPath;
-                    return false;
+    start(fileInfo, expectedPath);
+    return addData(xml) && finish();
+}
+
+void LsColXMLParser::start(QHash<QString, ExtraFolderInfo> *fileInfo, const QString &expectedPath)
+{
+    _reader.clear();
+    _reader.addExtraNamespaceDeclaration(QXmlStreamNamespaceDeclaration("d", "DAV:"));
+    _fileInfo = fileInfo;
+    _expectedPath = expectedPath;
+
+    _folders.clear();
+    _currentHref.clear();
+    _currentTmpProperties.clear();
+    _currentHttp200Properties.clear();
+    _currentTmpRecord.clear();
+    _currentHttp200Record.clear();
+    _currentPropsHaveHttp200 = false;
+    _insidePropstat = false;
+    _insideProp = false;
+    _insideMultiStatus = false;
+    _failed = false;
+
+    _textTarget = TextTarget::None;
+    _textDepth = 0;
+    _text.clear();
+    _propertyName.clear();
+    _property = DavPropertyRecord::PropertyCount;
+}
+
+bool LsColXMLParser::addData(const QByteArray &data)
+{
+    if (_failed) {
+        return false;
+    }
+    _reader.addData(data);
+    _failed = !parseAvailableData();
+    return !_failed;
+}
+
+bool LsColXMLParser::finish()
+{
+    if (_failed) {
+        return false;
+    }
+    _failed = true;
+
+    if (_reader.hasError()) {
+        // XML Parser error? Whatever had been emitted before will come as directoryListingIterated
+        qCWarning(lcLsColJob) << "ERROR" << _reader.errorString() << "at line" << _reader.lineNumber();
+        return false;
+    } else if (!_insideMultiStatus) {
+        qCWarning(lcLsColJob) << "ERROR no WebDAV response?";
+        return false;
+    }
+
+    emit directoryListingSubfolders(_folders);
+    emit finishedWithoutError();
+    return true;
+}
+
+bool LsColXMLParser::parseAvailableData()
+{
+    while (!_reader.atEnd()) {
+        const auto type = _reader.readNext();
+
+        if (_textTarget != TextTarget::None) {
+            // Collect the content of href, status or a property. Nested elements of
+            // properties are kept as tags, e.g. <d:resourcetype><d:collection/></d:resourcetype>
+            // gives "<collection></collection>"
+            if (type == QXmlStreamReader::Characters) {
+                _text += _reader.text();
+            } else if (type == QXmlStreamReader::StartElement) {
+                ++_textDepth;
+                if (_textTarget == TextTarget::Property) {
+                    _text += "<" + _reader.name().toString() + ">";
                 }
-                currentHref = hrefString;
-            } else if (name == QLatin1String("response")) {
-            } else if (name == QLatin1String("propstat")) {
-                insidePropstat = true;
-            } else if (name == QLatin1String("status") && insidePropstat) {
-                QString httpStatus = reader.readElementText();
-                if (httpStatus.startsWith("HTTP/1.1 200")) {
-                    currentPropsHaveHttp200 = true;
-                } else {
-                    currentPropsHaveHttp200 = false;
+            } else if (type == QXmlStreamReader::EndElement) {
+                if (_textDepth == 0) {
+                    if (!endTextElement()) {
+                        return false;
+                    }
+                    continue;
+                }
+                --_textDepth;
+                if (_textTarget == TextTarget::Property) {
+                    _text += "</" + _reader.name().toString() + ">";
                 }
-            } else if (name == QLatin1String("prop")) {
-                insideProp = true;
-                continue;
-            } else if (name == QLatin1String("multistatus")) {
-                insideMultiStatus = true;
-                continue;
             }
+            continue;
         }
 
-        if (type == QXmlStreamReader::StartElement && insidePropstat && insideProp) {
-            // All those elements are properties
-            QString propertyContent = readContentsAsString(reader);
-            if (name == QLatin1String("resourcetype") && propertyContent.contains("collection")) {
-                folders.append(currentHref);
-            } else if (name == QLatin1String("size")) {
-                bool ok = false;
-                auto s = propertyContent.toLongLong(&ok);
-                if (ok && fileInfo) {
-                    (*fileInfo)[currentHref].size = s;
+        // Start elements with DAV:
+        if (type == QXmlStreamReader::StartElement) {
+            const auto name = _reader.name();
+            if (_reader.namespaceUri() == QLatin1String("DAV:")) {
+                if (name == QLatin1String("href")) {
+                    _textTarget = TextTarget::Href;
+                    continue;
+                } else if (name == QLatin1String("propstat")) {
+                    _insidePropstat = true;
+                } else if (name == QLatin1String("status") && _insidePropstat) {
+                    _textTarget = TextTarget::Status;
+                    continue;
+                } else if (name == QLatin1String("prop")) {
+                    _insideProp = true;
+                    continue;
+                } else if (name == QLatin1String("multistatus")) {
+                    _insideMultiStatus = true;
+                    continue;
                 }
-            } else if (name == QLatin1String("fileid")) {
-                (*fileInfo)[currentHref].fileId = propertyContent.toUtf8();
             }
-            currentTmpProperties.insert(reader.name().toString(), propertyContent);
+
+            if (_insidePropstat && _insideProp) {
+                // All those elements are properties
+                _textTarget = TextTarget::Property;
+                _property = DavPropertyRecord::propertyFromName(name);
+                if (_emitPropertyMaps) {
+                    _propertyName = name.toString();
+                }
+            }
+            continue;
         }
 
         // End elements with DAV:
-        if (type == QXmlStreamReader::EndElement) {
-            if (reader.namespaceUri() == QLatin1String("DAV:")) {
-                if (reader.name() == "response") {
-                    if (currentHref.endsWith('/')) {
-                        currentHref.chop(1);
-                    }
-                    emit directoryListingIterated(currentHref, currentHttp200Properties);
-                    currentHref.clear();
-                    currentHttp200Properties.clear();
-                } else if (reader.name() == "propstat") {
-                    insidePropstat = false;
-                    if (currentPropsHaveHttp200) {
-                        currentHttp200Properties = QMap<QString, QString>(currentTmpProperties);
-                    }
-                    currentTmpProperties.clear();
-                    currentPropsHaveHttp200 = false;
-                } else if (reader.name() == "prop") {
-                    insideProp = false;
+        if (type == QXmlStreamReader::EndElement && _reader.namespaceUri() == QLatin1String("DAV:")) {
+            if (_reader.name() == QLatin1String("response")) {
+                if (_currentHref.endsWith('/')) {
+                    _currentHref.chop(1);
                 }
+                if (_emitPropertyMaps) {
+                    emit directoryListingIterated(_currentHref, _currentHttp200Properties);
+                }
+                emit directoryListingRecordIterated(_currentHref, _currentHttp200Record);
+                _currentHref.clear();
+                _currentHttp200Properties.clear();
+                _currentHttp200Record.clear();
+            } else if (_reader.name() == QLatin1String("propstat")) {
+                _insidePropstat = false;
+                if (_currentPropsHaveHttp200) {
+                    _currentHttp200Properties = QMap<QString, QString>(_currentTmpProperties);
+                    _currentHttp200Record = std::move(_currentTmpRecord);
+                }
+                _currentTmpProperties.clear();
+                _currentTmpRecord.clear();
+                _currentPropsHaveHttp200 = false;
+            } else if (_reader.name() == QLatin1String("prop")) {
+                _insideProp = false;
             }
         }
     }
 
-    if (reader.hasError()) {
+    if (_reader.hasError() && _reader.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
         // XML Parser error? Whatever had been emitted before will come as directoryListingIterated
-        qCWarning(lcLsColJob) << "ERROR" << reader.errorString() << xml;
-        return false;
-    } else if (!insideMultiStatus) {
-        qCWarning(lcLsColJob) << "ERROR no WebDAV response?" << xml;
+        qCWarning(lcLsColJob) << "ERROR" << _reader.errorString() << "at line" << _reader.lineNumber();
         return false;
-    } else {
-        emit directoryListingSubfolders(folders);
-        emit finishedWithoutError();
+    }
+    // Either the document is complete or we need to wait for more data
+    return true;
+}
+
+bool LsColXMLParser::endTextElement()
+{
+    const auto target = _textTarget;
+    const QString text = std::move(_text);
+    _textTarget = TextTarget::None;
+    _text.clear();
+
+    switch (target) {
+    case TextTarget::Href: {
+        // We don't use URL encoding in our request URL (which is the expected path) (QNAM will do it for us)
+        // but the result will have URL encoding..
+        const auto hrefString = QUrl::fromLocalFile(QUrl::fromPercentEncoding(text.toUtf8()))
+                .adjusted(QUrl::NormalizePathSegments)
+                .path();
+        if (!hrefString.startsWith(_expectedPath)) {
+            qCWarning(lcLsColJob) << "Invalid href" << hrefString << "expected starting with" << _expectedPath;
+            return false;
+        }
+        _currentHref = hrefString;
+        break;
+    }
+    case TextTarget::Status:
+        _currentPropsHaveHttp200 = text.startsWith("HTTP/1.1 200");
+        break;
+    case TextTarget::Property:
+        if (_property == DavPropertyRecord::ResourceType && text.contains("collection")) {
+            _folders.append(_currentHref);
+        } else if (_property == DavPropertyRecord::Size) {
+            bool ok = false;
+            auto s = text.toLongLong(&ok);
+            if (ok && _fileInfo) {
+                (*_fileInfo)[_currentHref].size = s;
+            }
+        } else if (_property == DavPropertyRecord::FileId && _fileInfo) {
+            (*_fileInfo)[_currentHref].fileId = text.toUtf8();
+        }
+        if (_property != DavPropertyRecord::PropertyCount) {
+            _currentTmpRecord.setValue(_property, text);
+        }
+        if (_emitPropertyMaps) {
+            _currentTmpProperties.insert(_propertyName, text);
+        }
+        break;
+    case TextTarget::None:
+        break;
     }
     return true;
 }
@@ -319,12 +444,22 @@ bool LsColXMLParser::parse(const QByteArray &xml, QHash<QString, ExtraFolderInfo
 LsColJob::LsColJob(AccountPtr account, const QString &path, QObject *parent)
     : AbstractNetworkJob(account, path, parent)
 {
+    connect(&_parser, &LsColXMLParser::directoryListingSubfolders,
+        this, &LsColJob::directoryListingSubfolders);
+    connect(&_parser, &LsColXMLParser::directoryListingIterated,
+        this, &LsColJob::directoryListingIterated);
+    connect(&_parser, &LsColXMLParser::directoryListingRecordIterated,
+        this, &LsColJob::directoryListingRecordIterated);
+    connect(&_parser, &LsColXMLParser::finishedWithError,
+        this, &LsColJob::finishedWithError);
+    connect(&_parser, &LsColXMLParser::finishedWithoutError,
+        this, &LsColJob::finishedWithoutError);
 }
 
 LsColJob::LsColJob(AccountPtr account, const QUrl &url, QObject *parent)
-    : AbstractNetworkJob(account, QString(), parent)
-    , _url(url)
+    : LsColJob(account, QString(), parent)
 {
+    _url = url;
 }
 
 void LsColJob::setProperties(QList<QByteArray> properties)
@@ -377,34 +512,43 @@ void LsColJob::start()
     AbstractNetworkJob::start();
 }
 
-// TODO: Instead of doing all in this slot, we should iteratively parse in readyRead(). This
-// would allow us to be more asynchronous in processing while data is coming from the network,
-// not all in one big blob at the end.
-bool LsColJob::finished()
+static bool isMultiStatusReply(QNetworkReply *reply)
 {
-    qCInfo(lcLsColJob) << "LSCOL of" << reply()->request().url() << "FINISHED WITH STATUS"
-                       << replyStatusString();
-
-    const auto contentType = reply()->header(QNetworkRequest::ContentTypeHeader).toString();
-    const auto httpCode = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const auto contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+    const auto httpCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     const auto validContentType = contentType.contains("application/xml; charset=utf-8") ||
                                   contentType.contains("application/xml; charset=\"utf-8\"") ||
                                   contentType.contains("text/xml; charset=utf-8") ||
                                   contentType.contains("text/xml; charset=\"utf-8\"");
+    return httpCode == 207 && validContentType;
+}
+
+void LsColJob::newReplyHook(QNetworkReply *reply)
+{
+    // Only build the generic property maps if someone is interested in them
+    _parser.setEmitPropertyMaps(isSignalConnected(QMetaMethod::fromSignal(&LsColJob::directoryListingIterated)));
+    // Each (re)sent request gets a fresh document, the path is something like "/owncloud/remote.php/dav/folder"
+    _parser.start(&_folderInfos, reply->request().url().path());
+    connect(reply, &QNetworkReply::readyRead, this, &LsColJob::slotReadyRead);
+}
+
+void LsColJob::slotReadyRead()
+{
+    // Parse while the data is coming from the network instead of buffering the
+    // whole body, entries are emitted as soon as they are complete
+    if (reply() && sender() == reply() && isMultiStatusReply(reply())) {
+        _parser.addData(reply()->readAll());
+    }
+}
+
+bool LsColJob::finished()
+{
+    qCInfo(lcLsColJob) << "LSCOL of" << reply()->request().url() << "FINISHED WITH STATUS"
+                       << replyStatusString();
 
-    if (httpCode == 207 && validContentType) {
-        LsColXMLParser parser;
-        connect(&parser, &LsColXMLParser::directoryListingSubfolders,
-            this, &LsColJob::directoryListingSubfolders);
-        connect(&parser, &LsColXMLParser::directoryListingIterated,
-            this, &LsColJob::directoryListingIterated);
-        connect(&parser, &LsColXMLParser::finishedWithError,
-            this, &LsColJob::finishedWithError);
-        connect(&parser, &LsColXMLParser::finishedWithoutError,
-            this, &LsColJob::finishedWithoutError);
-
-        QString expectedPath = reply()->request().url().path(); // something like "/owncloud/remote.php/dav/folder"
-        if (!parser.parse(reply()->readAll(), &_folderInfos, expectedPath)) {
+    if (isMultiStatusReply(reply())) {
+        // Usually all of the body was already consumed in slotReadyRead()
+        if (!_parser.addData(reply()->readAll()) || !_parser.finish()) {
             // XML parse error
             emit finishedWithError(reply());
         }
@@ -17,6 +17,9 @@
 #define NETWORKJOBS_H
 
 #include <QBuffer>
+#include <QXmlStreamReader>
+
+#include <array>
 
 #include "abstractnetworkjob.h"
 
@@ -109,7 +112,71 @@ struct ExtraFolderInfo {
 };
 
 /**
- * @brief The LsColJob class
+ * @brief Typed properties of one PROPFIND entry
+ *
+ * The properties used by the discovery are interned as Property values, so
+ * filling and querying a record does not allocate or compare key strings.
+ * Like the property maps, properties are identified by their local name only.
+ *
+ * @ingroup libsync
+ */
+class OWNCLOUDSYNC_EXPORT DavPropertyRecord
+{
+public:
+    enum Property : quint8 {
+        ResourceType,
+        GetLastModified,
+        GetContentLength,
+        GetEtag,
+        Size,
+        Id,
+        FileId,
+        DownloadUrl,
+        DDC,
+        Permissions,
+        Checksums,
+        DataFingerprint,
+        ShareTypes,
+        IsEncrypted,
+        Lock,
+        LockOwnerDisplayName,
+        LockOwner,
+        LockOwnerType,
+        LockOwnerEditor,
+        LockTime,
+        LockTimeout,
+
+        PropertyCount // not a property
+    };
+
+    /** Returns the interned property for a property name, PropertyCount if it is not known */
+    static Property propertyFromName(const QStringRef &name);
+
+    [[nodiscard]] bool contains(Property property) const { return _present & (1u << property); }
+    [[nodiscard]] const QString &value(Property property) const { return _values[property]; }
+    void setValue(Property property, const QString &value)
+    {
+        _values[property] = value;
+        _present |= 1u << property;
+    }
+
+    [[nodiscard]] bool isEmpty() const { return _present == 0; }
+    void clear();
+
+private:
+    std::array<QString, PropertyCount> _values;
+    quint32 _present = 0;
+};
+
+/**
+ * @brief Parser for the multistatus reply of a PROPFIND
+ *
+ * The document can either be parsed in one go with parse() or fed
+ * incrementally with start(), addData() and finish(). In the incremental
+ * case directoryListingIterated() is emitted as soon as a <d:response>
+ * element is complete, so listings can be processed while the body is
+ * still arriving.
+ *
  * @ingroup libsync
  */
 class OWNCLOUDSYNC_EXPORT LsColXMLParser : public QObject
@@ -122,11 +189,71 @@ public:
                QHash<QString, ExtraFolderInfo> *sizes,
                const QString &expectedPath);
 
+    /** Resets the parser to receive a new document via addData(). */
+    void start(QHash<QString, ExtraFolderInfo> *sizes, const QString &expectedPath);
+
+    /** Parses the next chunk of the document.
+     *
+     * Returns false once the document is known to be invalid. Incomplete
+     * documents are not an error until finish() is called.
+     */
+    bool addData(const QByteArray &data);
+
+    /** Called once the whole document was added.
+     *
+     * Emits directoryListingSubfolders() and finishedWithoutError() and returns
+     * true if the document was a complete and valid multistatus reply.
+     */
+    bool finish();
+
+    /** Whether directoryListingIterated() is emitted with the generic property map.
+     *
+     * Defaults to true. Users that only need directoryListingRecordIterated()
+     * can disable it to avoid building a map for every entry.
+     */
+    void setEmitPropertyMaps(bool enabled) { _emitPropertyMaps = enabled; }
+
 signals:
     void directoryListingSubfolders(const QStringList &items);
     void directoryListingIterated(const QString &name, const QMap<QString, QString> &properties);
+    void directoryListingRecordIterated(const QString &name, const OCC::DavPropertyRecord &properties);
     void finishedWithError(QNetworkReply *reply);
     void finishedWithoutError();
+
+private:
+    enum class TextTarget {
+        None,
+        Href,
+        Status,
+        Property,
+    };
+
+    bool parseAvailableData();
+    bool endTextElement();
+
+    QXmlStreamReader _reader;
+    QHash<QString, ExtraFolderInfo> *_fileInfo = nullptr;
+    QString _expectedPath;
+
+    QStringList _folders;
+    QString _currentHref;
+    QMap<QString, QString> _currentTmpProperties;
+    QMap<QString, QString> _currentHttp200Properties;
+    DavPropertyRecord _currentTmpRecord;
+    DavPropertyRecord _currentHttp200Record;
+    bool _currentPropsHaveHttp200 = false;
+    bool _emitPropertyMaps = true;
+    bool _insidePropstat = false;
+    bool _insideProp = false;
+    bool _insideMultiStatus = false;
+    bool _failed = false;
+
+    // Content of the element currently being read, may span several chunks
+    TextTarget _textTarget = TextTarget::None;
+    int _textDepth = 0;
+    QString _text;
+    QString _propertyName;
+    DavPropertyRecord::Property _property = DavPropertyRecord::PropertyCount;
 };
 
 class OWNCLOUDSYNC_EXPORT LsColJob : public AbstractNetworkJob
@@ -152,15 +279,21 @@ public:
 signals:
     void directoryListingSubfolders(const QStringList &items);
     void directoryListingIterated(const QString &name, const QMap<QString, QString> &properties);
+    void directoryListingRecordIterated(const QString &name, const OCC::DavPropertyRecord &properties);
     void finishedWithError(QNetworkReply *reply);
     void finishedWithoutError();
 
+protected:
+    void newReplyHook(QNetworkReply *reply) override;
+
 private slots:
     bool finished() override;
+    void slotReadyRead();
 
 private:
     QList<QByteArray> _properties;
     QUrl _url; // Used instead of path() if the url is specified in the constructor
+    LsColXMLParser _parser;
 };
 
 /**
@@ -84,10 +84,11 @@ OwncloudPropagator::~OwncloudPropagator() = default;
 
 int OwncloudPropagator::maximumActiveTransferJob()
 {
-    if (_downloadLimit != 0
-        || _uploadLimit != 0
+    if (_downloadLimit < 0
+        || _uploadLimit < 0
         || !_syncOptions._parallelNetworkJobs) {
-        // disable parallelism when there is a network limit.
+        // disable parallelism when there is a relative network limit, it is measured
+        // on one transfer at a time. Absolute limits are shared by the BandwidthManager.
         return 1;
     }
     return qMin(3, qCeil(_syncOptions._parallelNetworkJobs / 2.));
@@ -229,6 +230,19 @@ void PropagateItemJob::done(const SyncFileItem::Status statusArg, const QString
 
     _item->_status = statusArg;
 
+    if (_traceStartUsec >= 0) {
+        SyncTrace::record(SyncTrace::Propagation, QString::fromLatin1(metaObject()->className()), _item->destination(),
+            _traceStartUsec, _item->_size, _item->_httpErrorCode);
+    }
+    if (_duration.isValid() && Metrics::isEnabled()) {
+        // Per job type, e.g. propagator.OCC::PropagateDownloadFile.bytes
+        const QByteArray prefix = QByteArrayLiteral("propagator.") + metaObject()->className();
+        Metrics::histogram(prefix + ".usec").record(_duration.nsecsElapsed() / 1000);
+        if (_item->_status == SyncFileItem::Success) {
+            Metrics::counter(prefix + ".bytes").add(_item->_size);
+        }
+    }
+
     if (_item->_isRestoration) {
         if (_item->_status == SyncFileItem::Success
             || _item->_status == SyncFileItem::Conflict) {
@@ -27,7 +27,9 @@
 
 #include "accountfwd.h"
 #include "bandwidthmanager.h"
+#include "common/metrics.h"
 #include "common/syncjournaldb.h"
+#include "common/synctrace.h"
 #include "common/utility.h"
 #include "csync.h"
 #include "progressdispatcher.h"
@@ -194,6 +196,8 @@ protected slots:
 private:
     QScopedPointer<PropagateItemJob> _restoreJob;
     JobParallelism _parallelism = FullParallelism;
+    qint64 _traceStartUsec = -1; // see SyncTrace
+    QElapsedTimer _duration; // see Metrics
 
 public:
     PropagateItemJob(OwncloudPropagator *propagator, const SyncFileItemPtr &item)
@@ -215,6 +219,12 @@ public:
         }
         qCInfo(lcPropagator) << "Starting" << _item->_instruction << "propagation of" << _item->destination() << "by" << this;
 
+        if (SyncTrace::isEnabled()) {
+            _traceStartUsec = SyncTrace::now();
+        }
+        if (Metrics::isEnabled()) {
+            _duration.start();
+        }
         _state = Running;
         QMetaObject::invokeMethod(this, "start"); // We could be in a different thread (neon jobs)
         return true;
@@ -409,6 +419,48 @@ public:
 
 class PropagateUploadFileCommon;
 
+/**
+ * @brief The jobs that currently use resources, see OwncloudPropagator::_activeJobList
+ *
+ * Keeps the "propagator.activeJobs" gauge up to date with every change.
+ *
+ * @ingroup libsync
+ */
+class ActiveJobList
+{
+public:
+    void append(PropagateItemJob *job)
+    {
+        _jobs.append(job);
+        updateGauge();
+    }
+    bool removeOne(PropagateItemJob *job)
+    {
+        const auto removed = _jobs.removeOne(job);
+        updateGauge();
+        return removed;
+    }
+    int removeAll(PropagateItemJob *job)
+    {
+        const auto removed = _jobs.removeAll(job);
+        updateGauge();
+        return removed;
+    }
+
+    [[nodiscard]] int count() const { return _jobs.count(); }
+    [[nodiscard]] int count(PropagateItemJob *job) const { return _jobs.count(job); }
+    [[nodiscard]] PropagateItemJob *at(int i) const { return _jobs.at(i); }
+
+private:
+    void updateGauge() const
+    {
+        static auto &activeJobs = Metrics::gauge("propagator.activeJobs");
+        activeJobs.set(_jobs.count());
+    }
+
+    QList<PropagateItemJob *> _jobs;
+};
+
 class OWNCLOUDSYNC_EXPORT OwncloudPropagator : public QObject
 {
     Q_OBJECT
@@ -460,7 +512,7 @@ public:
         Jobs add themself to the list when they do an asynchronous operation.
         Jobs can be several time on the list (example, when several chunks are uploaded in parallel)
      */
-    QList<PropagateItemJob *> _activeJobList;
+    ActiveJobList _activeJobList;
 
     /** We detected that another sync is required after this one */
     bool _anotherSyncNeeded = false;
@@ -85,6 +85,7 @@ GETFileJob::GETFileJob(AccountPtr account, const QString &path, QIODevice *devic
     , _bandwidthManager(nullptr)
     , _hasEmittedFinishedSignal(false)
     , _lastModified()
+    , _readBufferSize(minReadBufferSize)
     , _contentLength(-1)
 {
 }
@@ -106,6 +107,7 @@ GETFileJob::GETFileJob(AccountPtr account, const QUrl &url, QIODevice *device,
     , _bandwidthManager(nullptr)
     , _hasEmittedFinishedSignal(false)
     , _lastModified()
+    , _readBufferSize(minReadBufferSize)
     , _contentLength(-1)
 {
 }
@@ -145,7 +147,7 @@ void GETFileJob::start()
 
 void GETFileJob::newReplyHook(QNetworkReply *reply)
 {
-    reply->setReadBufferSize(16 * 1024); // keep low so we can easier limit the bandwidth
+    reply->setReadBufferSize(readBufferSize()); // bounded so we can limit the bandwidth
 
     connect(reply, &QNetworkReply::metaDataChanged, this, &GETFileJob::slotMetaDataChanged);
     connect(reply, &QIODevice::readyRead, this, &GETFileJob::slotReadyRead);
@@ -157,7 +159,7 @@ void GETFileJob::slotMetaDataChanged()
 {
     // For some reason setting the read buffer in GETFileJob::start doesn't seem to go
     // through the HTTP layer thread(?)
-    reply()->setReadBufferSize(16 * 1024);
+    reply()->setReadBufferSize(readBufferSize());
 
     int httpStatus = reply()->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
@@ -250,9 +252,60 @@ void GETFileJob::slotMetaDataChanged()
         _lastModified = Utility::qDateTimeToTime_t(lastModified.toDateTime());
     }
 
+    // Metadata may change again once the body is flowing, don't lose what was hashed
+    if (!_saveBodyToFile) {
+        startChecksumComputation();
+    }
+
     _saveBodyToFile = true;
 }
 
+void GETFileJob::setComputeChecksums(const QByteArray &contentChecksumType)
+{
+    _computeChecksums = true;
+    _contentChecksumType = contentChecksumType;
+}
+
+QByteArray GETFileJob::transmissionChecksumHeader() const
+{
+    if (!reply()) {
+        return {};
+    }
+    auto checksumHeader = findBestChecksum(reply()->rawHeader(checkSumHeaderC));
+    const auto contentMd5Header = reply()->rawHeader(contentMd5HeaderC);
+    if (checksumHeader.isEmpty() && !contentMd5Header.isEmpty()) {
+        checksumHeader = "MD5:" + contentMd5Header;
+    }
+    return checksumHeader;
+}
+
+QByteArray GETFileJob::computedChecksum(const QByteArray &checksumType) const
+{
+    const auto it = _checksumCalculators.find(checksumType);
+    if (it == _checksumCalculators.end()) {
+        return {};
+    }
+    return it->second->result();
+}
+
+void GETFileJob::startChecksumComputation()
+{
+    _checksumCalculators.clear();
+    if (!_computeChecksums || _resumeStart != 0) {
+        return;
+    }
+
+    for (const auto &checksumType : { parseChecksumHeaderType(transmissionChecksumHeader()), _contentChecksumType }) {
+        if (checksumType.isEmpty() || _checksumCalculators.count(checksumType)) {
+            continue;
+        }
+        auto calculator = std::make_unique<ChecksumCalculator>(checksumType);
+        if (calculator->isValid()) {
+            _checksumCalculators.emplace(checksumType, std::move(calculator));
+        }
+    }
+}
+
 void GETFileJob::setBandwidthManager(BandwidthManager *bwm)
 {
     _bandwidthManager = bwm;
@@ -267,9 +320,18 @@ void GETFileJob::setChoked(bool c)
 void GETFileJob::setBandwidthLimited(bool b)
 {
     _bandwidthLimited = b;
+    applyReadBufferSize();
     QMetaObject::invokeMethod(this, "slotReadyRead", Qt::QueuedConnection);
 }
 
+void GETFileJob::applyReadBufferSize()
+{
+    // Error replies are read at once, see slotMetaDataChanged()
+    if (reply() && _saveBodyToFile) {
+        reply()->setReadBufferSize(readBufferSize());
+    }
+}
+
 void GETFileJob::giveBandwidthQuota(qint64 q)
 {
     _bandwidthQuota = q;
@@ -287,15 +349,36 @@ qint64 GETFileJob::currentDownloadPosition()
 
 qint64 GETFileJob::writeToDevice(const QByteArray &data)
 {
-    return _device->write(data);
+    const auto written = _device->write(data);
+    if (written != data.size()) {
+        // The download fails, there is nothing to validate
+        _checksumCalculators.clear();
+    }
+    for (const auto &[checksumType, calculator] : _checksumCalculators) {
+        calculator->addData(data.constData(), written);
+    }
+    return written;
 }
 
 void GETFileJob::slotReadyRead()
 {
     if (!reply())
         return;
-    int bufferSize = qMin(1024 * 8ll, reply()->bytesAvailable());
-    QByteArray buffer(bufferSize, Qt::Uninitialized);
+
+    // A full read buffer means the network is faster than we are: take bigger bites,
+    // so that fast links don't cost a read, a write and a signal per few kilobytes.
+    if (_saveBodyToFile && !_bandwidthLimited && _readBufferSize < maxReadBufferSize
+        && reply()->bytesAvailable() >= _readBufferSize) {
+        _readBufferSize = qMin(_readBufferSize * 2, maxReadBufferSize);
+        qCDebug(lcGetJob) << "Read buffer size increased to" << _readBufferSize;
+        applyReadBufferSize();
+    }
+
+    const auto bufferSize = qMin(readBufferSize(), reply()->bytesAvailable());
+    if (_readBuffer.size() < bufferSize) {
+        _readBuffer.resize(static_cast<int>(bufferSize));
+    }
+    auto buffer = _readBuffer.data();
 
     while (reply()->bytesAvailable() > 0 && _saveBodyToFile) {
         if (_bandwidthChoked) {
@@ -309,10 +392,9 @@ void GETFileJob::slotReadyRead()
                 qCDebug(lcGetJob) << "Out of quota";
                 break;
             }
-            _bandwidthQuota -= toRead;
         }
 
-        const qint64 readBytes = reply()->read(buffer.data(), toRead);
+        const qint64 readBytes = reply()->read(buffer, toRead);
         if (readBytes < 0) {
             _errorString = networkReplyErrorString(*reply());
             _errorStatus = SyncFileItem::NormalError;
@@ -320,8 +402,11 @@ void GETFileJob::slotReadyRead()
             reply()->abort();
             return;
         }
+        if (_bandwidthLimited) {
+            _bandwidthQuota -= readBytes;
+        }
 
-        const qint64 writtenBytes = writeToDevice(QByteArray::fromRawData(buffer.constData(), readBytes));
+        const qint64 writtenBytes = writeToDevice(QByteArray::fromRawData(buffer, readBytes));
         if (writtenBytes != readBytes) {
             _errorString = _device->errorString();
             _errorStatus = SyncFileItem::NormalError;
@@ -405,43 +490,24 @@ qint64 GETEncryptedFileJob::writeToDevice(const QByteArray &data)
         return -1;
     }
 
-    const auto bytesRemaining = _contentLength - _processedSoFar - data.length();
-
-    if (bytesRemaining != 0 && bytesRemaining < OCC::Constants::e2EeTagSize) {
-        // decryption is going to fail if last chunk does not include or does not equal to OCC::Constants::e2EeTagSize bytes tag
-        // we may end up receiving packets beyond OCC::Constants::e2EeTagSize bytes tag at the end
-        // in that case, we don't want to try and decrypt less than OCC::Constants::e2EeTagSize ending bytes of tag, we will accumulate all the incoming data till the end
-        // and then, we are going to decrypt the entire chunk containing OCC::Constants::e2EeTagSize bytes at the end
-        _pendingBytes += QByteArray(data.constData(), data.length());
-        _processedSoFar += data.length();
-        if (_processedSoFar != _contentLength) {
-            return data.length();
-        }
+    // The decrypted data is never longer than the encrypted one: decrypt the whole
+    // read buffer into a reused buffer and write it to the device at once
+    if (_decryptedBuffer.size() < data.size()) {
+        _decryptedBuffer.resize(data.size());
     }
 
-    if (!_pendingBytes.isEmpty()) {
-        const auto decryptedChunk = _decryptor->chunkDecryption(_pendingBytes.constData(), _pendingBytes.size());
-
-        if (decryptedChunk.isEmpty()) {
-            qCCritical(lcPropagateDownload) << "Decryption failed!";
-            return -1;
-        }
-
-        GETFileJob::writeToDevice(decryptedChunk);
-
-        return data.length();
-    }
-
-    const auto decryptedChunk = _decryptor->chunkDecryption(data.constData(), data.length());
-
-    if (decryptedChunk.isEmpty()) {
+    const auto decryptedBytes = _decryptor->chunkDecryption(data.constData(), data.size(), _decryptedBuffer.data());
+    if (decryptedBytes < 0) {
         qCCritical(lcPropagateDownload) << "Decryption failed!";
         return -1;
     }
 
-    GETFileJob::writeToDevice(decryptedChunk);
-
-    _processedSoFar += data.length();
+    if (decryptedBytes > 0) {
+        const auto written = GETFileJob::writeToDevice(QByteArray::fromRawData(_decryptedBuffer.constData(), static_cast<int>(decryptedBytes)));
+        if (written != decryptedBytes) {
+            return -1;
+        }
+    }
 
     return data.length();
 }
@@ -734,6 +800,7 @@ void PropagateDownloadFile::startDownload()
             &_tmpFile, headers, expectedEtagForResume, _resumeStart, this);
     }
     _job->setBandwidthManager(&propagator()->_bandwidthManager);
+    _job->setComputeChecksums(propagator()->account()->capabilities().preferredUploadChecksumType());
     connect(_job.data(), &GETFileJob::finishedSignal, this, &PropagateDownloadFile::slotGetFinished);
     connect(_job.data(), &GETFileJob::downloadProgress, this, &PropagateDownloadFile::slotDownloadProgress);
     propagator()->_activeJobList.append(this);
@@ -928,11 +995,17 @@ void PropagateDownloadFile::slotGetFinished()
         this, &PropagateDownloadFile::transmissionChecksumValidated);
     connect(validator, &ValidateChecksumHeader::validationFailed,
         this, &PropagateDownloadFile::slotChecksumFail);
-    auto checksumHeader = findBestChecksum(job->reply()->rawHeader(checkSumHeaderC));
-    auto contentMd5Header = job->reply()->rawHeader(contentMd5HeaderC);
-    if (checksumHeader.isEmpty() && !contentMd5Header.isEmpty())
-        checksumHeader = "MD5:" + contentMd5Header;
-    validator->start(_tmpFile.fileName(), checksumHeader);
+    const auto checksumHeader = job->transmissionChecksumHeader();
+    _downloadedContentChecksum = job->computedChecksum(propagator()->account()->capabilities().preferredUploadChecksumType());
+
+    // Unless the download was resumed, the checksum was computed while writing the file
+    const auto checksumType = parseChecksumHeaderType(checksumHeader);
+    const auto checksum = job->computedChecksum(checksumType);
+    if (!checksumHeader.isEmpty() && !checksum.isEmpty()) {
+        validator->validate(checksumHeader, checksumType, checksum);
+    } else {
+        validator->start(_tmpFile.fileName(), checksumHeader);
+    }
 }
 
 void PropagateDownloadFile::slotChecksumFail(const QString &errMsg,
@@ -1097,6 +1170,10 @@ void PropagateDownloadFile::transmissionChecksumValidated(const QByteArray &chec
         return contentChecksumComputed(checksumType, checksum);
     }
 
+    if (!_downloadedContentChecksum.isEmpty()) {
+        return contentChecksumComputed(theContentChecksumType, _downloadedContentChecksum);
+    }
+
     // Compute the content checksum.
     auto computeChecksum = new ComputeChecksum(this);
     computeChecksum->setChecksumType(theContentChecksumType);
@@ -1337,7 +1414,7 @@ void PropagateDownloadFile::updateMetadata(bool isConflict)
         propagator()->_journal->setDownloadInfo(_item->_encryptedFileName, SyncJournalDb::DownloadInfo());
     }
 
-    propagator()->_journal->commit("download file start2");
+    propagator()->_journal->commitGrouped(QStringLiteral("download file start2"));
 
     done(isConflict ? SyncFileItem::Conflict : SyncFileItem::Success, {}, ErrorCategory::NoError);
 
@@ -18,10 +18,14 @@
 #include "networkjobs.h"
 #include "clientsideencryption.h"
 #include <common/checksums.h>
+#include <common/checksumcalculator.h>
 
 #include <QBuffer>
 #include <QFile>
 
+#include <map>
+#include <memory>
+
 namespace OCC {
 class PropagateDownloadEncrypted;
 
@@ -51,6 +55,18 @@ class OWNCLOUDSYNC_EXPORT GETFileJob : public AbstractNetworkJob
     /// Will be set to true once we've seen a 2xx response header
     bool _saveBodyToFile = false;
 
+    /** Size of the reply's read buffer and of the chunks read from it when not bandwidth limited.
+     *
+     * Grows while the network fills the buffer faster than it is written to the device.
+     */
+    qint64 _readBufferSize;
+    QByteArray _readBuffer;
+
+    bool _computeChecksums = false;
+    QByteArray _contentChecksumType;
+    /// Hash the body while it is written to the device, by checksum type
+    std::map<QByteArray, std::unique_ptr<ChecksumCalculator>> _checksumCalculators;
+
 protected:
     qint64 _contentLength;
 
@@ -95,6 +111,7 @@ public:
     void setChoked(bool c);
     void setBandwidthLimited(bool b);
     void giveBandwidthQuota(qint64 q);
+    [[nodiscard]] qint64 bandwidthQuota() const { return _bandwidthQuota; }
     qint64 currentDownloadPosition();
 
     [[nodiscard]] QString errorString() const override;
@@ -113,6 +130,29 @@ public:
     [[nodiscard]] qint64 expectedContentLength() const { return _expectedContentLength; }
     void setExpectedContentLength(qint64 size) { _expectedContentLength = size; }
 
+    /** Compute checksums of the body while it is written to the device
+     *
+     * Saves reading the file again afterwards. The type of transmissionChecksumHeader()
+     * is computed and contentChecksumType, if not empty. Nothing is computed for
+     * resumed downloads, the beginning of the data was written by an earlier job.
+     */
+    void setComputeChecksums(const QByteArray &contentChecksumType);
+
+    /// The checksum the server sent for the body, "TYPE:CHECKSUM" or empty
+    [[nodiscard]] QByteArray transmissionChecksumHeader() const;
+
+    /// Checksum of what was written to the device, empty if it wasn't computed
+    [[nodiscard]] QByteArray computedChecksum(const QByteArray &checksumType) const;
+
+    /// Read buffer size while bandwidth limited, kept small so the quota is followed closely
+    static constexpr qint64 limitedReadBufferSize = 16 * 1024;
+    /// Initial read buffer size without bandwidth limit
+    static constexpr qint64 minReadBufferSize = 64 * 1024;
+    /// Largest read buffer size without bandwidth limit
+    static constexpr qint64 maxReadBufferSize = 4 * 1024 * 1024;
+
+    [[nodiscard]] qint64 readBufferSize() const { return _bandwidthLimited ? limitedReadBufferSize : _readBufferSize; }
+
 protected:
     virtual qint64 writeToDevice(const QByteArray &data);
 
@@ -122,6 +162,10 @@ signals:
 private slots:
     void slotReadyRead();
     void slotMetaDataChanged();
+
+private:
+    void applyReadBufferSize();
+    void startChecksumComputation();
 };
 
 /**
@@ -148,8 +192,8 @@ protected:
 private:
     QSharedPointer<EncryptionHelper::StreamingDecryptor> _decryptor;
     EncryptedFile _encryptedFileInfo = {};
-    QByteArray _pendingBytes;
-    qint64 _processedSoFar = 0;
+    /// Reused for the decrypted data of each read buffer
+    QByteArray _decryptedBuffer;
 };
 
 /**
@@ -251,6 +295,8 @@ private:
     qint64 _downloadProgress = 0;
     QPointer<GETFileJob> _job;
     QFile _tmpFile;
+    /// Content checksum of _tmpFile computed by the GETFileJob, empty if it wasn't
+    QByteArray _downloadedContentChecksum;
     bool _deleteExisting = false;
     bool _isEncrypted = false;
     EncryptedFile _encryptedInfo;
@@ -305,7 +305,7 @@ void PropagateRemoteMove::finalize()
         }
     }
 
-    propagator()->_journal->commit("Remote Rename");
+    propagator()->_journal->commitGrouped(QStringLiteral("Remote Rename"));
     done(SyncFileItem::Success, {}, ErrorCategory::NoError);
 }
 
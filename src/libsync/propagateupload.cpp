@@ -24,6 +24,7 @@
 #include "filesystem.h"
 #include "propagatorjobs.h"
 #include "common/checksums.h"
+#include "common/constants.h"
 #include "syncengine.h"
 #include "deletejob.h"
 #include "common/asserts.h"
@@ -332,38 +333,91 @@ void PropagateUploadFileCommon::slotComputeContentChecksum()
     auto computeChecksum = new ComputeChecksum(this);
     computeChecksum->setChecksumType(checksumType);
 
-    connect(computeChecksum, &ComputeChecksum::done,
-        this, &PropagateUploadFileCommon::slotComputeTransmissionChecksum);
+    // If the transmission checksum is of another type, compute it in the same pass
+    const auto transmissionType = transmissionChecksumType(checksumType);
+    if (!transmissionType.isEmpty() && transmissionType != checksumType) {
+        computeChecksum->setAdditionalChecksumType(transmissionType);
+        connect(computeChecksum, &ComputeChecksum::done,
+            this, [this, computeChecksum, transmissionType](const QByteArray &contentChecksumType, const QByteArray &contentChecksum) {
+                _item->_checksumHeader = makeChecksumHeader(contentChecksumType, contentChecksum);
+                const auto transmissionChecksum = computeChecksum->additionalChecksum();
+                slotStartUpload(transmissionChecksum.isEmpty() ? QByteArray() : transmissionType, transmissionChecksum);
+            });
+    } else {
+        connect(computeChecksum, &ComputeChecksum::done,
+            this, &PropagateUploadFileCommon::slotComputeTransmissionChecksum);
+    }
     connect(computeChecksum, &ComputeChecksum::done,
         computeChecksum, &QObject::deleteLater);
+    startChecksum(computeChecksum);
+}
+
+void PropagateUploadFileCommon::startChecksum(ComputeChecksum *computeChecksum) const
+{
+    if (_uploadingEncrypted) {
+        // The checksums are of the ciphertext, the server never sees the plaintext
+        computeChecksum->start(QSharedPointer<QIODevice>(makeUploadDevice(0, _fileToUpload._size, nullptr).release()));
+        return;
+    }
     computeChecksum->start(_fileToUpload._path);
 }
 
-void PropagateUploadFileCommon::slotComputeTransmissionChecksum(const QByteArray &contentChecksumType, const QByteArray &contentChecksum)
+std::unique_ptr<UploadDevice> PropagateUploadFileCommon::makeUploadDevice(qint64 start, qint64 size, BandwidthManager *bandwidthManager) const
 {
-    _item->_checksumHeader = makeChecksumHeader(contentChecksumType, contentChecksum);
+    auto device = std::make_unique<UploadDevice>(_fileToUpload._path, start, size, bandwidthManager);
+    if (_uploadingEncrypted) {
+        const auto &encryptedFile = _uploadEncryptedHelper->encryptedFile();
+        device->setEncryption(encryptedFile.encryptionKey, encryptedFile.initializationVector, encryptedFile.authenticationTag);
+    }
+    return device;
+}
 
+bool PropagateUploadFileCommon::encryptedFileChanged() const
+{
+    if (!_uploadingEncrypted) {
+        return false;
+    }
+    return !FileSystem::verifyFileUnchanged(_fileToUpload._path,
+        _uploadEncryptedHelper->taggedFileSize(), _uploadEncryptedHelper->taggedFileModtime());
+}
+
+QByteArray PropagateUploadFileCommon::transmissionChecksumType(const QByteArray &contentChecksumType) const
+{
     // Reuse the content checksum as the transmission checksum if possible
     const auto supportedTransmissionChecksums =
         propagator()->account()->capabilities().supportedChecksumTypes();
     if (supportedTransmissionChecksums.contains(contentChecksumType)) {
+        return contentChecksumType;
+    }
+    if (!uploadChecksumEnabled()) {
+        return {};
+    }
+    return propagator()->account()->capabilities().uploadChecksumType();
+}
+
+void PropagateUploadFileCommon::slotComputeTransmissionChecksum(const QByteArray &contentChecksumType, const QByteArray &contentChecksum)
+{
+    _item->_checksumHeader = makeChecksumHeader(contentChecksumType, contentChecksum);
+
+    const auto checksumType = transmissionChecksumType(contentChecksumType);
+    if (checksumType.isEmpty()) {
+        slotStartUpload(QByteArray(), QByteArray());
+        return;
+    }
+    if (checksumType == contentChecksumType && !contentChecksum.isEmpty()) {
         slotStartUpload(contentChecksumType, contentChecksum);
         return;
     }
 
     // Compute the transmission checksum.
     auto computeChecksum = new ComputeChecksum(this);
-    if (uploadChecksumEnabled()) {
-        computeChecksum->setChecksumType(propagator()->account()->capabilities().uploadChecksumType());
-    } else {
-        computeChecksum->setChecksumType(QByteArray());
-    }
+    computeChecksum->setChecksumType(checksumType);
 
     connect(computeChecksum, &ComputeChecksum::done,
         this, &PropagateUploadFileCommon::slotStartUpload);
     connect(computeChecksum, &ComputeChecksum::done,
         computeChecksum, &QObject::deleteLater);
-    computeChecksum->start(_fileToUpload._path);
+    startChecksum(computeChecksum);
 }
 
 void PropagateUploadFileCommon::slotStartUpload(const QByteArray &transmissionChecksumType, const QByteArray &transmissionChecksum)
@@ -411,8 +465,17 @@ void PropagateUploadFileCommon::slotStartUpload(const QByteArray &transmissionCh
         qDebug() << "prevModtime" << prevModtime << "Curr" << _item->_modtime;
         return slotOnErrorStartFolderUnlock(SyncFileItem::SoftError, tr("Local file changed during syncing. It will be resumed."));
     }
+    if (encryptedFileChanged()) {
+        // The modtime above was taken after the tag was computed
+        propagator()->_anotherSyncNeeded = true;
+        return slotOnErrorStartFolderUnlock(SyncFileItem::SoftError, tr("Local file changed during syncing. It will be resumed."));
+    }
 
     _fileToUpload._size = FileSystem::getSize(fullFilePath);
+    if (_uploadingEncrypted) {
+        // The tag follows the ciphertext
+        _fileToUpload._size += OCC::Constants::e2EeTagSize;
+    }
     _item->_size = FileSystem::getSize(originalFilePath);
 
     // But skip the file if the mtime is too close to 'now'!
@@ -453,7 +516,9 @@ UploadDevice::UploadDevice(const QString &fileName, qint64 start, qint64 size, B
     , _size(size)
     , _bandwidthManager(bwm)
 {
-    _bandwidthManager->registerUploadDevice(this);
+    if (_bandwidthManager) {
+        _bandwidthManager->registerUploadDevice(this);
+    }
 }
 
 
@@ -464,23 +529,40 @@ UploadDevice::~UploadDevice()
     }
 }
 
+void UploadDevice::setEncryption(const QByteArray &key, const QByteArray &iv, const QByteArray &tag)
+{
+    Q_ASSERT(!isOpen());
+    _encryptor = std::make_unique<EncryptionHelper::StreamingEncryptor>(key, iv, tag);
+}
+
 bool UploadDevice::open(QIODevice::OpenMode mode)
 {
     if (mode & QIODevice::WriteOnly)
         return false;
 
+    if (_encryptor && !_encryptor->isInitialized()) {
+        setErrorString(tr("Could not set up the encryption of the file"));
+        return false;
+    }
+
     // Get the file size now: _file.fileName() is no longer reliable
     // on all platforms after openAndSeekFileSharedRead().
     auto fileDiskSize = FileSystem::getSize(_file.fileName());
+    _fileSize = fileDiskSize;
+    if (_encryptor) {
+        fileDiskSize += _encryptor->tag().size();
+    }
 
     QString openError;
-    if (!FileSystem::openAndSeekFileSharedRead(&_file, &openError, _start)) {
+    if (!FileSystem::openAndSeekFileSharedRead(&_file, &openError, qMin(_start, _fileSize))) {
         setErrorString(openError);
         return false;
     }
 
     _size = qBound(0ll, _size, fileDiskSize - _start);
     _read = 0;
+    _encryptedBuffer.clear();
+    _encryptedBufferPos = 0;
 
     return QIODevice::open(mode);
 }
@@ -521,15 +603,55 @@ qint64 UploadDevice::readData(char *data, qint64 maxlen)
         _bandwidthQuota -= maxlen;
     }
 
-    auto c = _file.read(data, maxlen);
+    auto c = _encryptor ? readEncrypted(data, maxlen) : _file.read(data, maxlen);
     if (c < 0) {
-        setErrorString(_file.errorString());
+        if (!_encryptor) {
+            setErrorString(_file.errorString());
+        }
         return -1;
     }
     _read += c;
     return c;
 }
 
+qint64 UploadDevice::readEncrypted(char *data, qint64 maxlen)
+{
+    // QNAM asks for small pieces, encrypt larger blocks at once
+    constexpr qint64 encryptedBufferSize = 1024 * 1024;
+
+    if (_encryptedBufferPos == _encryptedBuffer.size()) {
+        const auto position = _start + _read;
+        const auto bufferSize = qMin(encryptedBufferSize, _size - _read);
+        const auto fromFile = qBound(0ll, _fileSize - position, bufferSize);
+        _encryptedBuffer.resize(static_cast<int>(bufferSize));
+        _encryptedBufferPos = 0;
+
+        if (fromFile > 0) {
+            const auto bytesRead = _file.read(_encryptedBuffer.data(), fromFile);
+            if (bytesRead != fromFile) {
+                setErrorString(bytesRead < 0 ? _file.errorString() : tr("The file was truncated while reading it"));
+                _encryptedBuffer.clear();
+                return -1;
+            }
+            if (!_encryptor->encrypt(position, _encryptedBuffer.data(), fromFile)) {
+                setErrorString(tr("Could not encrypt the file"));
+                _encryptedBuffer.clear();
+                return -1;
+            }
+        }
+
+        // The tag follows the ciphertext
+        const auto tag = _encryptor->tag();
+        const auto tagStart = position + fromFile - _fileSize;
+        std::copy_n(tag.constData() + tagStart, bufferSize - fromFile, _encryptedBuffer.data() + fromFile);
+    }
+
+    const auto len = qMin(maxlen, static_cast<qint64>(_encryptedBuffer.size()) - _encryptedBufferPos);
+    std::copy_n(_encryptedBuffer.constData() + _encryptedBufferPos, len, data);
+    _encryptedBufferPos += len;
+    return len;
+}
+
 void UploadDevice::slotJobUploadProgress(qint64 sent, qint64 t)
 {
     if (sent == 0 || t == 0) {
@@ -568,7 +690,13 @@ bool UploadDevice::seek(qint64 pos)
         return false;
     }
     _read = pos;
-    _file.seek(_start + pos);
+    if (_encryptor) {
+        _file.seek(qMin(_start + pos, _fileSize));
+        _encryptedBuffer.clear();
+        _encryptedBufferPos = 0;
+    } else {
+        _file.seek(_start + pos);
+    }
     return true;
 }
 
@@ -817,7 +945,7 @@ void PropagateUploadFileCommon::finalize()
 
     // Remove from the progress database:
     propagator()->_journal->setUploadInfo(_item->_file, SyncJournalDb::UploadInfo());
-    propagator()->_journal->commit("upload file start");
+    propagator()->_journal->commitGrouped(QStringLiteral("upload file start"));
 
     if (_uploadingEncrypted) {
         _uploadStatus = { SyncFileItem::Success, QString() };
@@ -29,18 +29,30 @@ Q_DECLARE_LOGGING_CATEGORY(lcPropagateUploadV1)
 Q_DECLARE_LOGGING_CATEGORY(lcPropagateUploadNG)
 
 class BandwidthManager;
+class ComputeChecksum;
+
+namespace EncryptionHelper {
+class StreamingEncryptor;
+}
 
 /**
  * @brief The UploadDevice class
  * @ingroup libsync
  */
-class UploadDevice : public QIODevice
+class OWNCLOUDSYNC_EXPORT UploadDevice : public QIODevice
 {
     Q_OBJECT
 public:
+    /// bwm may be null for reads that are not uploads
     UploadDevice(const QString &fileName, qint64 start, qint64 size, BandwidthManager *bwm);
     ~UploadDevice() override;
 
+    /** Reads the AES-GCM ciphertext of the file followed by its tag instead of the file
+     *
+     * Then _start and _size refer to that data. Must be called before open().
+     */
+    void setEncryption(const QByteArray &key, const QByteArray &iv, const QByteArray &tag);
+
     bool open(QIODevice::OpenMode mode) override;
     void close() override;
 
@@ -57,6 +69,7 @@ public:
     void setChoked(bool);
     bool isChoked() { return _choked; }
     void giveBandwidthQuota(qint64 bwq);
+    [[nodiscard]] qint64 bandwidthQuota() const { return _bandwidthQuota; }
 
 signals:
 
@@ -71,6 +84,13 @@ private:
     /// Position between _start and _start+_size
     qint64 _read = 0;
 
+    // Encryption related
+    std::unique_ptr<EncryptionHelper::StreamingEncryptor> _encryptor;
+    qint64 _fileSize = 0; /// size of the plaintext file
+    QByteArray _encryptedBuffer; /// encrypted data from _start + _read on
+    qint64 _encryptedBufferPos = 0; /// how much of _encryptedBuffer was read already
+    [[nodiscard]] qint64 readEncrypted(char *data, qint64 maxlen);
+
     // Bandwidth manager related
     QPointer<BandwidthManager> _bandwidthManager;
     qint64 _bandwidthQuota = 0;
@@ -192,7 +212,7 @@ class PropagateUploadEncrypted;
  *   +--> slotComputeContentChecksum()  <---+
  *                   |
  *                   v
- *    slotComputeTransmissionChecksum()
+ *    slotComputeTransmissionChecksum()  (skipped when both are computed in one pass)
  *         |
  *         v
  *    slotStartUpload()  -> doStartUpload()
@@ -316,7 +336,24 @@ protected:
 
     /** Bases headers that need to be sent on the PUT, or in the MOVE for chunking-ng */
     QMap<QByteArray, QByteArray> headers();
+
+    /** A device for the given range of _fileToUpload, encrypted on the fly for encrypted folders */
+    [[nodiscard]] std::unique_ptr<UploadDevice> makeUploadDevice(qint64 start, qint64 size, BandwidthManager *bandwidthManager) const;
+
+    /** Whether the file of an encrypted upload differs from the one its tag was computed for
+     *
+     * The tag is in the metadata already, the upload can't be finished in that case.
+     */
+    [[nodiscard]] bool encryptedFileChanged() const;
+
+    [[nodiscard]] bool isUploadingEncrypted() const { return _uploadingEncrypted; }
 private:
+  // Computes the checksums of the data that is uploaded
+  void startChecksum(ComputeChecksum *computeChecksum) const;
+
+  /// The checksum type to send along with the data, empty for none
+  [[nodiscard]] QByteArray transmissionChecksumType(const QByteArray &contentChecksumType) const;
+
   PropagateUploadEncrypted *_uploadEncryptedHelper = nullptr;
   bool _uploadingEncrypted = false;
   UploadStatus _uploadStatus;
@@ -408,19 +445,30 @@ private:
         QString originalName;
     };
 
+    // A chunk PUT that is running
+    struct ChunkInFlight {
+        qint64 size = 0LL;
+        qint64 progress = 0LL; /// bytes of it sent so far
+    };
+
     [[nodiscard]] QUrl chunkUploadFolderUrl() const;
     [[nodiscard]] QUrl chunkUrl(const int chunk) const;
 
     void startNewUpload();
+    /// Starts chunks until the parallel chunk limit is reached, or finishes the upload when all are done
     void startNextChunk();
+    [[nodiscard]] bool startChunk();
     void finishUpload();
 
     QMap<qint64, ServerChunkInfo> _serverChunks;
 
-    qint64 _sent = 0; /// amount of data (bytes) that was already sent
+    // Chunks may complete out of order. On resume only the chunks without a hole
+    // before them are kept, see slotPropfindFinished().
+    QMap<int, ChunkInFlight> _chunksInFlight;
+
+    qint64 _sent = 0; /// amount of data (bytes) that was handed to chunk uploads, including the running ones
     uint _transferId = 0; /// transfer id (part of the url)
     int _currentChunk = 1; /// Id of the next chunk that will be sent
-    qint64 _currentChunkSize = 0; /// current chunk size
     bool _removeJobError = false; /// If not null, there was an error removing the job
 };
 }
@@ -3,6 +3,7 @@
 #include "networkjobs.h"
 #include "clientsideencryption.h"
 #include "account.h"
+#include "filesystem.h"
 
 #include <QFileInfo>
 #include <QDir>
@@ -179,13 +180,17 @@ void PropagateUploadEncrypted::slotFolderEncryptedMetadataReceived(const QJsonDo
       _completeFileName = encryptedFile.encryptedFilename;
   } else {
       QFile input(info.absoluteFilePath());
-      QFile output(QDir::tempPath() + QDir::separator() + encryptedFile.encryptedFilename);
+
+      // The metadata needs the tag before the upload, which encrypts the file again on the fly.
+      // Remember which version of the file the tag is for, the upload must not send another one.
+      _taggedFileModtime = FileSystem::getModTime(info.absoluteFilePath());
+      _taggedFileSize = FileSystem::getSize(info.absoluteFilePath());
 
       QByteArray tag;
       bool encryptionResult = EncryptionHelper::fileEncryption(
         encryptedFile.encryptionKey,
         encryptedFile.initializationVector,
-        &input, &output, tag);
+        &input, nullptr, tag);
 
       if (!encryptionResult) {
         qCDebug(lcPropagateUploadEncrypted()) << "There was an error encrypting the file, aborting upload.";
@@ -195,7 +200,7 @@ void PropagateUploadEncrypted::slotFolderEncryptedMetadataReceived(const QJsonDo
       }
 
       encryptedFile.authenticationTag = tag;
-      _completeFileName = output.fileName();
+      _completeFileName = info.absoluteFilePath();
   }
 
   qCDebug(lcPropagateUploadEncrypted) << "Creating the metadata for the encrypted file.";
@@ -229,12 +234,13 @@ void PropagateUploadEncrypted::slotUpdateMetadataSuccess(const QByteArray& fileI
     Q_UNUSED(fileId);
     qCDebug(lcPropagateUploadEncrypted) << "Uploading of the metadata success, Encrypting the file";
     QFileInfo outputInfo(_completeFileName);
+    const auto encryptedSize = outputInfo.isFile() ? outputInfo.size() + OCC::Constants::e2EeTagSize : outputInfo.size();
 
-    qCDebug(lcPropagateUploadEncrypted) << "Encrypted Info:" << outputInfo.path() << outputInfo.fileName() << outputInfo.size();
+    qCDebug(lcPropagateUploadEncrypted) << "Encrypted Info:" << outputInfo.path() << _encryptedFile.encryptedFilename << encryptedSize;
     qCDebug(lcPropagateUploadEncrypted) << "Finalizing the upload part, now the actual uploader will take over";
     emit finalized(outputInfo.path() + QLatin1Char('/') + outputInfo.fileName(),
-                   _remoteParentPath + QLatin1Char('/') + outputInfo.fileName(),
-                   outputInfo.size());
+                   _remoteParentPath + QLatin1Char('/') + _encryptedFile.encryptedFilename,
+                   encryptedSize);
 }
 
 void PropagateUploadEncrypted::slotUpdateMetadataError(const QByteArray& fileId, int httpErrorResponse)
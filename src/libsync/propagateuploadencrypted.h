@@ -22,6 +22,9 @@ class FolderMetadata;
  * client starts the upload request we don't know if the folder is
  * encrypted on the server.
  *
+ * The file is not encrypted into a copy: only its tag is computed here, the
+ * upload encrypts it again on the fly, see UploadDevice::setEncryption().
+ *
  * emits:
  * finalized() if the encrypted file is ready to be uploaded
  * error() if there was an error with the encryption
@@ -43,6 +46,11 @@ public:
     [[nodiscard]] bool isUnlockRunning() const { return _isUnlockRunning; }
     [[nodiscard]] bool isFolderLocked() const { return _isFolderLocked; }
     [[nodiscard]] const QByteArray folderToken() const { return _folderToken; }
+    [[nodiscard]] const EncryptedFile &encryptedFile() const { return _encryptedFile; }
+
+    /// The modification time and size of the file the tag was computed for
+    [[nodiscard]] time_t taggedFileModtime() const { return _taggedFileModtime; }
+    [[nodiscard]] qint64 taggedFileSize() const { return _taggedFileSize; }
 
 private slots:
     void slotFolderEncryptedIdReceived(const QStringList &list);
@@ -56,7 +64,8 @@ private slots:
     void slotUpdateMetadataError(const QByteArray& fileId, int httpReturnCode);
 
 signals:
-    // Emitted after the file is encrypted and everything is setup.
+    // Emitted after the tag is computed and everything is setup. path is the plaintext
+    // file, filename the remote one and size the one of the ciphertext with the tag.
     void finalized(const QString& path, const QString& filename, quint64 size);
     void error();
     void folderUnlocked(const QByteArray &folderId, int httpStatus);
@@ -80,6 +89,8 @@ private:
   QScopedPointer<FolderMetadata> _metadata;
   EncryptedFile _encryptedFile;
   QString _completeFileName;
+  time_t _taggedFileModtime = 0;
+  qint64 _taggedFileSize = 0;
 };
 
 
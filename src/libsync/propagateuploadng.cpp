@@ -94,7 +94,10 @@ void PropagateUploadFileNG::doStartUpload()
     if (_item->_modtime <= 0) {
         qCWarning(lcPropagateUpload()) << "invalid modified time" << _item->_file << _item->_modtime;
     }
-    if (progressInfo._valid && progressInfo.isChunked() && progressInfo._modtime == _item->_modtime && progressInfo._size == _item->_size) {
+    // Encrypted uploads get a new initialization vector on every attempt, the chunks
+    // of an earlier attempt can't be reused
+    if (progressInfo._valid && progressInfo.isChunked() && progressInfo._modtime == _item->_modtime && progressInfo._size == _item->_size
+        && !isUploadingEncrypted()) {
         _transferId = progressInfo._transferid;
 
         const auto job = new LsColJob(propagator()->account(), chunkUploadFolderUrl(), this);
@@ -249,6 +252,7 @@ void PropagateUploadFileNG::startNewUpload()
     _transferId = uint(Utility::rand() ^ uint(_item->_modtime) ^ (uint(_fileToUpload._size) << 16) ^ qHash(_fileToUpload._file));
     _sent = 0;
     _currentChunk = 1; // Chunked upload v2: numbers range from 1 to 10000
+    _chunksInFlight.clear();
 
     propagator()->reportProgress(*_item, 0);
 
@@ -299,6 +303,13 @@ void PropagateUploadFileNG::slotMkColFinished()
 void PropagateUploadFileNG::finishUpload()
 {
     Q_ASSERT(_jobs.isEmpty()); // There should be no running job anymore
+
+    if (encryptedFileChanged()) {
+        propagator()->_anotherSyncNeeded = true;
+        abortWithError(SyncFileItem::SoftError, tr("Local file changed during sync."));
+        return;
+    }
+
     _finished = true;
 
     // Finish with a MOVE
@@ -337,16 +348,33 @@ void PropagateUploadFileNG::startNextChunk()
 
     const auto fileSize = _fileToUpload._size;
     ENFORCE(fileSize >= _sent, "Sent data exceeds file size")
-    // prevent situation that chunk size is bigger then required one to send
-    _currentChunkSize = qMin(propagator()->_chunkSize, fileSize - _sent);
 
-    if (_currentChunkSize == 0) {
-        finishUpload();
+    if (_sent == fileSize) {
+        // Wait for the other chunks before assembling the file
+        if (_chunksInFlight.isEmpty()) {
+            finishUpload();
+        }
         return;
     }
 
+    const auto maxChunksInFlight = qMax(1, propagator()->syncOptions()._parallelChunkUploads);
+    // Additional chunks only take free transfer slots, like the chunking v1 parallel upload
+    while (_chunksInFlight.size() < maxChunksInFlight && _sent < fileSize
+        && (_chunksInFlight.isEmpty() || propagator()->_activeJobList.count() < propagator()->maximumActiveTransferJob())) {
+        if (!startChunk()) {
+            return;
+        }
+    }
+}
+
+bool PropagateUploadFileNG::startChunk()
+{
+    // prevent situation that chunk size is bigger then required one to send
+    const auto chunkSize = qMin(propagator()->_chunkSize, _fileToUpload._size - _sent);
+    Q_ASSERT(chunkSize > 0);
+
     const auto fileName = _fileToUpload._path;
-    auto device = std::make_unique<UploadDevice>(fileName, _sent, _currentChunkSize, &propagator()->_bandwidthManager);
+    auto device = makeUploadDevice(_sent, chunkSize, &propagator()->_bandwidthManager);
     if (!device->open(QIODevice::ReadOnly)) {
         qCWarning(lcPropagateUploadNG) << "Could not prepare upload device: " << device->errorString();
 
@@ -357,7 +385,7 @@ void PropagateUploadFileNG::startNextChunk()
         }
         // Soft error because this is likely caused by the user modifying his files while syncing
         abortWithError(SyncFileItem::SoftError, device->errorString());
-        return;
+        return false;
     }
 
     auto headers = PropagateUploadFileCommon::headers();
@@ -366,13 +394,14 @@ void PropagateUploadFileNG::startNextChunk()
     const auto destination = QDir::cleanPath(propagator()->account()->davUrl().path() + propagator()->fullRemotePath(_fileToUpload._file));
     headers["Destination"] = destination.toUtf8();
 
-    _sent += _currentChunkSize;
+    _sent += chunkSize;
     const auto url = chunkUrl(_currentChunk);
 
     // job takes ownership of device via a QScopedPointer. Job deletes itself when finishing
     const auto devicePtr = device.get(); // for connections later
     const auto job = new PUTFileJob(propagator()->account(), url, std::move(device), headers, _currentChunk, this);
     _jobs.append(job);
+    _chunksInFlight.insert(_currentChunk, { chunkSize, 0 });
     connect(job, &PUTFileJob::finishedSignal, this, &PropagateUploadFileNG::slotPutFinished);
     connect(job, &PUTFileJob::uploadProgress,
         this, &PropagateUploadFileNG::slotUploadProgress);
@@ -382,6 +411,7 @@ void PropagateUploadFileNG::startNextChunk()
     job->start();
     propagator()->_activeJobList.append(this);
     _currentChunk++;
+    return true;
 }
 
 void PropagateUploadFileNG::slotPutFinished()
@@ -393,6 +423,8 @@ void PropagateUploadFileNG::slotPutFinished()
 
     propagator()->_activeJobList.removeOne(this);
 
+    const auto chunkSize = _chunksInFlight.take(job->_chunk).size;
+
     if (_finished) {
         // We have sent the finished signal already. We don't need to handle any remaining jobs
         return;
@@ -416,7 +448,7 @@ void PropagateUploadFileNG::slotPutFinished()
     auto targetDuration = propagator()->syncOptions()._targetChunkUploadDuration;
     if (targetDuration.count() > 0) {
         auto uploadTime = ++job->msSinceStart(); // add one to avoid div-by-zero
-        qint64 predictedGoodSize = (_currentChunkSize * targetDuration) / uploadTime;
+        qint64 predictedGoodSize = (chunkSize * targetDuration) / uploadTime;
 
         // The whole targeting is heuristic. The predictedGoodSize will fluctuate
         // quite a bit because of external factors (like available bandwidth)
@@ -429,18 +461,18 @@ void PropagateUploadFileNG::slotPutFinished()
         // Adjust the dynamic chunk size _chunkSize used for sizing of the item's chunks to be send
         propagator()->_chunkSize = ::qBound(propagator()->syncOptions().minChunkSize(), targetSize, propagator()->syncOptions().maxChunkSize());
 
-        qCInfo(lcPropagateUploadNG) << "Chunked upload of" << _currentChunkSize << "bytes took" << uploadTime.count()
+        qCInfo(lcPropagateUploadNG) << "Chunked upload of" << chunkSize << "bytes took" << uploadTime.count()
                                   << "ms, desired is" << targetDuration.count() << "ms, expected good chunk size is"
                                   << predictedGoodSize << "bytes and nudged next chunk size to "
                                   << propagator()->_chunkSize << "bytes";
     }
 
-    _finished = _sent == _item->_size;
+    const auto allChunksSent = _sent == _item->_size && _chunksInFlight.isEmpty();
 
     // Check if the file still exists
     const QString fullFilePath(propagator()->fullLocalPath(_item->_file));
     if (!FileSystem::fileExists(fullFilePath)) {
-        if (!_finished) {
+        if (!allChunksSent) {
             abortWithError(SyncFileItem::SoftError, tr("The local file was removed during sync."));
             return;
         } else {
@@ -455,13 +487,13 @@ void PropagateUploadFileNG::slotPutFinished()
     }
     if (!FileSystem::verifyFileUnchanged(fullFilePath, _item->_size, _item->_modtime)) {
         propagator()->_anotherSyncNeeded = true;
-        if (!_finished) {
+        if (!allChunksSent) {
             abortWithError(SyncFileItem::SoftError, tr("Local file changed during sync."));
             return;
         }
     }
 
-    if (!_finished) {
+    if (!allChunksSent) {
         // Deletes an existing blacklist entry on successful chunk upload
         if (_item->_hasBlacklistEntry) {
             propagator()->_journal->wipeErrorBlacklistEntry(_item->_file);
@@ -540,7 +572,20 @@ void PropagateUploadFileNG::slotUploadProgress(qint64 sent, qint64 total)
     if (sent == 0 && total == 0) {
         return;
     }
-    propagator()->reportProgress(*_item, _sent + sent - total);
+    const auto job = qobject_cast<PUTFileJob *>(sender());
+    ASSERT(job);
+    const auto chunk = _chunksInFlight.find(job->_chunk);
+    if (chunk == _chunksInFlight.end()) {
+        return;
+    }
+    chunk->progress = sent;
+
+    // Everything handed out minus what the running chunks still have to send
+    auto pending = qint64(0);
+    for (const auto &chunkInFlight : qAsConst(_chunksInFlight)) {
+        pending += chunkInFlight.size - chunkInFlight.progress;
+    }
+    propagator()->reportProgress(*_item, _sent - pending);
 }
 
 void PropagateUploadFileNG::abort(PropagatorJob::AbortType abortType)
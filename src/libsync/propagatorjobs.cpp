@@ -133,7 +133,7 @@ void PropagateLocalRemove::start()
         done(SyncFileItem::NormalError, tr("Could not delete file record %1 from local DB").arg(_item->_originalFile), ErrorCategory::GenericError);
         return;
     }
-    propagator()->_journal->commit("Local remove");
+    propagator()->_journal->commitGrouped(QStringLiteral("Local remove"));
     done(SyncFileItem::Success, {}, ErrorCategory::NoError);
 }
 
@@ -203,7 +203,7 @@ void PropagateLocalMkdir::startLocalMkdir()
         done(SyncFileItem::SoftError, tr("The file %1 is currently in use").arg(newItem._file), ErrorCategory::GenericError);
         return;
     }
-    propagator()->_journal->commit("localMkdir");
+    propagator()->_journal->commitGrouped(QStringLiteral("localMkdir"));
 
     auto resultStatus = _item->_instruction == CSYNC_INSTRUCTION_CONFLICT
         ? SyncFileItem::Conflict
@@ -345,7 +345,7 @@ void PropagateLocalRename::start()
         return;
     }
 
-    propagator()->_journal->commit("localRename");
+    propagator()->_journal->commitGrouped(QStringLiteral("localRename"));
 
     done(SyncFileItem::Success, {}, ErrorCategory::NoError);
 }
@@ -16,9 +16,13 @@
 #include "creds/abstractcredentials.h"
 #include "account.h"
 
+#include <QJsonArray>
+#include <QJsonDocument>
+
 namespace {
 static constexpr int MAX_ALLOWED_FAILED_AUTHENTICATION_ATTEMPTS = 3;
 static constexpr int PING_INTERVAL = 30 * 1000;
+static constexpr char NOTIFY_FILE_ID_PREFIX[] = "notify_file_id ";
 }
 
 namespace OCC {
@@ -113,6 +117,8 @@ void PushNotifications::onWebSocketTextMessageReceived(const QString &message)
 
     if (message == "notify_file") {
         handleNotifyFile();
+    } else if (message.startsWith(QLatin1String(NOTIFY_FILE_ID_PREFIX))) {
+        handleNotifyFileId(message.mid(sizeof(NOTIFY_FILE_ID_PREFIX) - 1));
     } else if (message == "notify_activity") {
         handleNotifyActivity();
     } else if (message == "notify_notification") {
@@ -195,6 +201,11 @@ void PushNotifications::handleAuthenticated()
     _failedAuthenticationAttemptsCount = 0;
     _isReady = true;
     startPingTimer();
+
+    // Ask for the ids of the changed files, servers that don't know about
+    // it keep sending notify_file
+    _webSocket->sendTextMessage(QStringLiteral("listen notify_file_id"));
+
     emit ready();
 
     // We maybe reconnected to websocket while being offline for a
@@ -211,6 +222,32 @@ void PushNotifications::handleNotifyFile()
     emitFilesChanged();
 }
 
+void PushNotifications::handleNotifyFileId(const QString &fileIds)
+{
+    qCInfo(lcPushNotifications) << "Files push notification with file ids arrived";
+
+    // The ids come as a JSON array
+    const auto fileIdsArray = QJsonDocument::fromJson(fileIds.toUtf8()).array();
+    QVector<qint64> ids;
+    ids.reserve(fileIdsArray.size());
+    for (const auto &fileId : fileIdsArray) {
+        const auto id = fileId.toVariant().toLongLong();
+        if (id <= 0) {
+            ids.clear();
+            break;
+        }
+        ids.append(id);
+    }
+
+    if (ids.isEmpty()) {
+        qCWarning(lcPushNotifications) << "Could not parse the file ids" << fileIds;
+        emitFilesChanged();
+        return;
+    }
+
+    emit fileIdsChanged(_account, ids);
+}
+
 void PushNotifications::handleInvalidCredentials()
 {
     qCInfo(lcPushNotifications) << "Invalid credentials submitted to websocket";
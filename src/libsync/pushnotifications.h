@@ -16,6 +16,7 @@
 
 #include <QWebSocket>
 #include <QTimer>
+#include <QVector>
 
 #include "capabilities.h"
 
@@ -74,6 +75,13 @@ signals:
      */
     void filesChanged(OCC::Account *account);
 
+    /**
+     * Will be emitted if files with the given numeric ids changed on the server
+     *
+     * Emitted instead of filesChanged() if the server tells which files changed.
+     */
+    void fileIdsChanged(OCC::Account *account, const QVector<qint64> &fileIds);
+
     /**
      * Will be emitted if activities have been changed on the server
      */
@@ -120,6 +128,7 @@ private:
 
     void handleAuthenticated();
     void handleNotifyFile();
+    void handleNotifyFileId(const QString &fileIds);
     void handleInvalidCredentials();
     void handleNotifyNotification();
     void handleNotifyActivity();
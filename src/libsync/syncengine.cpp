@@ -22,6 +22,7 @@
 #include "discoveryphase.h"
 #include "creds/abstractcredentials.h"
 #include "common/syncfilestatus.h"
+#include "common/synctrace.h"
 #include "csync_exclude.h"
 #include "filesystem.h"
 #include "deletejob.h"
@@ -39,6 +40,7 @@
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <climits>
 #include <cassert>
 #include <chrono>
@@ -477,9 +479,8 @@ void OCC::SyncEngine::slotItemDiscovered(const OCC::SyncFileItemPtr &item)
     checkErrorBlacklisting(*item);
     _needsUpdate = true;
 
-    // Insert sorted
-    auto it = std::lower_bound( _syncItems.begin(), _syncItems.end(), item ); // the _syncItems is sorted
-    _syncItems.insert( it, item );
+    // Appended in discovery order, sorted once in slotDiscoveryFinished()
+    _syncItems.append(item);
 
     slotNewItem(item);
 
@@ -522,6 +523,15 @@ void SyncEngine::startSync()
     s_anySyncRunning = true;
     _syncRunning = true;
     _anotherSyncNeeded = NoFollowUpSync;
+
+    // started() only comes after discovery and only if there is something to do, the
+    // journal may have changed in between syncs though
+    _syncFileStatusTracker->slotClearPathInfoCache();
+
+    static const auto traceFile = qEnvironmentVariable("OWNCLOUD_SYNC_TRACE");
+    if (!traceFile.isEmpty() && !SyncTrace::isEnabled()) {
+        SyncTrace::setOutputFile(traceFile);
+    }
     _clearTouchedFilesTimer.stop();
 
     _hasNoneFiles = false;
@@ -718,6 +728,11 @@ void SyncEngine::startSync()
             _discoveryPhase.data()
         );
     } else {
+        // A full discovery looks at most of the journal: read it once instead of per directory
+        if (_syncOptions._useJournalSnapshot && !_journal->loadMetadataSnapshot()) {
+            qCWarning(lcEngine) << "Could not load the journal snapshot, discovery reads from the database";
+        }
+
         discoveryJob = new ProcessDirectoryJob(
             _discoveryPhase.data(),
             PinState::AlwaysLocal,
@@ -773,6 +788,14 @@ void SyncEngine::slotDiscoveryFinished()
 
     qCInfo(lcEngine) << "#### Discovery end #################################################### " << _stopWatch.addLapTime(QLatin1String("Discovery Finished")) << "ms";
 
+    _journal->releaseMetadataSnapshot();
+
+    // Sorting once is much cheaper than keeping the vector sorted on every insertion.
+    // Items that compare equal end up with the most recently discovered first, as
+    // they did with the previous sorted insertion.
+    std::reverse(_syncItems.begin(), _syncItems.end());
+    std::stable_sort(_syncItems.begin(), _syncItems.end());
+
     // Sanity check
     if (!_journal->open()) {
         qCWarning(lcEngine) << "Bailing out, DB failure";
@@ -880,6 +903,8 @@ void SyncEngine::slotDiscoveryFinished()
         if (_needsUpdate)
             Q_EMIT started();
 
+        // Completed items don't need a commit of their own, see SyncJournalDb::commitGrouped()
+        _journal->setGroupCommitEnabled(true);
         _propagator->start(std::move(_syncItems));
 
         qCInfo(lcEngine) << "#### Post-Reconcile end #################################################### " << _stopWatch.addLapTime(QStringLiteral("Post-Reconcile Finished")) << "ms";
@@ -961,6 +986,7 @@ void SyncEngine::slotPropagationFinished(bool success)
     caseClashConflictRecordMaintenance();
 
     _journal->deleteStaleFlagsEntries();
+    _journal->setGroupCommitEnabled(false);
     _journal->commit("All Finished.", false);
 
     // Send final progress information even if no
@@ -976,9 +1002,12 @@ void SyncEngine::slotPropagationFinished(bool success)
 void SyncEngine::finalize(bool success)
 {
     setSingleItemDiscoveryOptions({});
+    _journal->releaseMetadataSnapshot();
+    _journal->setGroupCommitEnabled(false);
 
     qCInfo(lcEngine) << "Sync run took " << _stopWatch.addLapTime(QLatin1String("Sync Finished")) << "ms";
     _stopWatch.stop();
+    SyncTrace::flush();
 
     if (_discoveryPhase) {
         _discoveryPhase.take()->deleteLater();
@@ -131,6 +131,41 @@ SyncFileStatus SyncFileStatusTracker::fileStatus(const QString &relativePath)
         return resolveSyncAndErrorStatus(QString(), NotShared);
     }
 
+    const auto info = pathInfo(relativePath);
+    if (info.excluded) {
+        return SyncFileStatus::StatusExcluded;
+    }
+
+    if (_dirtyPaths.contains(relativePath))
+        return SyncFileStatus::StatusSync;
+
+    // A path not in the database must be a new file, check if it's syncing or has an error.
+    return resolveSyncAndErrorStatus(relativePath, info.sharedState, info.isPathKnown);
+}
+
+QVector<SyncFileStatus> SyncFileStatusTracker::fileStatuses(const QStringList &relativePaths)
+{
+    QVector<SyncFileStatus> statuses;
+    statuses.reserve(relativePaths.size());
+    for (const auto &relativePath : relativePaths) {
+        statuses.append(fileStatus(relativePath));
+    }
+    return statuses;
+}
+
+SyncFileStatusTracker::PathInfo SyncFileStatusTracker::pathInfo(const QString &relativePath)
+{
+    if (_pathInfoIgnoreHiddenFiles != _syncEngine->ignoreHiddenFiles()) {
+        _pathInfoCache.clear();
+        _pathInfoIgnoreHiddenFiles = _syncEngine->ignoreHiddenFiles();
+    }
+
+    const auto it = _pathInfoCache.constFind(relativePath);
+    if (it != _pathInfoCache.cend()) {
+        return *it;
+    }
+
+    PathInfo info;
     // The SyncEngine won't notify us at all for CSYNC_FILE_SILENTLY_EXCLUDED
     // and CSYNC_FILE_EXCLUDE_AND_REMOVE excludes. Even though it's possible
     // that the status of CSYNC_FILE_EXCLUDE_LIST excludes will change if the user
@@ -139,23 +174,39 @@ SyncFileStatus SyncFileStatusTracker::fileStatus(const QString &relativePath)
     // it's an acceptable compromise to treat all exclude types the same.
     // Update: This extra check shouldn't hurt even though silently excluded files
     // are now available via slotAddSilentlyExcluded().
-    if (_syncEngine->excludedFiles().isExcluded(_syncEngine->localPath() + relativePath,
-            _syncEngine->localPath(),
-            _syncEngine->ignoreHiddenFiles())) {
-        return SyncFileStatus::StatusExcluded;
-    }
+    info.excluded = _syncEngine->excludedFiles().isExcluded(_syncEngine->localPath() + relativePath,
+        _syncEngine->localPath(),
+        _syncEngine->ignoreHiddenFiles());
 
-    if (_dirtyPaths.contains(relativePath))
-        return SyncFileStatus::StatusSync;
-
-    // First look it up in the database to know if it's shared
+    // Look it up in the database to know if it's shared
     SyncJournalFileRecord rec;
-    if (_syncEngine->journal()->getFileRecord(relativePath, &rec) && rec.isValid()) {
-        return resolveSyncAndErrorStatus(relativePath, rec._remotePerm.hasPermission(RemotePermissions::IsShared) ? Shared : NotShared);
+    if (!info.excluded && _syncEngine->journal()->getFileRecord(relativePath, &rec) && rec.isValid()) {
+        info.isPathKnown = PathKnown;
+        info.sharedState = rec._remotePerm.hasPermission(RemotePermissions::IsShared) ? Shared : NotShared;
     }
 
-    // Must be a new file not yet in the database, check if it's syncing or has an error.
-    return resolveSyncAndErrorStatus(relativePath, NotShared, PathUnknown);
+    // Browsing huge trees shouldn't grow the cache without bounds, starting over is cheap enough
+    if (_pathInfoCache.size() >= maxCachedPathInfos) {
+        _pathInfoCache.clear();
+    }
+    _pathInfoCache.insert(relativePath, info);
+    return info;
+}
+
+void SyncFileStatusTracker::invalidatePathInfo(const QString &relativePath, bool withChildren)
+{
+    _pathInfoCache.remove(relativePath);
+    if (!withChildren) {
+        return;
+    }
+    const auto prefix = QString(relativePath + QLatin1Char('/'));
+    for (auto it = _pathInfoCache.begin(); it != _pathInfoCache.end();) {
+        if (pathStartsWith(it.key(), prefix)) {
+            it = _pathInfoCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void SyncFileStatusTracker::slotPathTouched(const QString &fileName)
@@ -165,6 +216,7 @@ void SyncFileStatusTracker::slotPathTouched(const QString &fileName)
     ASSERT(fileName.startsWith(folderPath));
     QString localPath = fileName.mid(folderPath.size());
     _dirtyPaths.insert(localPath);
+    invalidatePathInfo(localPath);
 
     emit fileStatusChanged(fileName, SyncFileStatus::StatusSync);
 }
@@ -218,10 +270,18 @@ void SyncFileStatusTracker::decSyncCountAndEmitStatusChanged(const QString &rela
     }
 }
 
+void SyncFileStatusTracker::slotClearPathInfoCache()
+{
+    _pathInfoCache.clear();
+}
+
 void SyncFileStatusTracker::slotAboutToPropagate(SyncFileItemVector &items)
 {
     ASSERT(_syncCount.isEmpty());
 
+    // Discovery may have picked up new exclude files
+    _pathInfoCache.clear();
+
     ProblemsMap oldProblems;
     std::swap(_syncProblems, oldProblems);
 
@@ -273,6 +333,14 @@ void SyncFileStatusTracker::slotItemCompleted(const SyncFileItemPtr &item)
 {
     qCDebug(lcStatusTracker) << "Item completed" << item->destination() << item->_status << item->_instruction;
 
+    // The database changed for these paths. Moving or removing a directory affects its children.
+    const auto affectsChildren = item->isDirectory()
+        && (item->_instruction == CSYNC_INSTRUCTION_RENAME || item->_instruction == CSYNC_INSTRUCTION_REMOVE);
+    invalidatePathInfo(item->destination(), affectsChildren);
+    if (item->_file != item->destination()) {
+        invalidatePathInfo(item->_file, affectsChildren);
+    }
+
     if (hasErrorStatus(*item)) {
         _syncProblems[item->destination()] = SyncFileStatus::StatusError;
         invalidateParentPaths(item->destination());
@@ -311,6 +379,7 @@ void SyncFileStatusTracker::slotSyncFinished()
 
 void SyncFileStatusTracker::slotSyncEngineRunningChanged()
 {
+    _pathInfoCache.clear();
     emit fileStatusChanged(getSystemDestination(QString()), resolveSyncAndErrorStatus(QString(), NotShared));
 }
 
@@ -37,11 +37,15 @@ class OWNCLOUDSYNC_EXPORT SyncFileStatusTracker : public QObject
 public:
     explicit SyncFileStatusTracker(SyncEngine *syncEngine);
     SyncFileStatus fileStatus(const QString &relativePath);
+    // Statuses of several paths in the order given, for the batched requests of the shell integration
+    QVector<SyncFileStatus> fileStatuses(const QStringList &relativePaths);
 
 public slots:
     void slotPathTouched(const QString &fileName);
     // path relative to folder
     void slotAddSilentlyExcluded(const QString &folderPath);
+    // For journal updates outside of a sync, like share and lock states
+    void slotClearPathInfoCache();
 
 signals:
     void fileStatusChanged(const QString &systemFileName, OCC::SyncFileStatus fileStatus);
@@ -66,6 +70,16 @@ private:
         PathKnown };
     SyncFileStatus resolveSyncAndErrorStatus(const QString &relativePath, SharedFlag sharedState, PathKnownFlag isPathKnown = PathKnown);
 
+    // What fileStatus() needs from the exclude list and the database, which is
+    // too slow to look up on every request of the shell integration
+    struct PathInfo {
+        bool excluded = false;
+        PathKnownFlag isPathKnown = PathUnknown;
+        SharedFlag sharedState = NotShared;
+    };
+    PathInfo pathInfo(const QString &relativePath);
+    void invalidatePathInfo(const QString &relativePath, bool withChildren = false);
+
     void invalidateParentPaths(const QString &path);
     QString getSystemDestination(const QString &relativePath);
     void incSyncCountAndEmitStatusChanged(const QString &relativePath, SharedFlag sharedState);
@@ -79,6 +93,13 @@ private:
     // We'll show a file/directory as SYNC as long as its sync count is > 0.
     // A directory that starts/ends propagation will in turn increase/decrease its own parent by 1.
     QHash<QString, int> _syncCount;
+
+    // Cleared when a sync starts or finishes, before propagation and after journal updates
+    // outside of a sync, entries of changed paths are dropped as items complete or the
+    // watcher reports them.
+    QHash<QString, PathInfo> _pathInfoCache;
+    bool _pathInfoIgnoreHiddenFiles = false;
+    static constexpr int maxCachedPathInfos = 100000;
 };
 }
 
@@ -67,6 +67,14 @@ void SyncOptions::fillFromEnvironmentVariables()
     int maxParallel = qgetenv("OWNCLOUD_MAX_PARALLEL").toInt();
     if (maxParallel > 0)
         _parallelNetworkJobs = maxParallel;
+
+    int parallelChunkUploads = qgetenv("OWNCLOUD_PARALLEL_CHUNK_UPLOADS").toInt();
+    if (parallelChunkUploads > 0)
+        _parallelChunkUploads = parallelChunkUploads;
+
+    QByteArray journalSnapshotEnv = qgetenv("OWNCLOUD_JOURNAL_SNAPSHOT");
+    if (!journalSnapshotEnv.isEmpty())
+        _useJournalSnapshot = journalSnapshotEnv == "1";
 }
 
 void SyncOptions::verifyChunkSizes()
@@ -66,6 +66,21 @@ public:
     /** The maximum number of active jobs in parallel  */
     int _parallelNetworkJobs = 6;
 
+    /** The maximum number of chunk PUTs of a single file in parallel (chunking NG)
+     *
+     * Chunks may complete out of order; the resume logic only keeps the
+     * chunks on the server up to the first missing one.
+     */
+    int _parallelChunkUploads = 1;
+
+    /** Whether discovery reads the journal from an in-memory snapshot
+     *
+     * Trades memory (a compact copy of the metadata table) for not querying
+     * SQLite for every directory and file. Off by default, see
+     * SyncJournalDb::loadMetadataSnapshot().
+     */
+    bool _useJournalSnapshot = false;
+
     static constexpr auto chunkV2MinChunkSize = 5LL * 1000LL * 1000LL; // 5 MB
     static constexpr auto chunkV2MaxChunkSize = 5LL * 1000LL * 1000LL * 1000LL; // 5 GB
 
@@ -80,7 +95,8 @@ public:
     /** Reads settings from env vars where available.
      *
      * Currently reads _initialChunkSize, _minChunkSize, _maxChunkSize,
-     * _targetChunkUploadDuration, _parallelNetworkJobs.
+     * _targetChunkUploadDuration, _parallelNetworkJobs, _parallelChunkUploads,
+     * _useJournalSnapshot.
      */
     void fillFromEnvironmentVariables();
 
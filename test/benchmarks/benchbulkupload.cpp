@@ -0,0 +1,54 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+
+#include <QElapsedTimer>
+
+using namespace OCC;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int numFiles = argc > 1 ? QByteArray(argv[1]).toInt() : 50000;
+    const int fileSize = argc > 2 ? QByteArray(argv[2]).toInt() : 100;
+    const int filesPerDir = 100;
+
+    FakeFolder fakeFolder{ FileInfo{} };
+    fakeFolder.syncEngine().account()->setCapabilities({ { "dav", QVariantMap{ { "bulkupload", "1.0" } } } });
+    for (int fileNum = 0; fileNum < numFiles; ++fileNum) {
+        const auto dir = QStringLiteral("dir%1").arg(fileNum / filesPerDir);
+        if (fileNum % filesPerDir == 0) {
+            fakeFolder.localModifier().mkdir(dir);
+        }
+        fakeFolder.localModifier().insert(QStringLiteral("%1/file%2.txt").arg(dir).arg(fileNum), fileSize);
+    }
+
+    int nPOST = 0;
+    int nPUT = 0;
+    fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &, QIODevice *) -> QNetworkReply * {
+        if (op == QNetworkAccessManager::PostOperation) {
+            ++nPOST;
+        } else if (op == QNetworkAccessManager::PutOperation) {
+            ++nPUT;
+        }
+        return nullptr;
+    });
+
+    qDebug() << "NUMFILES" << numFiles << "FILESIZE" << fileSize;
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool result = fakeFolder.syncOnce();
+    const auto elapsedMsec = qMax(timer.elapsed(), qint64(1));
+    qDebug() << "UPLOAD:" << result << numFiles << "files in" << elapsedMsec << "ms,"
+             << numFiles * 1000 / elapsedMsec << "files/s," << nPOST << "bulk uploads," << nPUT << "single uploads";
+
+    return result && fakeFolder.currentLocalState() == fakeFolder.currentRemoteState() ? 0 : -1;
+}
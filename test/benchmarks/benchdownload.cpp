@@ -0,0 +1,129 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+
+#include <QElapsedTimer>
+
+using namespace OCC;
+
+static int readyReadCount = 0;
+
+/* Delivers the body like a fast network would: whatever fits into the read buffer
+ * of the reply per event loop iteration, instead of everything at once. */
+class StreamingGetReply : public FakeReply
+{
+    Q_OBJECT
+public:
+    StreamingGetReply(FileInfo &remoteRootFileInfo, QNetworkAccessManager::Operation op, const QNetworkRequest &request, QObject *parent)
+        : FakeReply { parent }
+    {
+        setRequest(request);
+        setUrl(request.url());
+        setOperation(op);
+        open(QIODevice::ReadOnly);
+
+        _fileInfo = remoteRootFileInfo.find(getFilePathFromUrl(request.url()));
+        Q_ASSERT(_fileInfo);
+        QMetaObject::invokeMethod(this, &StreamingGetReply::respond, Qt::QueuedConnection);
+    }
+
+    void respond()
+    {
+        _payload = _fileInfo->contentChar;
+        _remaining = _fileInfo->size;
+        setHeader(QNetworkRequest::ContentLengthHeader, _remaining);
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+        setRawHeader("OC-ETag", _fileInfo->etag);
+        setRawHeader("ETag", _fileInfo->etag);
+        setRawHeader("OC-FileId", _fileInfo->fileId);
+        emit metaDataChanged();
+        deliver();
+    }
+
+    void deliver()
+    {
+        if (_aborted) {
+            emit finished();
+            return;
+        }
+        // A read buffer size of 0 means unlimited
+        const auto room = readBufferSize() > 0 ? readBufferSize() - _buffered : _remaining;
+        const auto chunk = qBound(qint64(0), room, _remaining);
+        _remaining -= chunk;
+        _buffered += chunk;
+        if (chunk > 0) {
+            ++readyReadCount;
+            emit readyRead();
+        }
+        if (_remaining == 0) {
+            emit finished();
+            return;
+        }
+        QMetaObject::invokeMethod(this, &StreamingGetReply::deliver, Qt::QueuedConnection);
+    }
+
+    void abort() override
+    {
+        setError(OperationCanceledError, QStringLiteral("Operation Canceled"));
+        _aborted = true;
+    }
+
+    [[nodiscard]] qint64 bytesAvailable() const override
+    {
+        return _aborted ? 0 : _buffered + QIODevice::bytesAvailable();
+    }
+
+    qint64 readData(char *data, qint64 maxlen) override
+    {
+        const auto len = std::min(_buffered, maxlen);
+        std::fill_n(data, len, _payload);
+        _buffered -= len;
+        return len;
+    }
+
+private:
+    const FileInfo *_fileInfo = nullptr;
+    char _payload = 0;
+    qint64 _remaining = 0;
+    qint64 _buffered = 0;
+    bool _aborted = false;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int numFiles = argc > 1 ? QByteArray(argv[1]).toInt() : 4;
+    const qint64 fileSize = (argc > 2 ? QByteArray(argv[2]).toLongLong() : 50) * 1000 * 1000;
+
+    FakeFolder fakeFolder{ FileInfo{} };
+    for (int i = 0; i < numFiles; ++i) {
+        fakeFolder.remoteModifier().insert(QStringLiteral("file%1").arg(i), fileSize);
+    }
+    fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+        if (op == QNetworkAccessManager::GetOperation) {
+            return new StreamingGetReply(fakeFolder.remoteModifier(), op, request, &app);
+        }
+        return nullptr;
+    });
+
+    qDebug() << "NUMFILES" << numFiles << "FILESIZE" << fileSize;
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool result = fakeFolder.syncOnce();
+    const auto elapsedMsec = qMax(timer.elapsed(), qint64(1));
+    const auto bytes = numFiles * fileSize;
+    qDebug() << "DOWNLOAD:" << result << bytes << "bytes in" << elapsedMsec << "ms,"
+             << bytes / 1000 / elapsedMsec << "MB/s," << readyReadCount << "readyRead signals";
+
+    return result ? 0 : -1;
+}
+
+#include "benchdownload.moc"
@@ -0,0 +1,97 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncenginetestutils.h"
+#include <clientsideencryption.h>
+#include <propagatedownload.h>
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+
+using namespace OCC;
+
+/* Downloads the same payload in plain and encrypted, to compare the cost of the decryption */
+static bool download(GETFileJob *job, QBuffer &output, qint64 size, const char *name)
+{
+    output.buffer().reserve(static_cast<int>(size));
+    if (!output.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    // The job deletes itself once finished
+    bool replyOk = false;
+    QEventLoop loop;
+    QObject::connect(job, &GETFileJob::finishedSignal, &loop, [&] {
+        replyOk = job->reply()->error() == QNetworkReply::NoError;
+        loop.quit();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    job->start();
+    loop.exec();
+    const auto elapsedMsec = qMax(timer.elapsed(), qint64(1));
+    output.close();
+
+    const bool result = replyOk && output.size() == size;
+    qDebug() << name << result << size << "bytes in" << elapsedMsec << "ms," << size / 1000 / elapsedMsec << "MB/s";
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const qint64 fileSize = (argc > 1 ? QByteArray(argv[1]).toLongLong() : 200) * 1000 * 1000;
+
+    const auto plainData = EncryptionHelper::generateRandom(static_cast<int>(fileSize));
+    EncryptedFile encryptedFile;
+    encryptedFile.encryptionKey = EncryptionHelper::generateRandom(16);
+    encryptedFile.initializationVector = EncryptionHelper::generateRandom(16);
+
+    QTemporaryFile plainFile;
+    QTemporaryFile encryptedOutputFile;
+    if (!plainFile.open() || plainFile.write(plainData) != plainData.size()) {
+        qWarning() << "Could not write the payload";
+        return -1;
+    }
+    plainFile.close();
+    if (!EncryptionHelper::fileEncryption(encryptedFile.encryptionKey, encryptedFile.initializationVector,
+            &plainFile, &encryptedOutputFile, encryptedFile.authenticationTag)
+        || !encryptedOutputFile.open()) {
+        qWarning() << "Could not encrypt the payload";
+        return -1;
+    }
+    const auto encryptedData = encryptedOutputFile.readAll();
+
+    FakeFolder fakeFolder{ FileInfo{} };
+    fakeFolder.remoteModifier().insert(QStringLiteral("plain"), fileSize);
+    fakeFolder.remoteModifier().insert(QStringLiteral("encrypted"), encryptedData.size());
+    fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+        if (op == QNetworkAccessManager::GetOperation) {
+            const auto isEncrypted = getFilePathFromUrl(request.url()) == QStringLiteral("encrypted");
+            return new FakeGetWithDataReply(fakeFolder.remoteModifier(), isEncrypted ? encryptedData : plainData, op, request, &app);
+        }
+        return nullptr;
+    });
+
+    qDebug() << "FILESIZE" << fileSize;
+
+    QBuffer plainOutput;
+    const bool plainResult = download(
+        new GETFileJob(fakeFolder.account(), QStringLiteral("/plain"), &plainOutput, {}, {}, 0),
+        plainOutput, fileSize, "PLAIN:    ");
+
+    QBuffer decryptedOutput;
+    const bool encryptedResult = download(
+        new GETEncryptedFileJob(fakeFolder.account(), QStringLiteral("/encrypted"), &decryptedOutput, {}, {}, 0, encryptedFile),
+        decryptedOutput, fileSize, "ENCRYPTED:");
+
+    const bool result = plainResult && encryptedResult && decryptedOutput.buffer() == plainData;
+    return result ? 0 : -1;
+}
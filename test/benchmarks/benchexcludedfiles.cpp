@@ -0,0 +1,56 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "csync_exclude.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+
+#define EXCLUDE_LIST_FILE SOURCEDIR "/../../sync-exclude.lst"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int numPaths = argc > 1 ? QByteArray(argv[1]).toInt() : 1000000;
+
+    ExcludedFiles excludedFiles;
+    excludedFiles.addExcludeFilePath(EXCLUDE_LIST_FILE);
+    if (!excludedFiles.reloadExcludeFiles()) {
+        qWarning() << "Could not load" << EXCLUDE_LIST_FILE;
+        return -1;
+    }
+
+    // Mostly regular files, with the occasional temporary or system file
+    const QStringList names = {
+        QStringLiteral("report%1.pdf"), QStringLiteral("IMG_%1.jpg"), QStringLiteral("notes %1.txt"),
+        QStringLiteral("main%1.cpp"), QStringLiteral("data%1.csv"), QStringLiteral("archive%1.tar.gz"),
+        QStringLiteral("movie%1.mkv"), QStringLiteral("song%1.mp3"), QStringLiteral("draft%1.docx~"),
+        QStringLiteral("download%1.part"), QStringLiteral(".~lock.sheet%1.ods#"), QStringLiteral("Thumbs.db"),
+    };
+    QStringList paths;
+    paths.reserve(numPaths);
+    for (int i = 0; i < numPaths; ++i) {
+        const auto dir = QStringLiteral("dir%1/sub%2/").arg(i % 100).arg(i % 7);
+        paths.append(dir + names.at(i % names.size()).arg(i));
+    }
+    qDebug() << "NUMPATHS" << paths.size();
+
+    int excluded = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &path : qAsConst(paths)) {
+        excluded += excludedFiles.traversalPatternMatch(path, ItemTypeFile) != CSYNC_NOT_EXCLUDED;
+    }
+    const auto elapsedMsec = qMax(timer.elapsed(), qint64(1));
+
+    qDebug() << "TRAVERSAL:" << paths.size() << "paths in" << elapsedMsec << "ms,"
+             << paths.size() / elapsedMsec << "per ms," << excluded << "excluded";
+
+    return excluded > 0 ? 0 : -1;
+}
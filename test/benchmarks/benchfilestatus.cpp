@@ -0,0 +1,66 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+#include <syncfilestatustracker.h>
+
+#include <QElapsedTimer>
+
+using namespace OCC;
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int numQueries = argc > 1 ? QByteArray(argv[1]).toInt() : 100000;
+    const int numDirs = 100;
+    const int filesPerDir = 100;
+
+    FakeFolder fakeFolder{ FileInfo{} };
+    QStringList paths;
+    for (int dirNum = 0; dirNum < numDirs; ++dirNum) {
+        const auto dir = QStringLiteral("dir%1").arg(dirNum);
+        fakeFolder.remoteModifier().mkdir(dir);
+        paths.append(dir);
+        for (int fileNum = 0; fileNum < filesPerDir; ++fileNum) {
+            const auto file = QStringLiteral("%1/file%2.txt").arg(dir).arg(fileNum);
+            fakeFolder.remoteModifier().insert(file, 1);
+            paths.append(file);
+        }
+    }
+    if (!fakeFolder.syncOnce()) {
+        qWarning() << "Initial sync failed";
+        return -1;
+    }
+    qDebug() << "NUMPATHS" << paths.size() << "NUMQUERIES" << numQueries;
+
+    auto &tracker = fakeFolder.syncEngine().syncFileStatusTracker();
+    int upToDate = 0;
+    QElapsedTimer timer;
+
+    // Like a file manager opening every folder once
+    timer.start();
+    for (const auto &path : qAsConst(paths)) {
+        upToDate += tracker.fileStatus(path).tag() == SyncFileStatus::StatusUpToDate;
+    }
+    const auto firstPassMsec = timer.elapsed();
+
+    // Like a file manager refreshing its views
+    timer.restart();
+    for (int i = 0; i < numQueries; ++i) {
+        upToDate += tracker.fileStatus(paths.at(i % paths.size())).tag() == SyncFileStatus::StatusUpToDate;
+    }
+    const auto queriesMsec = timer.elapsed();
+
+    qDebug() << "FIRST PASS:" << paths.size() << "queries in" << firstPassMsec << "ms";
+    qDebug() << "QUERIES:   " << numQueries << "queries in" << queriesMsec << "ms,"
+             << (queriesMsec ? numQueries / queriesMsec : numQueries) << "per ms";
+
+    const bool result = upToDate == paths.size() + numQueries;
+    return result ? 0 : -1;
+}
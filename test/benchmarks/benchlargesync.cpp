@@ -40,10 +40,15 @@ int main(int argc, char *argv[])
     qDebug() << "NUMFILES" << numFiles;
     qDebug() << "NUMDIRS" << numDirs;
     QElapsedTimer timer;
+    // Discovery and reconcile are done once the engine is about to propagate
+    qint64 discoveryTime = 0;
+    QObject::connect(&fakeFolder.syncEngine(), &SyncEngine::aboutToPropagate, [&] {
+        discoveryTime = timer.elapsed();
+    });
     timer.start();
     bool result1 = fakeFolder.syncOnce();
-    qDebug() << "FIRST SYNC: " << result1 << timer.restart();
+    qDebug() << "FIRST SYNC: " << result1 << timer.restart() << "DISCOVERY: " << discoveryTime;
     bool result2 = fakeFolder.syncOnce();
-    qDebug() << "SECOND SYNC: " << result2 << timer.restart();
+    qDebug() << "SECOND SYNC: " << result2 << timer.restart() << "DISCOVERY: " << discoveryTime;
     return (result1 && result2) ? 0 : -1;
 }
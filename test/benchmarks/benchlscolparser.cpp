@@ -0,0 +1,117 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include "networkjobs.h"
+
+using namespace OCC;
+
+static const QString davPath = QStringLiteral("/remote.php/dav/files/admin/bench");
+
+QByteArray generateMultiStatus(int numEntries)
+{
+    QByteArray xml = "<?xml version=\"1.0\"?>\n"
+                     "<d:multistatus xmlns:d=\"DAV:\" xmlns:s=\"http://sabredav.org/ns\" xmlns:oc=\"http://owncloud.org/ns\" xmlns:nc=\"http://nextcloud.org/ns\">";
+    auto addResponse = [&xml](const QByteArray &href, bool isDirectory, int num) {
+        xml += "<d:response><d:href>" + href + "</d:href><d:propstat><d:prop>"
+               "<d:getlastmodified>Fri, 06 Feb 2015 13:49:55 GMT</d:getlastmodified>"
+               "<d:getetag>\"" + QByteArray::number(num, 16) + "5527beb0400b0\"</d:getetag>"
+               "<oc:id>" + QByteArray::number(num).rightJustified(8, '0') + "ocobzus5kn6s</oc:id>"
+               "<oc:fileid>" + QByteArray::number(num) + "</oc:fileid>"
+               "<oc:permissions>RGDNVW</oc:permissions>"
+               "<oc:checksums><oc:checksum>SHA1:" + QByteArray(40, 'a') + "</oc:checksum></oc:checksums>";
+        if (isDirectory) {
+            xml += "<d:resourcetype><d:collection/></d:resourcetype><oc:size>121780</oc:size>";
+        } else {
+            xml += "<d:resourcetype/><d:getcontentlength>121780</d:getcontentlength>";
+        }
+        xml += "</d:prop><d:status>HTTP/1.1 200 OK</d:status></d:propstat>"
+               "<d:propstat><d:prop><oc:downloadURL/><oc:dDC/></d:prop>"
+               "<d:status>HTTP/1.1 404 Not Found</d:status></d:propstat></d:response>";
+    };
+    addResponse(davPath.toUtf8() + '/', true, 0);
+    for (int i = 1; i <= numEntries; ++i) {
+        addResponse(davPath.toUtf8() + "/file%20" + QByteArray::number(i) + ".txt", false, i);
+    }
+    xml += "</d:multistatus>";
+    return xml;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    const int numEntries = argc > 1 ? QByteArray(argv[1]).toInt() : 100000;
+    const int chunkSize = 16 * 1024; // roughly what a QNetworkReply delivers per readyRead
+    const auto xml = generateMultiStatus(numEntries);
+    qDebug() << "NUMENTRIES" << numEntries << "DOCUMENT SIZE" << xml.size();
+
+    QElapsedTimer timer;
+    int count = 0;
+    qint64 bytesBeforeFirstEntry = -1;
+    qint64 bytesFed = 0;
+    auto countEntries = [&](const QString &, const QMap<QString, QString> &) {
+        if (bytesBeforeFirstEntry < 0) {
+            bytesBeforeFirstEntry = bytesFed;
+        }
+        ++count;
+    };
+
+    // The whole body needs to be buffered before parsing starts
+    bool result1 = false;
+    {
+        LsColXMLParser parser;
+        QObject::connect(&parser, &LsColXMLParser::directoryListingIterated, countEntries);
+        QHash<QString, ExtraFolderInfo> folderInfos;
+        timer.start();
+        bytesFed = xml.size();
+        result1 = parser.parse(xml, &folderInfos, davPath);
+        qDebug() << "BUFFERED PARSE: " << result1 << count << "entries in" << timer.elapsed() << "ms,"
+                 << "first entry after" << bytesBeforeFirstEntry << "bytes, peak buffer" << xml.size() << "bytes";
+    }
+
+    // The body is fed as it would arrive from the network
+    count = 0;
+    bytesBeforeFirstEntry = -1;
+    bytesFed = 0;
+    bool result2 = false;
+    {
+        LsColXMLParser parser;
+        QObject::connect(&parser, &LsColXMLParser::directoryListingIterated, countEntries);
+        QHash<QString, ExtraFolderInfo> folderInfos;
+        timer.restart();
+        parser.start(&folderInfos, davPath);
+        result2 = true;
+        for (int pos = 0; result2 && pos < xml.size(); pos += chunkSize) {
+            bytesFed = qMin(pos + chunkSize, xml.size());
+            result2 = parser.addData(xml.mid(pos, chunkSize));
+        }
+        result2 = result2 && parser.finish();
+        qDebug() << "STREAMING PARSE:" << result2 << count << "entries in" << timer.elapsed() << "ms,"
+                 << "first entry after" << bytesBeforeFirstEntry << "bytes, peak buffer" << chunkSize << "bytes";
+    }
+
+    // Like discovery: only the typed records, no property maps
+    count = 0;
+    bool result3 = false;
+    {
+        LsColXMLParser parser;
+        parser.setEmitPropertyMaps(false);
+        QObject::connect(&parser, &LsColXMLParser::directoryListingRecordIterated, [&count](const QString &, const DavPropertyRecord &) {
+            ++count;
+        });
+        QHash<QString, ExtraFolderInfo> folderInfos;
+        timer.restart();
+        result3 = parser.parse(xml, &folderInfos, davPath);
+        qDebug() << "RECORDS ONLY:   " << result3 << count << "entries in" << timer.elapsed() << "ms";
+    }
+
+    return (result1 && result2 && result3) ? 0 : -1;
+}
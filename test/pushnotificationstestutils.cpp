@@ -62,6 +62,14 @@ QWebSocket *FakeWebSocketServer::authenticateAccount(const OCC::AccountPtr accou
         return nullptr;
     }
 
+    // The ids of changed files should be requested
+    if (textMessagesCount() < 3 && !waitForTextMessages()) {
+        return nullptr;
+    }
+    if (textMessagesCount() != 3 || textMessage(2) != QStringLiteral("listen notify_file_id")) {
+        return nullptr;
+    }
+
     afterAuthentication();
 
     return socket;
@@ -0,0 +1,84 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+#include <bandwidthmanager.h>
+
+#include <numeric>
+
+using namespace OCC;
+
+class TestBandwidthManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFairShares()
+    {
+        constexpr auto unlimited = std::numeric_limits<qint64>::max();
+
+        // Everyone wants more than an equal share
+        QCOMPARE(BandwidthManager::fairShares({ unlimited, unlimited, unlimited, unlimited }, 1000), QVector<qint64>({ 250, 250, 250, 250 }));
+
+        // What the small one doesn't need goes to the others
+        QCOMPARE(BandwidthManager::fairShares({ unlimited, 100, unlimited }, 1000), QVector<qint64>({ 450, 100, 450 }));
+
+        // Nobody gets more than it wants
+        QCOMPARE(BandwidthManager::fairShares({ 10, 20 }, 1000), QVector<qint64>({ 10, 20 }));
+
+        // A tiny budget still moves the transfers and is not exceeded
+        const auto shares = BandwidthManager::fairShares({ unlimited, unlimited, unlimited }, 2);
+        QCOMPARE(std::accumulate(shares.cbegin(), shares.cend(), qint64(0)), qint64(2));
+
+        QCOMPARE(BandwidthManager::fairShares({}, 1000), QVector<qint64>());
+    }
+
+    void testParallelDownloadsWithinLimit()
+    {
+        FakeFolder fakeFolder{ FileInfo{} };
+        constexpr qint64 downloadLimit = 200 * 1000; // bytes per second
+        constexpr int fileCount = 4;
+        // Bigger than OwncloudPropagator::smallFileSize(), those may always run in parallel
+        constexpr int fileSize = 150 * 1000;
+        for (int i = 0; i < fileCount; ++i) {
+            fakeFolder.remoteModifier().insert(QStringLiteral("file%1").arg(i), fileSize);
+        }
+        fakeFolder.syncEngine().setNetworkLimits(0, downloadLimit);
+
+        int runningGets = 0;
+        int maxRunningGets = 0;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::GetOperation) {
+                auto reply = new FakeGetReply(fakeFolder.remoteModifier(), op, request, this);
+                maxRunningGets = qMax(maxRunningGets, ++runningGets);
+                connect(reply, &QObject::destroyed, this, [&runningGets] { --runningGets; });
+                return reply;
+            }
+            return nullptr;
+        });
+
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY(fakeFolder.syncOnce());
+        const auto elapsedMsec = timer.elapsed();
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // The limit doesn't serialize the transfers anymore
+        QVERIFY(maxRunningGets > 1);
+
+        // The transfers together stay within the limit. The quota for an interval is
+        // handed out at its start, so allow for the burst of the first interval.
+        const auto bytesPerSecond = qint64(fileCount) * fileSize * 1000 / qMax(elapsedMsec, qint64(1));
+        qDebug() << "downloaded" << fileCount * fileSize << "bytes in" << elapsedMsec << "ms:" << bytesPerSecond << "bytes/s, at most" << maxRunningGets << "in parallel";
+        QVERIFY(bytesPerSecond <= downloadLimit * 5 / 4);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestBandwidthManager)
+#include "testbandwidthmanager.moc"
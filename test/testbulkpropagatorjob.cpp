@@ -0,0 +1,91 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "bulkpropagatorjob.h"
+
+using namespace OCC;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto megaByte = 1000LL * 1000LL;
+constexpr auto maxParallelBatches = 3;
+
+BulkUploadBatchLimits initialLimits()
+{
+    BulkUploadBatchLimits limits;
+    limits._bytes = 10 * megaByte;
+    return limits;
+}
+
+}
+
+class TestBulkPropagatorJob : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFastFullBatchGrowsAndOverlaps()
+    {
+        const SyncOptions syncOptions;
+
+        // Full by the number of files
+        auto limits = initialLimits();
+        limits.adapt(BulkUploadBatchLimits::initialFiles, megaByte, 1s, syncOptions, maxParallelBatches);
+        QVERIFY(limits._files > BulkUploadBatchLimits::initialFiles);
+        QCOMPARE(limits._parallelBatches, 2);
+
+        // Full by the payload, the last file exceeds it
+        limits = initialLimits();
+        limits.adapt(3, 12 * megaByte, 1s, syncOptions, maxParallelBatches);
+        QVERIFY(limits._bytes > 10 * megaByte);
+        QCOMPARE(limits._parallelBatches, 2);
+
+        // Never more batches than transfer jobs
+        limits._parallelBatches = maxParallelBatches;
+        limits.adapt(limits._files, megaByte, 1s, syncOptions, maxParallelBatches);
+        QCOMPARE(limits._parallelBatches, maxParallelBatches);
+    }
+
+    void testFastPartialBatchDoesNotOverlap()
+    {
+        const SyncOptions syncOptions;
+
+        // The last files of the upload: so fast that the adapted limits hit their
+        // bounds, but the batch itself was not full
+        auto limits = initialLimits();
+        limits.adapt(5, megaByte, 10ms, syncOptions, maxParallelBatches);
+        QCOMPARE(limits._files, BulkUploadBatchLimits::maxFiles);
+        QVERIFY(limits._bytes > 10 * megaByte);
+        QCOMPARE(limits._parallelBatches, 1);
+    }
+
+    void testSlowBatchShrinks()
+    {
+        const SyncOptions syncOptions;
+
+        auto limits = initialLimits();
+        limits._parallelBatches = 2;
+        limits.adapt(BulkUploadBatchLimits::initialFiles, 10 * megaByte, 20s, syncOptions, maxParallelBatches);
+        QVERIFY(limits._files < BulkUploadBatchLimits::initialFiles);
+        QVERIFY(limits._bytes < 10 * megaByte);
+        QCOMPARE(limits._parallelBatches, 1);
+
+        // At least one batch stays in flight, and batches keep a minimum size
+        for (int i = 0; i < 10; ++i) {
+            limits.adapt(limits._files, megaByte, 60s, syncOptions, maxParallelBatches);
+        }
+        QCOMPARE(limits._parallelBatches, 1);
+        QCOMPARE(limits._files, BulkUploadBatchLimits::minFiles);
+        QCOMPARE(limits._bytes, syncOptions.minChunkSize());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestBulkPropagatorJob)
+#include "testbulkpropagatorjob.moc"
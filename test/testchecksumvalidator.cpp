@@ -119,6 +119,58 @@ using namespace OCC::Utility;
         QCOMPARE(sSum, sum);
     }
 
+    void testIncrementalCalc()
+    {
+        QFile file(_testfile);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const auto data = file.readAll();
+        file.close();
+
+        for (const auto checksumType : { OCC::checkSumMD5C, OCC::checkSumSHA1C, OCC::checkSumSHA2C, OCC::checkSumAdlerC }) {
+            ChecksumCalculator fileCalculator(QSharedPointer<QFile>::create(_testfile), checksumType);
+            const auto expected = fileCalculator.calculate();
+            QVERIFY(!expected.isEmpty());
+
+            // Fed in uneven pieces, like a download
+            ChecksumCalculator streamCalculator(checksumType);
+            QVERIFY(streamCalculator.isValid());
+            for (int pos = 0; pos < data.size(); pos += 1000) {
+                QVERIFY(streamCalculator.addData(data.constData() + pos, qMin(1000, data.size() - pos)));
+            }
+            QCOMPARE(streamCalculator.result(), expected);
+        }
+
+        QVERIFY(!ChecksumCalculator(QByteArrayLiteral("Unknown")).isValid());
+    }
+
+    void testMultiCalc()
+    {
+        const QByteArrayList checksumTypes = { OCC::checkSumSHA1C, OCC::checkSumAdlerC, OCC::checkSumMD5C };
+
+        ChecksumCalculator multiCalculator(QSharedPointer<QFile>::create(_testfile), checksumTypes);
+        const auto checksums = multiCalculator.calculateAll();
+        QCOMPARE(checksums.size(), checksumTypes.size());
+        for (int i = 0; i < checksumTypes.size(); ++i) {
+            ChecksumCalculator calculator(QSharedPointer<QFile>::create(_testfile), checksumTypes.at(i));
+            QCOMPARE(checksums.at(i), calculator.calculate());
+        }
+
+        // One unknown type spoils all
+        ChecksumCalculator invalidCalculator(QSharedPointer<QFile>::create(_testfile), QByteArrayList{ OCC::checkSumSHA1C, "Unknown" });
+        QVERIFY(invalidCalculator.calculateAll().isEmpty());
+
+        // ComputeChecksum hands out the second type alongside
+        ComputeChecksum computeChecksum;
+        computeChecksum.setChecksumType(OCC::checkSumSHA1C);
+        computeChecksum.setAdditionalChecksumType(OCC::checkSumAdlerC);
+        QSignalSpy doneSpy(&computeChecksum, &ComputeChecksum::done);
+        computeChecksum.start(_testfile);
+        QVERIFY(doneSpy.wait());
+        QCOMPARE(doneSpy.first().at(0).toByteArray(), QByteArray(OCC::checkSumSHA1C));
+        QCOMPARE(doneSpy.first().at(1).toByteArray(), checksums.at(0));
+        QCOMPARE(computeChecksum.additionalChecksum(), checksums.at(1));
+    }
+
     void testUploadChecksummingAdler() {
 #ifndef ZLIB_FOUND
         QSKIP("ZLIB not found.", SkipSingle);
@@ -111,6 +111,102 @@ private slots:
         QCOMPARE(fakeFolder.uploadState().children.count(), 2); // the transfer was done with chunking
     }
 
+    // The chunks of one file are sent in parallel and may complete out of order
+    void testParallelChunkUploads()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.syncEngine().account()->setCapabilities({ { "dav", QVariantMap{ {"chunking", "1.0"} } } });
+        setChunkSize(fakeFolder.syncEngine(), 1 * 1000 * 1000);
+        auto options = fakeFolder.syncEngine().syncOptions();
+        options._parallelChunkUploads = 3;
+        fakeFolder.syncEngine().setSyncOptions(options);
+        const int size = 10 * 1000 * 1000; // 10 MB
+
+        int runningPuts = 0;
+        int maxRunningPuts = 0;
+        QStringList finishedChunks;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *outgoingData) -> QNetworkReply * {
+            if (op != QNetworkAccessManager::PutOperation || !request.url().path().contains("/uploads/")) {
+                return nullptr;
+            }
+            const auto chunk = request.url().path().section('/', -1);
+            // Odd chunks take longer, so the even ones overtake them
+            const auto responseDelay = chunk.toInt() % 2 ? 50 : 5;
+            auto reply = new DelayedReply<FakePutReply>(responseDelay, fakeFolder.uploadState(), op, request, outgoingData->readAll(), &fakeFolder.syncEngine());
+            maxRunningPuts = qMax(maxRunningPuts, ++runningPuts);
+            QObject::connect(reply, &QNetworkReply::finished, [&, chunk] {
+                --runningPuts;
+                finishedChunks.append(chunk);
+            });
+            return reply;
+        });
+
+        fakeFolder.localModifier().insert("A/a0", size);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(fakeFolder.currentRemoteState().find("A/a0")->size, size);
+        QCOMPARE(finishedChunks.size(), 10);
+        QCOMPARE(maxRunningPuts, 3);
+
+        auto sortedChunks = finishedChunks;
+        sortedChunks.sort();
+        QVERIFY(sortedChunks != finishedChunks);
+    }
+
+    // An abort during parallel chunk uploads can leave a hole in the chunks on the server
+    void testParallelChunkUploadsResume()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.syncEngine().account()->setCapabilities({ { "dav", QVariantMap{ {"chunking", "1.0"} } } });
+        setChunkSize(fakeFolder.syncEngine(), 1 * 1000 * 1000);
+        auto options = fakeFolder.syncEngine().syncOptions();
+        options._parallelChunkUploads = 3;
+        fakeFolder.syncEngine().setSyncOptions(options);
+        const int size = 10 * 1000 * 1000; // 10 MB
+
+        fakeFolder.localModifier().insert("A/a0", size);
+        const auto con = QObject::connect(&fakeFolder.syncEngine(), &SyncEngine::transmissionProgress, [&](const ProgressInfo &progress) {
+            if (progress.completedSize() > (progress.totalSize() / 3)) {
+                fakeFolder.syncEngine().abort();
+            }
+        });
+        QVERIFY(!fakeFolder.syncOnce());
+        QObject::disconnect(con);
+
+        QCOMPARE(fakeFolder.uploadState().children.count(), 1);
+        auto chunkingId = fakeFolder.uploadState().children.first().name;
+        const auto &chunkMap = fakeFolder.uploadState().children.first().children;
+        QVERIFY(chunkMap.size() >= 3);
+
+        // Remove the second chunk as if it was still running, so all further chunks will be deleted and resent
+        const auto firstChunk = chunkMap.first();
+        const auto secondChunk = *(chunkMap.begin() + 1);
+        const auto chunksToDelete = chunkMap.keys().mid(2);
+        fakeFolder.uploadState().children.first().remove(secondChunk.name);
+
+        QStringList deletedChunks;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::PutOperation) {
+                // Test that we properly resuming, not resending the first chunk
+                Q_ASSERT(request.rawHeader("OC-Chunk-Offset").toLongLong() >= firstChunk.size);
+            } else if (op == QNetworkAccessManager::DeleteOperation) {
+                deletedChunks.append(request.url().path().section('/', -1));
+            }
+            return nullptr;
+        });
+
+        QVERIFY(fakeFolder.syncOnce());
+        for (const auto &toDelete : chunksToDelete) {
+            QVERIFY(deletedChunks.contains(toDelete));
+        }
+
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(fakeFolder.currentRemoteState().find("A/a0")->size, size);
+        // The same chunk id was re-used
+        QCOMPARE(fakeFolder.uploadState().children.count(), 1);
+        QCOMPARE(fakeFolder.uploadState().children.first().name, chunkingId);
+    }
+
     // Test resuming when there's a confusing chunk added
     void testResume1() {
         FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
@@ -12,6 +12,7 @@
 #include <common/constants.h>
 
 #include "clientsideencryption.h"
+#include "propagateupload.h"
 
 using namespace OCC;
 
@@ -147,6 +148,8 @@ private slots:
         QTest::newRow("data2") << 32  << 8;
         QTest::newRow("data3") << 76  << 64;
         QTest::newRow("data4") << 272 << 256;
+        QTest::newRow("data5") << 100 << 110;
+        QTest::newRow("data6") << 3 * 1024 * 1024 + 5 << 64 * 1024;
     }
 
     void testStreamingDecryptor()
@@ -200,52 +203,115 @@ private slots:
         EncryptionHelper::StreamingDecryptor streamingDecryptor(encryptionKey, initializationVector, dummyEncryptionOutputFile.size());
         QVERIFY(streamingDecryptor.isInitialized());
 
-        QBuffer chunkedOutputDecrypted;
-        QVERIFY(chunkedOutputDecrypted.open(QBuffer::WriteOnly));
-
         QVERIFY(dummyEncryptionOutputFile.open());
 
-        QByteArray pendingBytes;
-
         QFETCH(int, bytesToRead);
 
+        // Like network packets, the chunks may end anywhere, even within the tag
+        QByteArray chunkedOutputDecrypted;
+        QByteArray decryptedChunk(bytesToRead, '\0');
         while (dummyEncryptionOutputFile.pos() < dummyEncryptionOutputFile.size()) {
-            const auto bytesRemaining = dummyEncryptionOutputFile.size() - dummyEncryptionOutputFile.pos();
-            auto toRead = bytesRemaining > bytesToRead ? bytesToRead : bytesRemaining;
+            const auto encryptedChunk = dummyEncryptionOutputFile.read(bytesToRead);
+            QVERIFY(!encryptedChunk.isEmpty());
 
-            if (dummyEncryptionOutputFile.pos() + toRead > dummyEncryptionOutputFile.size()) {
-                toRead = dummyEncryptionOutputFile.size() - dummyEncryptionOutputFile.pos();
-            }
+            const auto decryptedBytes = streamingDecryptor.chunkDecryption(encryptedChunk.constData(), encryptedChunk.size(), decryptedChunk.data());
+            QVERIFY(decryptedBytes >= 0);
+            QVERIFY(decryptedBytes <= encryptedChunk.size());
+            QCOMPARE(streamingDecryptor.isFinished(), dummyEncryptionOutputFile.atEnd());
 
-            if (bytesRemaining - toRead != 0 && bytesRemaining - toRead < OCC::Constants::e2EeTagSize) {
-                // decryption is going to fail if last chunk does not include or does not equal to OCC::Constants::e2EeTagSize bytes tag
-                // since we are emulating random size of network packets, we may end up reading beyond OCC::Constants::e2EeTagSize bytes tag at the end
-                // in that case, we don't want to try and decrypt less than OCC::Constants::e2EeTagSize ending bytes of tag, we will accumulate all the incoming data till the end
-                // and then, we are going to decrypt the entire chunk containing OCC::Constants::e2EeTagSize bytes at the end
-                pendingBytes += dummyEncryptionOutputFile.read(bytesRemaining);
-                continue;
-            }
+            chunkedOutputDecrypted.append(decryptedChunk.constData(), static_cast<int>(decryptedBytes));
+        }
 
-            const auto decryptedChunk = streamingDecryptor.chunkDecryption(dummyEncryptionOutputFile.read(toRead).constData(), toRead);
+        QCOMPARE(generateHash(chunkedOutputDecrypted), originalFileHash);
+    }
+    void testStreamingEncryptor()
+    {
+        QTemporaryFile plainFile;
+        QVERIFY(plainFile.open());
+        // More than one block of fileEncryption
+        const auto plainData = EncryptionHelper::generateRandom(3 * 1024 * 1024 + 5);
+        QCOMPARE(plainFile.write(plainData), plainData.size());
+        plainFile.close();
 
-            QVERIFY(decryptedChunk.size() == toRead || streamingDecryptor.isFinished() || !pendingBytes.isEmpty());
+        const auto encryptionKey = EncryptionHelper::generateRandom(16);
+        const auto initializationVector = EncryptionHelper::generateRandom(16);
 
-            chunkedOutputDecrypted.write(decryptedChunk);
+        QTemporaryFile encryptedFile;
+        QByteArray tag;
+        QVERIFY(EncryptionHelper::fileEncryption(encryptionKey, initializationVector, &plainFile, &encryptedFile, tag));
+        plainFile.close();
+        encryptedFile.close();
+        QVERIFY(encryptedFile.open());
+        const auto encryptedData = encryptedFile.readAll();
+        QCOMPARE(encryptedData.size(), plainData.size() + OCC::Constants::e2EeTagSize);
+        QCOMPARE(encryptedData.right(OCC::Constants::e2EeTagSize), tag);
+
+        // Computing only the tag gives the same one
+        QByteArray tagOnly;
+        QVERIFY(EncryptionHelper::fileEncryption(encryptionKey, initializationVector, &plainFile, nullptr, tagOnly));
+        QCOMPARE(tagOnly, tag);
+
+        EncryptionHelper::StreamingEncryptor streamingEncryptor(encryptionKey, initializationVector, tag);
+        QVERIFY(streamingEncryptor.isInitialized());
+        QCOMPARE(streamingEncryptor.tag(), tag);
+
+        // Like chunks uploaded out of order, with offsets not aligned to the AES blocks
+        const QVector<QPair<int, int>> ranges = {
+            { 1024 * 1024, 1024 * 1024 },
+            { 0, 1 },
+            { 17, 100 },
+            { 3, 1024 * 1024 - 3 },
+            { 2 * 1024 * 1024 + 7, 1024 * 1024 - 2 },
+            { 0, plainData.size() },
+        };
+        for (const auto &range : ranges) {
+            auto data = plainData.mid(range.first, range.second);
+            QVERIFY(streamingEncryptor.encrypt(range.first, data.data(), data.size()));
+            QCOMPARE(data, encryptedData.mid(range.first, range.second));
         }
+    }
 
-        if (!pendingBytes.isEmpty()) {
-            const auto decryptedChunk = streamingDecryptor.chunkDecryption(pendingBytes.constData(), pendingBytes.size());
+    void testEncryptingUploadDevice()
+    {
+        QTemporaryFile plainFile;
+        QVERIFY(plainFile.open());
+        // More than one buffer of the device
+        const auto plainData = EncryptionHelper::generateRandom(2 * 1024 * 1024 + 100);
+        QCOMPARE(plainFile.write(plainData), plainData.size());
+        plainFile.close();
 
-            QVERIFY(decryptedChunk.size() == pendingBytes.size() || streamingDecryptor.isFinished());
+        const auto encryptionKey = EncryptionHelper::generateRandom(16);
+        const auto initializationVector = EncryptionHelper::generateRandom(16);
 
-            chunkedOutputDecrypted.write(decryptedChunk);
+        QTemporaryFile encryptedFile;
+        QByteArray tag;
+        QVERIFY(EncryptionHelper::fileEncryption(encryptionKey, initializationVector, &plainFile, &encryptedFile, tag));
+        QVERIFY(encryptedFile.open());
+        const auto encryptedData = encryptedFile.readAll();
+
+        // Like the chunks of an upload, the last ones contain the tag
+        const auto encryptedSize = encryptedData.size();
+        const QVector<QPair<qint64, qint64>> ranges = {
+            { 0, encryptedSize },
+            { 0, 1024 * 1024 },
+            { 1024 * 1024, 1024 * 1024 },
+            { 2 * 1024 * 1024, encryptedSize - 2 * 1024 * 1024 },
+            { 5, encryptedSize - 10 },
+            { encryptedSize - OCC::Constants::e2EeTagSize - 3, 10 },
+            { encryptedSize - 7, 7 },
+        };
+        for (const auto &range : ranges) {
+            UploadDevice device(plainFile.fileName(), range.first, range.second, nullptr);
+            device.setEncryption(encryptionKey, initializationVector, tag);
+            QVERIFY(device.open(QIODevice::ReadOnly));
+            QCOMPARE(device.size(), range.second);
+            QCOMPARE(device.readAll(), encryptedData.mid(range.first, range.second));
+
+            // A retried request reads the data again
+            QVERIFY(device.seek(range.second / 2));
+            QCOMPARE(device.readAll(), encryptedData.mid(range.first + range.second / 2, range.second - range.second / 2));
+            device.close();
         }
-
-        chunkedOutputDecrypted.close();
-
-        QVERIFY(chunkedOutputDecrypted.open(QBuffer::ReadOnly));
-        QCOMPARE(generateHash(chunkedOutputDecrypted.readAll()), originalFileHash);
-        chunkedOutputDecrypted.close();
     }
 };
 
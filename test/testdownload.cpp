@@ -91,6 +91,35 @@ private slots:
         QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
     }
 
+    void testChecksumsComputedWhileDownloading()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        QByteArray checksumValue;
+        fakeFolder.setServerOverride([&](QNetworkAccessManager::Operation op, const QNetworkRequest &request, QIODevice *) -> QNetworkReply * {
+            if (op == QNetworkAccessManager::GetOperation) {
+                auto reply = new FakeGetReply(fakeFolder.remoteModifier(), op, request, this);
+                reply->setRawHeader(checkSumHeaderC, checksumValue);
+                return reply;
+            }
+            return nullptr;
+        });
+
+        // The transmission checksum is MD5, the content checksum SHA1 (the default preferred upload type)
+        checksumValue = "MD5:d8a73157ce10cd94a91c2079fc9a92c8"; // printf 'A%.0s' {1..16} | md5sum -
+        fakeFolder.remoteModifier().create("A/a3", 16, 'A');
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        SyncJournalFileRecord record;
+        QVERIFY(fakeFolder.syncJournal().getFileRecord(QByteArrayLiteral("A/a3"), &record));
+        QCOMPARE(record._checksumHeader, QByteArray("SHA1:19b1928d58a2030d08023f3d7054516dbc186f20")); // printf 'A%.0s' {1..16} | sha1sum -
+
+        // A mismatch is still detected
+        checksumValue = "MD5:bad";
+        fakeFolder.remoteModifier().create("A/a4", 16, 'A');
+        QVERIFY(!fakeFolder.syncOnce());
+        QVERIFY(!fakeFolder.currentLocalState().find("A/a4"));
+    }
+
     void testErrorMessage () {
         // This test's main goal is to test that the error string from the server is shown in the UI
 
@@ -458,6 +458,49 @@ private slots:
         QCOMPARE(check_file_full("dir/foo"), CSYNC_FILE_EXCLUDE_LIST);
     }
 
+    void check_csync_simple_bname_patterns()
+    {
+        setup();
+        excludedFiles->addManualExclude("literal");
+        excludedFiles->addManualExclude("*.suffix");
+        excludedFiles->addManualExclude("prefix.*");
+        excludedFiles->addManualExclude("]removed*");
+        excludedFiles->addManualExclude("removedkept");
+        excludedFiles->addManualExclude("dironly*/");
+        excludedFiles->addManualExclude("com?lex");
+
+        QCOMPARE(check_file_traversal("literal"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("s/literal"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("literalX"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("Xliteral"), CSYNC_NOT_EXCLUDED);
+
+        QCOMPARE(check_file_traversal("a.suffix"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal(".suffix"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_dir_traversal("s/a.suffix"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a.suffixX"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("suffix"), CSYNC_NOT_EXCLUDED);
+
+        QCOMPARE(check_file_traversal("prefix.a"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("prefix."), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("Xprefix.a"), CSYNC_NOT_EXCLUDED);
+
+        // Keep patterns win over remove patterns
+        QCOMPARE(check_file_traversal("removedX"), CSYNC_FILE_EXCLUDE_AND_REMOVE);
+        QCOMPARE(check_file_traversal("removedkept"), CSYNC_FILE_EXCLUDE_LIST);
+
+        QCOMPARE(check_dir_traversal("dironlyX"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("dironlyX"), CSYNC_NOT_EXCLUDED);
+
+        // Still goes through the regex
+        QCOMPARE(check_file_traversal("complex"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("compllex"), CSYNC_NOT_EXCLUDED);
+
+        // The full matcher agrees
+        QCOMPARE(check_file_full("s/a.suffix"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_full("prefix.a/file"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_full("removedX"), CSYNC_FILE_EXCLUDE_AND_REMOVE);
+    }
+
     void check_csync_pathes()
     {
         setup_init();
@@ -775,6 +818,48 @@ private slots:
         QCOMPARE(excludedFiles->reloadExcludeFiles(), true);
         QCOMPARE(excludedFiles->_allExcludes.size(), 1);
     }
+
+    void testNestedExcludeFilesDuringTraversal()
+    {
+        QTemporaryDir tempDir;
+        excludedFiles.reset(new ExcludedFiles(tempDir.path() + "/"));
+        excludedFiles->setWildcardsMatchSlash(false);
+        excludedFiles->addManualExclude("*.root");
+
+        auto writeExcludeFile = [&](const QString &dir, const QByteArray &patterns) {
+            QVERIFY(QDir(tempDir.path()).mkpath(dir));
+            QFile excludeList(tempDir.path() + '/' + dir + "/.sync-exclude.lst");
+            QVERIFY(excludeList.open(QFile::WriteOnly));
+            QCOMPARE(excludeList.write(patterns), patterns.size());
+        };
+        writeExcludeFile("a", "nested1");
+        writeExcludeFile("a/b", "nested2");
+
+        QCOMPARE(check_dir_traversal("a"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("a/nested1"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/nested2"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("a/x.root"), CSYNC_FILE_EXCLUDE_LIST);
+
+        QCOMPARE(check_dir_traversal("a/b"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("a/b/nested1"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/b/nested2"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/b/x.root"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(excludedFiles->_allExcludes.size(), 3);
+
+        // A changed exclude file is picked up the next time its directory is visited
+        writeExcludeFile("a", "nested3");
+        QFile excludeList(tempDir.path() + "/a/.sync-exclude.lst");
+        QVERIFY(excludeList.open(QFile::ReadWrite));
+        QVERIFY(excludeList.setFileTime(QDateTime::currentDateTimeUtc().addSecs(60), QFileDevice::FileModificationTime));
+        excludeList.close();
+
+        QCOMPARE(check_dir_traversal("a"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("a/nested1"), CSYNC_NOT_EXCLUDED);
+        QCOMPARE(check_file_traversal("a/nested3"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/b/nested3"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/b/nested2"), CSYNC_FILE_EXCLUDE_LIST);
+        QCOMPARE(check_file_traversal("a/b/x.root"), CSYNC_FILE_EXCLUDE_LIST);
+    }
 };
 
 QTEST_APPLESS_MAIN(TestExcludedFiles)
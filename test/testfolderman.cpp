@@ -242,6 +242,72 @@ private slots:
         OCC::AccountManager::instance()->deleteAccount(accountState);
     }
 
+    void testFileIdsPushNotificationSchedulesOwningFolder()
+    {
+        QTemporaryDir dir;
+        ConfigFile::setConfDir(dir.path()); // we don't want to pollute the user's config file
+
+        QScopedPointer<FakeQNAM> fakeQnam(new FakeQNAM({}));
+        OCC::AccountPtr account = OCC::Account::create();
+        account->setCredentials(new FakeCredentials{fakeQnam.data()});
+        account->setUrl(QUrl(("http://example.de")));
+        // Connected, so that the folders can be scheduled
+        const auto accountState = new FakeAccountState(account);
+
+        FakeFolder owningFakeFolder{FileInfo::A12_B12_C12_S12()};
+        FakeFolder otherFakeFolder{FileInfo::A12_B12_C12_S12()};
+        FolderMan *folderman = FolderMan::instance();
+        const auto owningFolder = folderman->addFolder(accountState, folderDefinition(owningFakeFolder.localPath()));
+        const auto otherFolder = folderman->addFolder(accountState, folderDefinition(otherFakeFolder.localPath()));
+        QVERIFY(owningFolder);
+        QVERIFY(otherFolder);
+
+        // File ids the way the server formats them: padded to eight digits, unless
+        // longer, followed by the instance id. Neither journal has root entries.
+        auto addRecord = [](Folder *folder, const QByteArray &path, ItemType type, const QByteArray &fileId) {
+            SyncJournalFileRecord record;
+            record._path = path;
+            record._type = type;
+            record._fileId = fileId;
+            record._etag = "etag";
+            record._remotePerm = RemotePermissions::fromDbValue("RW");
+            QVERIFY(folder->journalDb()->setFileRecord(record));
+        };
+        addRecord(owningFolder, "A/sub", ItemTypeDirectory, "00000100ocinstance");
+        addRecord(owningFolder, "A/sub/changed", ItemTypeFile, "00000123ocinstance");
+        addRecord(otherFolder, "B/sub", ItemTypeDirectory, "123456789ocinstance");
+        addRecord(otherFolder, "B/sub/unchanged", ItemTypeFile, "123456790ocinstance");
+
+        folderman->_scheduledFolders.clear();
+        folderman->slotProcessFileIdsPushNotification(account.data(), { 123 });
+
+        // Only the folder with the file is scheduled, for its parent directory
+        QCOMPARE(folderman->scheduleQueue().size(), 1);
+        QCOMPARE(folderman->scheduleQueue().first(), owningFolder);
+        SyncJournalFileRecord record;
+        QVERIFY(owningFolder->journalDb()->getFileRecord(QByteArrayLiteral("A/sub"), &record));
+        QCOMPARE(record._etag, QByteArray("_invalid_"));
+        QVERIFY(otherFolder->journalDb()->getFileRecord(QByteArrayLiteral("B/sub"), &record));
+        QCOMPARE(record._etag, QByteArray("etag"));
+
+        // Ids longer than the padding
+        folderman->_scheduledFolders.clear();
+        folderman->slotProcessFileIdsPushNotification(account.data(), { 123456790 });
+        QCOMPARE(folderman->scheduleQueue().size(), 1);
+        QCOMPARE(folderman->scheduleQueue().first(), otherFolder);
+        QVERIFY(otherFolder->journalDb()->getFileRecord(QByteArrayLiteral("B/sub"), &record));
+        QCOMPARE(record._etag, QByteArray("_invalid_"));
+
+        // Unknown ids, e.g. of new files, schedule all folders of the account
+        folderman->_scheduledFolders.clear();
+        folderman->slotProcessFileIdsPushNotification(account.data(), { 999 });
+        QCOMPARE(folderman->scheduleQueue().size(), 2);
+
+        folderman->_scheduledFolders.clear();
+        folderman->removeFolder(owningFolder);
+        folderman->removeFolder(otherFolder);
+    }
+
     void testCheckPathValidityForNewFolder()
     {
 #ifdef Q_OS_WIN
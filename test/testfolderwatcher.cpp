@@ -10,6 +10,10 @@
 #include "folderwatcher.h"
 #include "common/utility.h"
 
+#ifdef Q_OS_LINUX
+#include "folderwatcher_linux.h"
+#endif
+
 void touch(const QString &file)
 {
 #ifdef Q_OS_WIN
@@ -97,7 +101,8 @@ class TestFolderWatcher : public QObject
     }
 
 #ifdef Q_OS_LINUX
-#define CHECK_WATCH_COUNT(n) QCOMPARE(_watcher->testLinuxWatchCount(), (n))
+// The initial watches are registered asynchronously
+#define CHECK_WATCH_COUNT(n) QTRY_COMPARE(_watcher->testLinuxWatchCount(), (n))
 #else
 #define CHECK_WATCH_COUNT(n) do {} while (false)
 #endif
@@ -262,6 +267,46 @@ private slots:
         mkdir(dir);
         QVERIFY(waitForPathChanged(dir));
     }
+
+#ifdef Q_OS_LINUX
+    void testFanotifyDirectoryCache()
+    {
+        FanotifyDirectoryCache cache(2);
+        QHash<QByteArray, QString> paths = {
+            { "a", QStringLiteral("/folder/a") },
+            { "b", QStringLiteral("/folder/b") },
+        };
+        int resolved = 0;
+        const auto resolve = [&](const QByteArray &fileHandle) {
+            ++resolved;
+            return paths.value(fileHandle);
+        };
+
+        QCOMPARE(cache.path("a", resolve), QStringLiteral("/folder/a"));
+        QCOMPARE(cache.path("a", resolve), QStringLiteral("/folder/a"));
+        QCOMPARE(resolved, 1);
+
+        // A directory outside of the folder isn't cached, it is found once it's moved in
+        QVERIFY(cache.path("outside", resolve).isEmpty());
+        QCOMPARE(cache.size(), 1);
+        paths.insert("outside", QStringLiteral("/folder/moved-in"));
+        QCOMPARE(cache.path("outside", resolve), QStringLiteral("/folder/moved-in"));
+        QCOMPARE(resolved, 3);
+
+        // The cache is dropped when it is full
+        QCOMPARE(cache.size(), 2);
+        QCOMPARE(cache.path("b", resolve), QStringLiteral("/folder/b"));
+        QCOMPARE(cache.size(), 1);
+        QCOMPARE(resolved, 4);
+
+        // Stale paths are resolved again after a clear
+        paths.insert("b", QStringLiteral("/folder/renamed"));
+        QCOMPARE(cache.path("b", resolve), QStringLiteral("/folder/b"));
+        cache.clear();
+        QCOMPARE(cache.path("b", resolve), QStringLiteral("/folder/renamed"));
+        QCOMPARE(resolved, 5);
+    }
+#endif
 };
 
 #ifdef Q_OS_MAC
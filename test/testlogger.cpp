@@ -0,0 +1,117 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "logger.h"
+
+using namespace OCC;
+
+Q_LOGGING_CATEGORY(lcTestLogger, "nextcloud.test.logger", QtInfoMsg)
+
+static void writeOldLog(const QString &path, qint64 size, const QDateTime &modified)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QVERIFY(file.write(QByteArray(size, 'x')) == size);
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+}
+
+class TestLogger : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        // Installs the message handler
+        Logger::instance();
+    }
+
+    void cleanup()
+    {
+        auto logger = Logger::instance();
+        logger->setLogFile(QString());
+        logger->setLogDir(QString());
+        logger->setLogMaxFileSize(0);
+        logger->setLogMaxTotalSize(0);
+    }
+
+    void testRotateBySizeAndPruneOldestFirst()
+    {
+        QTemporaryDir logDir;
+        QVERIFY(logDir.isValid());
+        QDir dir(logDir.path());
+        const auto oldest = dir.filePath(QStringLiteral("20200101_0000_nextcloud.log.0.gz"));
+        const auto older = dir.filePath(QStringLiteral("20200101_0100_nextcloud.log.0.gz"));
+        const auto now = QDateTime::currentDateTime();
+        writeOldLog(oldest, 10000, now.addSecs(-2 * 60 * 60));
+        writeOldLog(older, 10000, now.addSecs(-60 * 60));
+
+        auto logger = Logger::instance();
+        logger->setLogExpire(0);
+        logger->setLogDir(logDir.path());
+        logger->setLogMaxFileSize(2000);
+        logger->enterNextLogFile();
+        const auto firstLog = logger->logFile();
+        QVERIFY(firstLog.startsWith(logDir.path()));
+
+        // From now on the logs may take 15000 bytes: the current and the
+        // previous log and the older one fit, the oldest one doesn't
+        logger->setLogMaxTotalSize(15000);
+        for (int i = 0; i < 30; ++i) {
+            qCInfo(lcTestLogger) << "line" << i << QString(20, QLatin1Char('y'));
+        }
+
+        // The writer rotates once the file exceeds its size
+        QTRY_VERIFY(logger->logFile() != firstLog);
+        QTRY_VERIFY(!QFile::exists(oldest));
+        QVERIFY(QFile::exists(older));
+        QVERIFY(QFile::exists(logger->logFile()));
+    }
+
+    void testDroppedLinesReportedInOrder()
+    {
+        QTemporaryDir logDir;
+        QVERIFY(logDir.isValid());
+        const auto logPath = QDir(logDir.path()).filePath(QStringLiteral("dropped.log"));
+        auto logger = Logger::instance();
+        {
+            // Nothing from earlier tests may end up in the new file
+            QMutexLocker lock(&logger->_mutex);
+            logger->drainQueueNoLock();
+            logger->setLogFileNoLock(logPath);
+        }
+        const auto droppedBefore = logger->droppedLines();
+        const auto capacity = logger->_queue->capacity();
+
+        {
+            // The writer can't empty the queue while the log is locked
+            QMutexLocker lock(&logger->_mutex);
+            for (int i = 0; i < capacity + 10; ++i) {
+                qCInfo(lcTestLogger) << "queued" << i;
+            }
+        }
+        QCOMPARE(logger->droppedLines(), droppedBefore + 10);
+
+        // Warnings are written synchronously, after what is still queued
+        qCWarning(lcTestLogger) << "after the dropped lines";
+        logger->setLogFile(QString());
+
+        QFile file(logPath);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const auto lines = QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+        QCOMPARE(lines.size(), capacity + 2);
+        QVERIFY(lines.at(0).endsWith(QStringLiteral("queued 0")));
+        QVERIFY(lines.at(capacity - 1).endsWith(QStringLiteral("queued %1").arg(capacity - 1)));
+        QVERIFY(lines.at(capacity).endsWith(QStringLiteral("10 log lines were dropped because the log queue was full")));
+        QVERIFY(lines.at(capacity + 1).endsWith(QStringLiteral("after the dropped lines")));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestLogger)
+#include "testlogger.moc"
@@ -0,0 +1,93 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+
+#include "logringbuffer.h"
+
+#include <thread>
+#include <vector>
+
+using namespace OCC;
+
+class TestLogRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testCapacity()
+    {
+        LogRingBuffer buffer(1000);
+        QCOMPARE(buffer.capacity(), 1024);
+
+        for (int i = 0; i < buffer.capacity(); ++i) {
+            auto line = QString::number(i);
+            QVERIFY(buffer.tryPush(line));
+        }
+        QCOMPARE(buffer.approximateSize(), 1024);
+
+        // Full, the line stays with the caller
+        auto line = QStringLiteral("overflow");
+        QVERIFY(!buffer.tryPush(line));
+        QCOMPARE(line, QStringLiteral("overflow"));
+
+        for (int i = 0; i < buffer.capacity(); ++i) {
+            QVERIFY(buffer.tryPop(line));
+            QCOMPARE(line, QString::number(i));
+        }
+        QVERIFY(!buffer.tryPop(line));
+        QCOMPARE(buffer.approximateSize(), 0);
+    }
+
+    void testConcurrentProducers()
+    {
+        const int numProducers = 4;
+        const int linesPerProducer = 20000;
+        LogRingBuffer buffer(256);
+
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < numProducers; ++producer) {
+            producers.emplace_back([&buffer, producer] {
+                for (int i = 0; i < linesPerProducer; ++i) {
+                    auto line = QStringLiteral("%1 %2").arg(producer).arg(i);
+                    while (!buffer.tryPush(line)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        // Every line arrives once, and in order per producer
+        QVector<int> nextLine(numProducers, 0);
+        int received = 0;
+        int outOfOrder = 0;
+        QString line;
+        while (received < numProducers * linesPerProducer) {
+            if (!buffer.tryPop(line)) {
+                std::this_thread::yield();
+                continue;
+            }
+            const auto producer = line.section(QLatin1Char(' '), 0, 0).toInt();
+            const auto lineNumber = line.section(QLatin1Char(' '), 1, 1).toInt();
+            if (lineNumber != nextLine[producer]) {
+                ++outOfOrder;
+            }
+            nextLine[producer] = lineNumber + 1;
+            ++received;
+        }
+
+        for (auto &producer : producers) {
+            producer.join();
+        }
+        QCOMPARE(outOfOrder, 0);
+        QCOMPARE(nextLine, QVector<int>(numProducers, linesPerProducer));
+        QVERIFY(!buffer.tryPop(line));
+    }
+};
+
+QTEST_GUILESS_MAIN(TestLogRingBuffer)
+#include "testlogringbuffer.moc"
@@ -0,0 +1,92 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+#include "common/metrics.h"
+
+using namespace OCC;
+
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDisabled()
+    {
+        Metrics::setEnabled(false);
+        auto &counter = Metrics::counter("test.disabled.counter");
+        auto &histogram = Metrics::histogram("test.disabled.histogram");
+        counter.add(5);
+        histogram.record(10);
+        QCOMPARE(counter.value(), 0);
+        QCOMPARE(histogram.count(), 0);
+        QCOMPARE(Metrics::snapshot().value("enabled").toBool(), false);
+    }
+
+    void testMetrics()
+    {
+        Metrics::setEnabled(true);
+
+        // The same name gives the same metric
+        auto &counter = Metrics::counter("test.counter");
+        QCOMPARE(&Metrics::counter("test.counter"), &counter);
+        counter.add();
+        counter.add(2);
+        QCOMPARE(counter.value(), 3);
+
+        auto &gauge = Metrics::gauge("test.gauge");
+        gauge.set(7);
+        gauge.set(4);
+        QCOMPARE(gauge.value(), 4);
+
+        auto &histogram = Metrics::histogram("test.histogram");
+        for (int i = 1; i <= 100; ++i) {
+            histogram.record(i);
+        }
+        QCOMPARE(histogram.count(), 100);
+        QCOMPARE(histogram.sum(), 5050);
+        QCOMPARE(histogram.max(), 100);
+        // Bucket bounds are powers of two
+        QCOMPARE(histogram.quantile(0.5), 63);
+        QCOMPARE(histogram.quantile(1.0), 100);
+
+        const auto snapshot = Metrics::snapshot();
+        QCOMPARE(snapshot.value("enabled").toBool(), true);
+        QCOMPARE(snapshot.value("counters").toObject().value("test.counter").toInt(), 3);
+        QCOMPARE(snapshot.value("gauges").toObject().value("test.gauge").toInt(), 4);
+        const auto histogramSnapshot = snapshot.value("histograms").toObject().value("test.histogram").toObject();
+        QCOMPARE(histogramSnapshot.value("count").toInt(), 100);
+        QCOMPARE(histogramSnapshot.value("mean").toDouble(), 50.5);
+        QCOMPARE(histogramSnapshot.value("max").toInt(), 100);
+    }
+
+    void testSyncIsMeasured()
+    {
+        Metrics::setEnabled(true);
+        const auto queriesBefore = Metrics::counter("journal.queries").value();
+        const auto lookupsBefore = Metrics::histogram("journal.getFileRecord.usec").count();
+        const auto directoriesBefore = Metrics::histogram("discovery.remoteDirectory.usec").count();
+        const auto downloadedBefore = Metrics::counter("propagator.OCC::PropagateDownloadFile.bytes").value();
+
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        fakeFolder.remoteModifier().insert(QStringLiteral("A/new"), 123);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        QVERIFY(Metrics::counter("journal.queries").value() > queriesBefore);
+        QVERIFY(Metrics::histogram("journal.getFileRecord.usec").count() > lookupsBefore);
+        QVERIFY(Metrics::histogram("discovery.remoteDirectory.usec").count() > directoriesBefore);
+        QVERIFY(Metrics::counter("propagator.OCC::PropagateDownloadFile.bytes").value() >= downloadedBefore + 123);
+
+        Metrics::setEnabled(false);
+    }
+};
+
+QTEST_GUILESS_MAIN(TestMetrics)
+#include "testmetrics.moc"
@@ -1726,6 +1726,35 @@ private slots:
         QVERIFY(itemDidCompleteSuccessfully(completeSpy, "A/abcdęfg.txt"));
         QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
     }
+
+    void testJournalSnapshot()
+    {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto syncOptions = fakeFolder.syncEngine().syncOptions();
+        syncOptions._useJournalSnapshot = true;
+        fakeFolder.syncEngine().setSyncOptions(syncOptions);
+
+        // Discovery reads the journal from the snapshot, moves are found by inode and file id
+        fakeFolder.localModifier().rename("A/a1", "B/a1m");
+        fakeFolder.remoteModifier().rename("C/c1", "A/c1m");
+        fakeFolder.localModifier().appendByte("B/b1");
+        fakeFolder.remoteModifier().insert("S/new");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(!fakeFolder.syncJournal().hasMetadataSnapshot());
+
+        SyncJournalFileRecord record;
+        QVERIFY(fakeFolder.syncJournal().getFileRecord(QByteArrayLiteral("B/a1m"), &record));
+        QVERIFY(record.isValid());
+        QVERIFY(fakeFolder.syncJournal().getFileRecord(QByteArrayLiteral("A/a1"), &record));
+        QVERIFY(!record.isValid());
+
+        // The next sync reads the journal written by the previous one
+        fakeFolder.localModifier().rename("A/c1m", "C/c1");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QVERIFY(fakeFolder.currentRemoteState().find("C/c1"));
+    }
 };
 
 QTEST_GUILESS_MAIN(TestSyncEngine)
@@ -511,6 +511,98 @@ private slots:
         statusSpy.clear();
     }
 
+    void cachedStatusFollowsChanges() {
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto &tracker = fakeFolder.syncEngine().syncFileStatusTracker();
+
+        // Unknown paths are cached too
+        QCOMPARE(tracker.fileStatus("A/a0"), SyncFileStatus(SyncFileStatus::StatusNone));
+        QCOMPARE(tracker.fileStatus("A/a1"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+
+        fakeFolder.localModifier().insert("A/a0");
+        tracker.slotPathTouched(fakeFolder.localPath() + "A/a0");
+        QCOMPARE(tracker.fileStatus("A/a0"), SyncFileStatus(SyncFileStatus::StatusSync));
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(tracker.fileStatus("A/a0"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+
+        // Children of a moved directory leave the database
+        QCOMPARE(tracker.fileStatus("B/b1"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+        fakeFolder.localModifier().rename("B", "X");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(tracker.fileStatus("B/b1"), SyncFileStatus(SyncFileStatus::StatusNone));
+        QCOMPARE(tracker.fileStatus("X/b1"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+
+        // Changing the hidden files setting drops the cache
+        fakeFolder.localModifier().insert("A/.hidden");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(tracker.fileStatus("A/.hidden"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+        fakeFolder.syncEngine().setIgnoreHiddenFiles(true);
+        QCOMPARE(tracker.fileStatus("A/.hidden"), SyncFileStatus(SyncFileStatus::StatusExcluded));
+    }
+
+    void cachedStatusFollowsJournalUpdates() {
+        SyncFileStatus sharedUpToDateStatus(SyncFileStatus::StatusUpToDate);
+        sharedUpToDateStatus.setShared(true);
+
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        auto &tracker = fakeFolder.syncEngine().syncFileStatusTracker();
+        QCOMPARE(tracker.fileStatus("A/a1"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+        QCOMPARE(tracker.fileStatus("A/a2"), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+
+        const auto markShared = [&](const QString &path) {
+            SyncJournalFileRecord record;
+            QVERIFY(fakeFolder.syncJournal().getFileRecord(path, &record) && record.isValid());
+            record._remotePerm.setPermission(RemotePermissions::IsShared);
+            QVERIFY(fakeFolder.syncJournal().setFileRecord(record));
+        };
+
+        // Share state fetched outside of a sync
+        markShared("A/a1");
+        tracker.slotClearPathInfoCache();
+        QCOMPARE(tracker.fileStatus("A/a1"), sharedUpToDateStatus);
+
+        // A sync doesn't rely on what was cached before it, even if it has nothing to do
+        markShared("A/a2");
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(tracker.fileStatus("A/a2"), sharedUpToDateStatus);
+    }
+
+    void batchedStatusesMatchSingleStatuses() {
+        SyncFileStatus sharedUpToDateStatus(SyncFileStatus::StatusUpToDate);
+        sharedUpToDateStatus.setShared(true);
+
+        FakeFolder fakeFolder{FileInfo::A12_B12_C12_S12()};
+        fakeFolder.remoteModifier().find("A/a2")->isShared = true;
+        fakeFolder.remoteModifier().find("A", true); // change the etags of the parent
+        fakeFolder.serverErrorPaths().append("A/a1");
+        fakeFolder.localModifier().appendByte("A/a1");
+        fakeFolder.syncEngine().excludedFiles().addManualExclude("B");
+        fakeFolder.localModifier().insert("C/c0");
+        QVERIFY(!fakeFolder.syncOnce());
+        fakeFolder.localModifier().insert("C/c3");
+        auto &tracker = fakeFolder.syncEngine().syncFileStatusTracker();
+        tracker.slotPathTouched(fakeFolder.localPath() + "C/c3");
+
+        const QStringList paths = { "", "A", "A/a1", "A/a2", "B", "B/b1", "C/c0", "C/c3", "D/d1", "A/a1" };
+        const auto statuses = tracker.fileStatuses(paths);
+        QCOMPARE(statuses.size(), paths.size());
+        QCOMPARE(statuses.at(0), SyncFileStatus(SyncFileStatus::StatusWarning));
+        QCOMPARE(statuses.at(1), SyncFileStatus(SyncFileStatus::StatusWarning));
+        QCOMPARE(statuses.at(2), SyncFileStatus(SyncFileStatus::StatusError));
+        QCOMPARE(statuses.at(3), sharedUpToDateStatus);
+        QCOMPARE(statuses.at(4), SyncFileStatus(SyncFileStatus::StatusExcluded));
+        QCOMPARE(statuses.at(5), SyncFileStatus(SyncFileStatus::StatusExcluded));
+        QCOMPARE(statuses.at(6), SyncFileStatus(SyncFileStatus::StatusUpToDate));
+        QCOMPARE(statuses.at(7), SyncFileStatus(SyncFileStatus::StatusSync));
+        QCOMPARE(statuses.at(8), SyncFileStatus(SyncFileStatus::StatusNone));
+        QCOMPARE(statuses.at(9), statuses.at(2));
+
+        // The same as asking for one path at a time
+        for (int i = 0; i < paths.size(); ++i) {
+            QCOMPARE(tracker.fileStatus(paths.at(i)), statuses.at(i));
+        }
+    }
+
 };
 
 QTEST_GUILESS_MAIN(TestSyncFileStatusTracker)
@@ -453,9 +453,173 @@ private slots:
         QCOMPARE(list->size(), 0);
     }
 
+    void testGroupCommit()
+    {
+        // Counts the records another connection can see, i.e. the committed ones
+        auto committedRecordCount = [this](const QByteArray &prefix) {
+            sqlite3 *db = nullptr;
+            sqlite3_stmt *stmt = nullptr;
+            int count = -1;
+            if (sqlite3_open_v2(_db.databaseFilePath().toUtf8().constData(), &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK
+                && sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM metadata WHERE path LIKE ?1", -1, &stmt, nullptr) == SQLITE_OK) {
+                const QByteArray pattern = prefix + '%';
+                sqlite3_bind_text(stmt, 1, pattern.constData(), pattern.size(), SQLITE_TRANSIENT);
+                if (sqlite3_step(stmt) == SQLITE_ROW) {
+                    count = sqlite3_column_int(stmt, 0);
+                }
+            }
+            sqlite3_finalize(stmt);
+            sqlite3_close(db);
+            return count;
+        };
+        auto addRecord = [this](const QByteArray &path) {
+            SyncJournalFileRecord record;
+            record._path = path;
+            record._type = ItemTypeFile;
+            record._etag = "etag";
+            record._remotePerm = RemotePermissions::fromDbValue("RW");
+            QVERIFY(_db.setFileRecord(record));
+        };
+
+        _db.commit("start");
+        _db.setGroupCommitLimits(3, std::chrono::hours(1));
+        _db.setGroupCommitEnabled(true);
+        QVERIFY(_db.isGroupCommitEnabled());
+        _db.commit("reset timer");
+
+        addRecord("grouped/a");
+        _db.commitGrouped("a");
+        addRecord("grouped/b");
+        _db.commitGrouped("b");
+        QCOMPARE(committedRecordCount("grouped/"), 0);
+
+        // The count limit is reached
+        addRecord("grouped/c");
+        _db.commitGrouped("c");
+        QCOMPARE(committedRecordCount("grouped/"), 3);
+
+        // A regular commit flushes grouped ones
+        addRecord("grouped/d");
+        _db.commitGrouped("d");
+        QCOMPARE(committedRecordCount("grouped/"), 3);
+        _db.commit("resume record");
+        QCOMPARE(committedRecordCount("grouped/"), 4);
+
+        // The time limit is reached
+        _db.setGroupCommitLimits(100, std::chrono::milliseconds(0));
+        addRecord("grouped/e");
+        _db.commitGrouped("e");
+        QCOMPARE(committedRecordCount("grouped/"), 5);
+
+        // The time limit is enforced without further commits
+        _db.setGroupCommitLimits(100, std::chrono::milliseconds(200));
+        _db.commit("reset timer");
+        addRecord("grouped/e2");
+        _db.commitGrouped("e2");
+        QCOMPARE(committedRecordCount("grouped/"), 5);
+        QTRY_COMPARE(committedRecordCount("grouped/"), 6);
+
+        // Disabling flushes
+        _db.setGroupCommitLimits(100, std::chrono::hours(1));
+        _db.commit("reset timer");
+        addRecord("grouped/f");
+        _db.commitGrouped("f");
+        QCOMPARE(committedRecordCount("grouped/"), 6);
+        _db.setGroupCommitEnabled(false);
+        QCOMPARE(committedRecordCount("grouped/"), 7);
+
+        // Without group commit mode every commit goes through
+        addRecord("grouped/g");
+        _db.commitGrouped("g");
+        QCOMPARE(committedRecordCount("grouped/"), 8);
+
+        QVERIFY(_db.deleteFileRecord("grouped", true));
+        _db.commit("cleanup");
+    }
+
+    void testMetadataSnapshot()
+    {
+        auto makeRecord = [this](const QByteArray &path, quint64 inode, const QByteArray &fileId) {
+            SyncJournalFileRecord record;
+            record._path = path;
+            record._inode = inode;
+            record._fileId = fileId;
+            record._type = ItemTypeFile;
+            record._etag = "etag";
+            record._modtime = dropMsecs(QDateTime::currentDateTime());
+            record._remotePerm = RemotePermissions::fromDbValue("RW");
+            record._checksumHeader = "MD5:mychecksum";
+            return record;
+        };
+        const QList<QByteArray> paths = { "snap", "snap/foo", "snap/foo-2", "snap/foo/bar", "snap/foo.txt", "snap/a", "snap/foo/baz", "snap-2" };
+        quint64 inode = 1000;
+        for (const auto &path : paths) {
+            QVERIFY(_db.setFileRecord(makeRecord(path, ++inode, "snapid" + path)));
+        }
+
+        auto listFiles = [this](const QByteArray &path) {
+            QList<QByteArray> result;
+            [&] { QVERIFY(_db.listFilesInPath(path, [&](const SyncJournalFileRecord &record) { result.append(record._path); })); }();
+            return result;
+        };
+        const auto fromDb = listFiles("snap");
+        const auto fromDbSub = listFiles("snap/foo");
+        SyncJournalFileRecord dbRecord;
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/foo/bar"), &dbRecord));
+
+        QVERIFY(_db.loadMetadataSnapshot());
+        QVERIFY(_db.hasMetadataSnapshot());
+
+        // Same results and order as the database
+        QCOMPARE(listFiles("snap"), fromDb);
+        QCOMPARE(listFiles("snap/foo"), fromDbSub);
+        QCOMPARE(listFiles("snap/foo.txt"), QList<QByteArray>());
+
+        SyncJournalFileRecord record;
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/foo/bar"), &record));
+        QVERIFY(record == dbRecord);
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/nonexistent"), &record));
+        QVERIFY(!record.isValid());
+        QVERIFY(_db.getFileRecordByInode(dbRecord._inode, &record));
+        QCOMPARE(record._path, QByteArray("snap/foo/bar"));
+        QList<QByteArray> byFileId;
+        QVERIFY(_db.getFileRecordsByFileId("snapidsnap/foo-2", [&](const SyncJournalFileRecord &record) { byFileId.append(record._path); }));
+        QCOMPARE(byFileId, QList<QByteArray>{ "snap/foo-2" });
+
+        // Updates of existing records are applied to the snapshot
+        QVERIFY(_db.updateLocalMetadata("snap/foo/bar", 42, 43, 4444, {}));
+        QVERIFY(_db.getFileRecordByInode(4444, &record));
+        QCOMPARE(record._path, QByteArray("snap/foo/bar"));
+        QCOMPARE(record._fileSize, qint64(43));
+        QVERIFY(_db.getFileRecordByInode(dbRecord._inode, &record));
+        QVERIFY(!record.isValid());
+
+        auto changed = makeRecord("snap/a", 5555, "snapidchanged");
+        QVERIFY(_db.setFileRecord(changed));
+        QVERIFY(_db.hasMetadataSnapshot());
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/a"), &record));
+        QVERIFY(record == changed);
+        QVERIFY(_db.getFileRecordsByFileId("snapidchanged", [&](const SyncJournalFileRecord &record) { QCOMPARE(record._path, QByteArray("snap/a")); }));
+
+        // New records drop it
+        QVERIFY(_db.setFileRecord(makeRecord("snap/new", 6666, "snapidnew")));
+        QVERIFY(!_db.hasMetadataSnapshot());
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/new"), &record));
+        QVERIFY(record.isValid());
+
+        QVERIFY(_db.loadMetadataSnapshot());
+        QVERIFY(_db.getFileRecord(QByteArrayLiteral("snap/new"), &record));
+        QVERIFY(record.isValid());
+        _db.releaseMetadataSnapshot();
+        QVERIFY(!_db.hasMetadataSnapshot());
+
+        QVERIFY(_db.deleteFileRecord("snap", true));
+        QVERIFY(_db.deleteFileRecord("snap-2"));
+    }
+
 private:
     SyncJournalDb _db;
 };
 
-QTEST_APPLESS_MAIN(TestSyncJournalDB)
+QTEST_GUILESS_MAIN(TestSyncJournalDB)
 #include "testsyncjournaldb.moc"
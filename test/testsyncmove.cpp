@@ -1042,6 +1042,115 @@ private slots:
 
         QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
     }
+
+    // Only the checksum, computed in the background during discovery, tells
+    // a rename from a rename-and-change of the same size and mtime
+    void testLocalMoveWaitsForChecksum()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        OperationCounter counter;
+        fakeFolder.setServerOverride(counter.functor());
+
+        // Uploaded files have a checksum in the db
+        fakeFolder.localModifier().insert("A/same");
+        fakeFolder.localModifier().insert("A/changed");
+        QVERIFY(fakeFolder.syncOnce());
+        counter.reset();
+
+        const auto mtime = fakeFolder.remoteModifier().find("A/changed")->lastModified;
+        fakeFolder.localModifier().rename("A/same", "A/samem");
+        fakeFolder.localModifier().rename("A/changed", "A/changedm");
+        fakeFolder.localModifier().setContents("A/changedm", 'C');
+        fakeFolder.localModifier().setModTime("A/changedm", mtime);
+        ItemCompletedSpy completeSpy(fakeFolder);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(counter.nMOVE, 1);
+        QCOMPARE(counter.nPUT, 1);
+        QCOMPARE(counter.nDELETE, 1);
+        QVERIFY(itemSuccessfulMove(completeSpy, "A/samem"));
+        QVERIFY(itemSuccessful(completeSpy, "A/changedm", CSYNC_INSTRUCTION_NEW));
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(printDbData(fakeFolder.dbState()), printDbData(fakeFolder.currentRemoteState()));
+    }
+
+    // More rename candidates than checksum threads, all pending at once
+    void testLocalMovesWithSeveralPendingChecksums()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        OperationCounter counter;
+        fakeFolder.setServerOverride(counter.functor());
+
+        constexpr int filesCount = 8;
+        for (int i = 0; i < filesCount; ++i) {
+            fakeFolder.localModifier().insert(QStringLiteral("B/file%1").arg(i), 1000 + i);
+        }
+        QVERIFY(fakeFolder.syncOnce());
+        counter.reset();
+
+        for (int i = 0; i < filesCount; ++i) {
+            const auto path = QStringLiteral("B/file%1").arg(i);
+            const auto mtime = fakeFolder.remoteModifier().find(path)->lastModified;
+            fakeFolder.localModifier().rename(path, path + QStringLiteral("m"));
+            if (i % 2) {
+                fakeFolder.localModifier().setContents(path + QStringLiteral("m"), 'C');
+                fakeFolder.localModifier().setModTime(path + QStringLiteral("m"), mtime);
+            }
+        }
+        ItemCompletedSpy completeSpy(fakeFolder);
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(counter.nMOVE, filesCount / 2);
+        QCOMPARE(counter.nPUT, filesCount / 2);
+        QCOMPARE(counter.nDELETE, filesCount / 2);
+        for (int i = 0; i < filesCount; ++i) {
+            const auto path = QStringLiteral("B/file%1m").arg(i);
+            if (i % 2) {
+                QVERIFY(itemSuccessful(completeSpy, path, CSYNC_INSTRUCTION_NEW));
+                QCOMPARE(fakeFolder.currentRemoteState().find(path)->contentChar, 'C');
+            } else {
+                QVERIFY(itemSuccessfulMove(completeSpy, path));
+            }
+        }
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+        QCOMPARE(printDbData(fakeFolder.dbState()), printDbData(fakeFolder.currentRemoteState()));
+    }
+
+    void testAbortWithPendingChecksum()
+    {
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        fakeFolder.localModifier().insert("A/moved");
+        QVERIFY(fakeFolder.syncOnce());
+
+        // A/zzz is discovered in the same pass as A/movedm, while the checksum
+        // of the rename candidate is still being computed
+        fakeFolder.localModifier().rename("A/moved", "A/movedm");
+        fakeFolder.localModifier().insert("A/zzz");
+        bool movedDiscovered = false;
+        bool movedPendingOnAbort = false;
+        QObject context;
+        connect(&fakeFolder.syncEngine(), &SyncEngine::itemDiscovered, &context, [&](const SyncFileItemPtr &item) {
+            if (item->destination() == QLatin1String("A/movedm")) {
+                movedDiscovered = true;
+            } else if (item->_file == QLatin1String("A/zzz")) {
+                movedPendingOnAbort = !movedDiscovered;
+                fakeFolder.syncEngine().abort();
+            }
+        });
+        QVERIFY(!fakeFolder.syncOnce());
+        QVERIFY(movedPendingOnAbort);
+
+        // The checksum finishes after its discovery job is gone
+        QTest::qWait(100);
+        QVERIFY(!movedDiscovered);
+        QObject::disconnect(&fakeFolder.syncEngine(), nullptr, &context, nullptr);
+
+        OperationCounter counter;
+        fakeFolder.setServerOverride(counter.functor());
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(counter.nMOVE, 1);
+        QCOMPARE(counter.nPUT, 1);
+        QCOMPARE(counter.nDELETE, 0);
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+    }
 };
 
 QTEST_GUILESS_MAIN(TestSyncMove)
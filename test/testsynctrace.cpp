@@ -0,0 +1,131 @@
+/*
+ *    This software is in the public domain, furnished "as is", without technical
+ *    support, and with no warranty, express or implied, as to its usefulness for
+ *    any purpose.
+ *
+ */
+
+#include <QtTest>
+#include "syncenginetestutils.h"
+#include <syncengine.h>
+#include "common/synctrace.h"
+
+using namespace OCC;
+
+static QJsonArray readTrace(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    // The trace is left open for appending, close the array to parse it
+    auto data = file.readAll().trimmed();
+    if (data.endsWith(',')) {
+        data.chop(1);
+    }
+    data.append(']');
+    return QJsonDocument::fromJson(data).array();
+}
+
+class TestSyncTrace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDisabled()
+    {
+        QVERIFY(!SyncTrace::isEnabled());
+        SyncTrace::record(SyncTrace::Journal, QStringLiteral("commit"), QString(), 0);
+        SyncTrace::flush();
+    }
+
+    void testRecordAndFlush()
+    {
+        QTemporaryDir dir;
+        const auto tracePath = dir.filePath(QStringLiteral("trace.json"));
+        SyncTrace::setOutputFile(tracePath);
+        QVERIFY(SyncTrace::isEnabled());
+
+        const auto start = SyncTrace::now();
+        SyncTrace::record(SyncTrace::Network, QStringLiteral("GET"), QStringLiteral("A/a1"), start, 100, 200, 50);
+        QVERIFY(readTrace(tracePath).isEmpty());
+        SyncTrace::flush();
+
+        const auto events = readTrace(tracePath);
+        QCOMPARE(events.size(), 2);
+        const auto begin = events.at(0).toObject();
+        const auto end = events.at(1).toObject();
+        QCOMPARE(begin.value("ph").toString(), QStringLiteral("b"));
+        QCOMPARE(end.value("ph").toString(), QStringLiteral("e"));
+        QCOMPARE(begin.value("id"), end.value("id"));
+        QCOMPARE(begin.value("cat").toString(), QStringLiteral("network"));
+        QVERIFY(begin.value("ts").toDouble() <= end.value("ts").toDouble());
+        const auto args = begin.value("args").toObject();
+        QCOMPARE(args.value("path").toString(), QStringLiteral("A/a1"));
+        QCOMPARE(args.value("size").toInt(), 100);
+        QCOMPARE(args.value("status").toInt(), 200);
+        QCOMPARE(args.value("bytes").toInt(), 50);
+
+        SyncTrace::setOutputFile(QString());
+        QVERIFY(!SyncTrace::isEnabled());
+    }
+
+    void testFullBufferIsWrittenWithoutFlush()
+    {
+        QTemporaryDir dir;
+        const auto tracePath = dir.filePath(QStringLiteral("trace.json"));
+        SyncTrace::setOutputFile(tracePath);
+
+        // More than the in-memory buffer holds, the writer thread takes over the full one
+        constexpr int eventsCount = 20000;
+        for (int i = 0; i < eventsCount; ++i) {
+            SyncTrace::record(SyncTrace::Journal, QStringLiteral("commit"), QString(), SyncTrace::now());
+        }
+        QTRY_VERIFY(!readTrace(tracePath).isEmpty());
+        QVERIFY(readTrace(tracePath).size() < 2 * eventsCount);
+
+        SyncTrace::flush();
+        QCOMPARE(readTrace(tracePath).size(), 2 * eventsCount);
+
+        SyncTrace::setOutputFile(QString());
+    }
+
+    void testSyncIsTraced()
+    {
+        QTemporaryDir dir;
+        const auto tracePath = dir.filePath(QStringLiteral("trace.json"));
+        SyncTrace::setOutputFile(tracePath);
+
+        FakeFolder fakeFolder{ FileInfo::A12_B12_C12_S12() };
+        fakeFolder.localModifier().insert(QStringLiteral("A/new"), 100);
+        fakeFolder.remoteModifier().appendByte(QStringLiteral("B/b1"));
+        QVERIFY(fakeFolder.syncOnce());
+        QCOMPARE(fakeFolder.currentLocalState(), fakeFolder.currentRemoteState());
+
+        // The end of the sync flushes
+        QSet<QString> categories;
+        QSet<QString> propagatedPaths;
+        qint64 bytesUploaded = 0;
+        const auto events = readTrace(tracePath);
+        for (const auto &value : events) {
+            const auto event = value.toObject();
+            categories.insert(event.value("cat").toString());
+            if (event.value("cat").toString() == QLatin1String("propagation")) {
+                propagatedPaths.insert(event.value("args").toObject().value("path").toString());
+            }
+            if (event.value("cat").toString() == QLatin1String("network") && event.value("name").toString().startsWith(QLatin1String("PUT"))) {
+                bytesUploaded += event.value("args").toObject().value("size").toInt();
+            }
+        }
+        QCOMPARE(categories, QSet<QString>({ "discovery", "propagation", "journal", "network" }));
+        QVERIFY(propagatedPaths.contains(QStringLiteral("A/new")));
+        QVERIFY(propagatedPaths.contains(QStringLiteral("B/b1")));
+        // Network requests record the bytes that were actually sent
+        QCOMPARE(bytesUploaded, 100);
+
+        SyncTrace::setOutputFile(QString());
+    }
+};
+
+QTEST_GUILESS_MAIN(TestSyncTrace)
+#include "testsynctrace.moc"
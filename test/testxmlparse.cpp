@@ -613,6 +613,197 @@ private slots:
         QVERIFY(_subdirs.size() == 1);
     }
 
+
+    void testParserIncremental() {
+        const QByteArray testXml = "<?xml version='1.0' encoding='utf-8'?>"
+              "<d:multistatus xmlns:d=\"DAV:\" xmlns:s=\"http://sabredav.org/ns\" xmlns:oc=\"http://owncloud.org/ns\">"
+              "<d:response>"
+              "<d:href>/oc/remote.php/dav/sharefolder/</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:id>00004213ocobzus5kn6s</oc:id>"
+              "<oc:permissions>RDNVCK</oc:permissions>"
+              "<oc:size>121780</oc:size>"
+              "<d:getetag>\"5527beb0400b0\"</d:getetag>"
+              "<d:resourcetype>"
+              "<d:collection/>"
+              "</d:resourcetype>"
+              "<d:getlastmodified>Fri, 06 Feb 2015 13:49:55 GMT</d:getlastmodified>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "<d:response>"
+              "<d:href>/oc/remote.php/dav/sharefolder/quitte.pdf</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:id>00004215ocobzus5kn6s</oc:id>"
+              "<oc:permissions>RDNVW</oc:permissions>"
+              "<d:getetag>\"2fa2f0d9ed49ea0c3e409d49e652dea0\"</d:getetag>"
+              "<d:resourcetype/>"
+              "<d:getlastmodified>Fri, 06 Feb 2015 13:49:55 GMT</d:getlastmodified>"
+              "<d:getcontentlength>121780</d:getcontentlength>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:downloadURL/>"
+              "<oc:dDC/>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 404 Not Found</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "</d:multistatus>";
+
+        LsColXMLParser parser;
+
+        connect( &parser, &LsColXMLParser::directoryListingSubfolders,
+                 this, &TestXmlParse::slotDirectoryListingSubFolders );
+        connect( &parser, &LsColXMLParser::directoryListingIterated,
+                 this, &TestXmlParse::slotDirectoryListingIterated );
+        connect( &parser, &LsColXMLParser::finishedWithoutError,
+                 this, &TestXmlParse::slotFinishedSuccessfully );
+
+        QMap<QString, QMap<QString, QString>> properties;
+        connect(&parser, &LsColXMLParser::directoryListingIterated, this, [&properties](const QString &item, const QMap<QString, QString> &map) {
+            properties.insert(item, map);
+        });
+
+        // Feed the document in small chunks that split tags and text content
+        QHash <QString, ExtraFolderInfo> sizes;
+        parser.start(&sizes, "/oc/remote.php/dav/sharefolder");
+        const QByteArray responseEnd = "</d:response>";
+        const auto firstResponseEnd = testXml.indexOf(responseEnd) + responseEnd.size();
+        for (int pos = 0; pos < firstResponseEnd; pos += 7) {
+            QVERIFY(parser.addData(testXml.mid(pos, qMin(7, firstResponseEnd - pos))));
+        }
+        // The first entry is emitted before the rest of the document arrived
+        QCOMPARE(_items.size(), 1);
+        for (int pos = firstResponseEnd; pos < testXml.size(); pos += 7) {
+            QVERIFY(parser.addData(testXml.mid(pos, 7)));
+        }
+        QCOMPARE(_items.size(), 2);
+        QVERIFY(!_success);
+        QVERIFY(parser.finish());
+        QVERIFY(_success);
+
+        QCOMPARE(sizes.size(), 1);
+        QCOMPARE(sizes.value("/oc/remote.php/dav/sharefolder/").size, 121780);
+        QCOMPARE(_items, QStringList({ "/oc/remote.php/dav/sharefolder", "/oc/remote.php/dav/sharefolder/quitte.pdf" }));
+        QCOMPARE(_subdirs, QStringList("/oc/remote.php/dav/sharefolder/"));
+
+        const auto fileProperties = properties.value("/oc/remote.php/dav/sharefolder/quitte.pdf");
+        QCOMPARE(fileProperties.value("getetag"), QStringLiteral("\"2fa2f0d9ed49ea0c3e409d49e652dea0\""));
+        QCOMPARE(fileProperties.value("getcontentlength"), QStringLiteral("121780"));
+        QCOMPARE(fileProperties.value("resourcetype"), QString());
+        QVERIFY(!fileProperties.contains("downloadURL"));
+        QCOMPARE(properties.value("/oc/remote.php/dav/sharefolder").value("resourcetype"), QStringLiteral("<collection></collection>"));
+    }
+
+    void testParserIncrementalTruncated() {
+        const QByteArray testXml = "<?xml version='1.0' encoding='utf-8'?>"
+              "<d:multistatus xmlns:d=\"DAV:\" xmlns:s=\"http://sabredav.org/ns\" xmlns:oc=\"http://owncloud.org/ns\">"
+              "<d:response>"
+              "<d:href>/oc/remote.php/dav/sharefolder/</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:id>00004213ocobzus5kn6s</oc:id>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "</d:response>"; // no proper end here
+
+        LsColXMLParser parser;
+
+        connect( &parser, &LsColXMLParser::directoryListingIterated,
+                 this, &TestXmlParse::slotDirectoryListingIterated );
+        connect( &parser, &LsColXMLParser::finishedWithoutError,
+                 this, &TestXmlParse::slotFinishedSuccessfully );
+
+        QHash <QString, ExtraFolderInfo> sizes;
+        parser.start(&sizes, "/oc/remote.php/dav/sharefolder");
+        // An incomplete document is only an error once it is known to be complete
+        QVERIFY(parser.addData(testXml));
+        QCOMPARE(_items.size(), 1);
+        QVERIFY(!parser.finish());
+        QVERIFY(!_success);
+    }
+
+
+    void testParserRecords() {
+        const QByteArray testXml = "<?xml version='1.0' encoding='utf-8'?>"
+              "<d:multistatus xmlns:d=\"DAV:\" xmlns:s=\"http://sabredav.org/ns\" xmlns:oc=\"http://owncloud.org/ns\">"
+              "<d:response>"
+              "<d:href>/oc/remote.php/dav/sharefolder/</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:id>00004213ocobzus5kn6s</oc:id>"
+              "<oc:permissions>RDNVCK</oc:permissions>"
+              "<oc:size>121780</oc:size>"
+              "<d:resourcetype>"
+              "<d:collection/>"
+              "</d:resourcetype>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "<d:response>"
+              "<d:href>/oc/remote.php/dav/sharefolder/quitte.pdf</d:href>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:id>00004215ocobzus5kn6s</oc:id>"
+              "<d:getetag>\"2fa2f0d9ed49ea0c3e409d49e652dea0\"</d:getetag>"
+              "<d:resourcetype/>"
+              "<d:getcontentlength>121780</d:getcontentlength>"
+              "<oc:unknownproperty>ignored</oc:unknownproperty>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 200 OK</d:status>"
+              "</d:propstat>"
+              "<d:propstat>"
+              "<d:prop>"
+              "<oc:downloadURL/>"
+              "</d:prop>"
+              "<d:status>HTTP/1.1 404 Not Found</d:status>"
+              "</d:propstat>"
+              "</d:response>"
+              "</d:multistatus>";
+
+        LsColXMLParser parser;
+        parser.setEmitPropertyMaps(false);
+
+        connect( &parser, &LsColXMLParser::directoryListingIterated,
+                 this, &TestXmlParse::slotDirectoryListingIterated );
+        connect( &parser, &LsColXMLParser::finishedWithoutError,
+                 this, &TestXmlParse::slotFinishedSuccessfully );
+
+        QMap<QString, DavPropertyRecord> records;
+        connect(&parser, &LsColXMLParser::directoryListingRecordIterated, this, [&records](const QString &item, const DavPropertyRecord &record) {
+            records.insert(item, record);
+        });
+
+        QHash <QString, ExtraFolderInfo> sizes;
+        QVERIFY(parser.parse( testXml, &sizes, "/oc/remote.php/dav/sharefolder" ));
+        QVERIFY(_success);
+        QVERIFY(_items.isEmpty()); // no property maps were requested
+        QCOMPARE(records.size(), 2);
+
+        const auto folder = records.value("/oc/remote.php/dav/sharefolder");
+        QCOMPARE(folder.value(DavPropertyRecord::Id), QStringLiteral("00004213ocobzus5kn6s"));
+        QCOMPARE(folder.value(DavPropertyRecord::Permissions), QStringLiteral("RDNVCK"));
+        QCOMPARE(folder.value(DavPropertyRecord::Size), QStringLiteral("121780"));
+        QCOMPARE(folder.value(DavPropertyRecord::ResourceType), QStringLiteral("<collection></collection>"));
+        QVERIFY(!folder.contains(DavPropertyRecord::GetEtag));
+
+        const auto file = records.value("/oc/remote.php/dav/sharefolder/quitte.pdf");
+        QCOMPARE(file.value(DavPropertyRecord::GetEtag), QStringLiteral("\"2fa2f0d9ed49ea0c3e409d49e652dea0\""));
+        QCOMPARE(file.value(DavPropertyRecord::GetContentLength), QStringLiteral("121780"));
+        QVERIFY(file.contains(DavPropertyRecord::ResourceType));
+        QVERIFY(file.value(DavPropertyRecord::ResourceType).isEmpty());
+        QVERIFY(!file.contains(DavPropertyRecord::DownloadUrl)); // not in a 200 propstat
+        QVERIFY(!file.contains(DavPropertyRecord::Permissions));
+    }
+
 };
 
     QTEST_GUILESS_MAIN(TestXmlParse)